@@ -1,8 +1,13 @@
 #import <Foundation/Foundation.h>
+#import "QuotePrice.h"
 
 @interface GridHelper : NSObject
 
 + (NSNumberFormatter *)decimalFormatter;
 + (NSNumberFormatter *)currencyFormatter;
 
+/// en_US dollars to the cent, e.g. "-$1,234.57", formatted straight from the
+/// ticks without a formatter or a double in between. Empty when missing.
++ (NSString *)currencyStringForPrice:(QuotePrice)price;
+
 @end
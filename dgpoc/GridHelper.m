@@ -32,4 +32,17 @@
     return currencyFormatter;
 }
 
++ (NSString *)currencyStringForPrice:(QuotePrice)price {
+    if (price == QUOTE_FIXED_MISSING) {
+        return @"";
+    }
+    char text[34] = "$";
+    size_t length = QuoteFixedFormat(price, QUOTE_PRICE_DECIMALS, 2, text + 1, sizeof(text) - 1);
+    if (text[1] == '-') {
+        text[0] = '-';
+        text[1] = '$';
+    }
+    return [[NSString alloc] initWithBytes:text length:length + 1 encoding:NSASCIIStringEncoding];
+}
+
 @end
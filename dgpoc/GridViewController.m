@@ -13,9 +13,20 @@
 static const NSUInteger kDecimalCellWidth = 80;
 static const NSUInteger kCurrencyCellWidth = 90;
 
+// The fields a tick moves.
+static const QuoteFieldMask kQuoteTickFields = (1 << QuoteFieldLastTrade) | (1 << QuoteFieldBid) | (1 << QuoteFieldAsk);
+
+// Moves a price up a cent; a missing price stays missing.
+static inline void QuotePriceTick(QuotePrice *price) {
+    if (*price != QUOTE_FIXED_MISSING) {
+        *price += QuotePriceFromCents(1);
+    }
+}
+
 @interface GridViewController ()
 
 @property (nonatomic, strong) NSArray *data;
+@property (nonatomic, strong) QuoteItemProjection *projection;
 @property (nonatomic, strong) NSMutableArray *nonVisibleColumns;
 @property (nonatomic, strong) TDAGridViewTheme *tdaTheme;
 @property (nonatomic, strong) NSTimer *timer;
@@ -55,30 +66,42 @@ static const NSUInteger kCurrencyCellWidth = 90;
 }
 
 - (void)doTimerStuff:(NSTimer *)timer {
-    for (QuoteItem *item in self.ds.data) {
-        //if([item.symbol isEqualToString:@"SWHC"]) {
-        //}
-        item.lastTrade = [NSNumber numberWithDouble:item.lastTrade.doubleValue + 0.01];
-        item.bid = [NSNumber numberWithDouble:item.bid.doubleValue + 0.01];
-        item.ask = [NSNumber numberWithDouble:item.ask.doubleValue + 0.01];
+    QuoteStore *store = self.projection.store;
+    QuotePrice *lastTrade = [store fixedColumn:QuoteFieldLastTrade];
+    QuotePrice *bid = [store fixedColumn:QuoteFieldBid];
+    QuotePrice *ask = [store fixedColumn:QuoteFieldAsk];
+    NSMutableData *rows = [NSMutableData dataWithLength:store.rowCount * sizeof(uint32_t)];
+    uint32_t *changed = rows.mutableBytes;
+    for (NSUInteger row = 0; row < store.rowCount; row++) {
+        QuotePriceTick(&lastTrade[row]);
+        QuotePriceTick(&bid[row]);
+        QuotePriceTick(&ask[row]);
+        changed[row] = (uint32_t)row;
     }
+    [store didChangeFields:kQuoteTickFields];
+    [self.ds rowsDidChange:changed count:store.rowCount fields:kQuoteTickFields];
     [self.gridView updateData];
 }
 
 - (void)doTimerStuff2:(NSTimer *)timer {
 
-    int index;
-    for (int i=0; i<arc4random_uniform(50); i++) {
-        index = arc4random_uniform( (unsigned int)[self.data count]);
-        [self updateQuoteItem:self.ds.data[index]];
+    uint32_t changed[50];
+    uint32_t count = arc4random_uniform(50);
+    for (uint32_t i=0; i<count; i++) {
+        QuoteItem *item = self.ds.data[arc4random_uniform((unsigned int)[self.data count])];
+        [self updateQuoteItem:item];
+        changed[i] = (uint32_t)item.row;
     }
+    [self.projection.store didChangeFields:kQuoteTickFields];
+    [self.ds rowsDidChange:changed count:count fields:kQuoteTickFields];
    [self.gridView updateData];
 }
 
 - (void)updateQuoteItem:(QuoteItem*)item {
-    item.lastTrade = [NSNumber numberWithDouble:item.lastTrade.doubleValue + 0.01];
-    item.bid = [NSNumber numberWithDouble:item.bid.doubleValue + 0.01];
-    item.ask = [NSNumber numberWithDouble:item.ask.doubleValue + 0.01];
+    QuoteStore *store = item.store;
+    QuotePriceTick(&[store fixedColumn:QuoteFieldLastTrade][item.row]);
+    QuotePriceTick(&[store fixedColumn:QuoteFieldBid][item.row]);
+    QuotePriceTick(&[store fixedColumn:QuoteFieldAsk][item.row]);
 }
 
 - (void)gridEditColumnsControllerReturnedColumns:(NSArray *)editedColumns {
@@ -99,6 +122,9 @@ static const NSUInteger kCurrencyCellWidth = 90;
     
     [self.ds.columnDefinitions removeAllObjects];
     [self.ds.columnDefinitions addObjectsFromArray:editedColumns];
+
+    // newly shown columns were skipped at load; fill them in before the grid asks
+    [self.projection decodeFields:[self displayedFields]];
 }
 
 #pragma mark - GridView Delegate
@@ -112,7 +138,7 @@ static const NSUInteger kCurrencyCellWidth = 90;
 
 - (CGFloat)gridView:(IGGridView *)gridView heightForRowAtPath:(IGRowPath *)path {
     QuoteItem *item = [self.ds resolveDataObjectForRow:path];
-    if ([item.assetType isEqualToString:@"O"]) {
+    if (item.quoteAssetType == QuoteAssetTypeOption) {
         return 80;
     }
     return gridView.rowHeight;
@@ -148,13 +174,15 @@ static const NSUInteger kCurrencyCellWidth = 90;
     self.gridView.delegate = self;
     
     self.ds = [[IGGridViewSortingDataSourceHelper alloc] init];
-    self.data = [QuoteItemDataMaker quoteItemsFromCannedData];
     self.nonVisibleColumns = [self createAllColumnDefinitions];
 
     NSArray *defaultColumnsHeaderKeys = @[@"lastTrade", @"bid", @"ask", @"open", @"daysHigh", @"daysLow"];
     NSArray *defaultColumns = [self columnsWithHeaderKeys:defaultColumnsHeaderKeys];
     [self.ds.columnDefinitions addObjectsFromArray:defaultColumns];
 
+    self.projection = [QuoteItemDataMaker cannedQuoteItemsWithFields:[self displayedFields]];
+    self.data = self.projection.items;
+
     self.ds.autoGenerateColumns = NO;
     self.ds.allowColumnReordering = NO;
     self.ds.data = self.data;
@@ -239,6 +267,23 @@ static const NSUInteger kCurrencyCellWidth = 90;
     return columns;
 }
 
+// Everything the grid can read from a row right now: visible columns, the
+// fields being sorted or filtered on.
+- (QuoteFieldMask)displayedFields {
+    QuoteFieldMask fields = QuoteFieldMaskIdentity;
+    for (IGGridViewColumnDefinition *column in self.ds.columnDefinitions) {
+        fields |= QuoteFieldMaskForKey(column.fieldKey) | QuoteFieldMaskForKey(column.sortFieldKey);
+    }
+    for (IGGridViewColumnDefinition *column in self.ds.fixedLeftColumns) {
+        fields |= QuoteFieldMaskForKey(column.fieldKey) | QuoteFieldMaskForKey(column.sortFieldKey);
+    }
+    for (IGGridViewSortedColumn *sortedColumn in self.ds.sortedColumns) {
+        fields |= QuoteFieldMaskForKey(sortedColumn.fieldName);
+    }
+    fields |= QuoteFieldMaskForKey(self.ds.filteringKey);
+    return fields;
+}
+
 - (NSMutableArray *)columnsWithHeaderKeys:(NSArray *)columnHeaderKeys {
     NSMutableArray *columns = [NSMutableArray array];
     for (NSString *colHeaderKey in columnHeaderKeys) {
@@ -1,5 +1,6 @@
 #import "IGGridViewCurrencyColumnDefinition.h"
 #import "QuoteItem.h"
+#import "QuoteStore.h"
 #import "GridHelper.h"
 #import "UIColor+TDA.h"
 
@@ -22,18 +23,31 @@
         cell = [[IGGridViewCell alloc] initWithReuseIdentifier:@"DollorValueCell"];
     }
     
+    QuoteField field = QuoteFieldForKey(self.fieldKey);
+    if ([data isKindOfClass:[QuoteItem class]] && field < QuoteFieldCount
+        && QuoteFieldTypeOf(field) == QuoteFieldTypeFixed) {
+        QuoteItem *item = data;
+        QuotePrice price = [item.store fixedForField:field row:item.row];
+        cell.textLabel.text = [GridHelper currencyStringForPrice:price];
+        [self colorCell:cell bySign:price == QUOTE_FIXED_MISSING ? 0 : (price > 0) - (price < 0)];
+        return cell;
+    }
+
     NSNumber *numberValue = [data valueForKey:self.fieldKey];
     cell.textLabel.text = [[GridHelper currencyFormatter] stringFromNumber:numberValue];
+    [self colorCell:cell bySign:(numberValue.doubleValue > 0) - (numberValue.doubleValue < 0)];
     
-    if (numberValue.doubleValue < 0.f) {
+    return cell;
+}
+
+- (void)colorCell:(IGGridViewCell *)cell bySign:(int)sign {
+    if (sign < 0) {
         cell.textLabel.textColor = [UIColor tdaRedDownTickColor];
-    } else if (numberValue.doubleValue > 0.f) {
+    } else if (sign > 0) {
         cell.textLabel.textColor = [UIColor tdaGreenUpTickColor];
     } else {
         cell.textLabel.textColor = [UIColor lightGrayColor];
     }
-    
-    return cell;
 }
 
 @end
@@ -1,6 +1,60 @@
 #import <IG/IG.h>
 #import "IGGridViewSortingDelegate.h"
+#import "QuoteSchema.h"
 
+@class QuoteFilterEngine;
+@class QuoteSortCache;
+
+/// Sorts by sortedColumns in order, any number of them; rows equal on every
+/// key stay in row id order. A tap on a header sorts by that column alone, a
+/// long press adds it as the next key. Quote rows are sorted in full only
+/// when the sort changes to one not seen since its fields last changed;
+/// ticks move just the rows they touched.
+///
+/// Quote rows are filtered without KVC when filteringKey names a store field
+/// that filterType suits, honouring the case and diacritic settings; any
+/// other filter goes through IG as before. A contains filter on symbolName
+/// can search the names by word instead (searchesNamesByWord).
 @interface IGGridViewSortingDataSourceHelper : IGGridViewDataSourceHelper <IGGridViewSortingDelegate>
 
+/// Sorted permutations of the quote store by sort spec, with hit and miss
+/// counts. nil until quote rows are first sorted.
+@property (nonatomic, readonly) QuoteSortCache *sortCache;
+
+/// Compiles and runs filters over the quote store. nil until quote rows are
+/// first sorted or filtered.
+@property (nonatomic, readonly) QuoteFilterEngine *filterEngine;
+
+/// When YES, a case and diacritic insensitive contains filter on
+/// symbolName matches the words of the value to the words of the names,
+/// best matches first (QuoteFilterEngine itemsMatchingName:inItems:), so
+/// "solar first" finds First Solar; the names are indexed when quote data
+/// is set. A word search drops what a substring would find within a word
+/// from fewer than three letters, so a value with no word at all ("&") is
+/// still matched as a substring. NO unless set: contains keeps IG's meaning.
+@property (nonatomic) BOOL searchesNamesByWord;
+
+/// Quote data of at least this many rows is sorted only as far as the grid
+/// reads it, unless the sort is already cached. 250000 unless set.
+@property (nonatomic) NSUInteger partialSortMinimumCount;
+
+/// A header tap or long press on quote data of at least
+/// backgroundSortMinimumCount rows (100000 unless set), and fewer than
+/// partialSortMinimumCount, sorts on a background queue while the grid keeps
+/// showing the old order. YES unless set.
+@property (nonatomic) BOOL sortsInBackground;
+@property (nonatomic) NSUInteger backgroundSortMinimumCount;
+
+/// sortedColumns as sort descriptors, skipping unsorted ones.
+- (NSArray *)sortDescriptors;
+
+/// Adds the column as the lowest priority key, or if it is already a key
+/// moves it on to descending, then off. Call invalidateData afterwards.
+- (void)appendSortingForColumn:(IGGridViewColumnDefinition *)column;
+
+/// Tells the helper the given store rows changed fields, so rows whose sort
+/// values moved are put back in order before the grid next updates. Called
+/// on the main thread, like every other method.
+- (void)rowsDidChange:(const uint32_t *)rows count:(NSUInteger)count fields:(QuoteFieldMask)fields;
+
 @end
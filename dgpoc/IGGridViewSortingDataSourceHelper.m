@@ -1,9 +1,67 @@
 #import "IGGridViewSortingDataSourceHelper.h"
 #import "IGGridViewSortingHeaderCell.h"
 #import "IGGridViewColumnDefinition+Sort.h"
+#import "QuoteFilterEngine.h"
+#import "QuoteItem.h"
+#import "QuotePartialSortOrder.h"
+#import "QuoteSortCache.h"
+#import "QuoteSortEngine.h"
+#import "QuoteSortScheduler.h"
+
+// Room for a dozen sorts of 150k rows, and for at least two of any store.
+static const NSUInteger kSortCacheByteBudget = 8 << 20;
+static const NSUInteger kSortCacheMinimumPermutations = 2;
+
+static const NSUInteger kPartialSortMinimumCount = 250000;
+
+static const NSUInteger kBackgroundSortMinimumCount = 100000;
+
+// Past this share of the rows ticking during a background sort, as for
+// QuoteSortOrder, moving them costs more than sorting again; the sort is
+// taken again off the main thread, up to the limit, rather than on it.
+static const NSUInteger kBackgroundSortResortDivisor = 8;
+static const NSUInteger kBackgroundSortResubmitLimit = 2;
+
+// filterType is passed to the filter engine as it is.
+_Static_assert((NSInteger)QuoteFilterConditionLessOrEqual == IGGridViewFilterConditionTypeNumberLessThanEquals,
+               "QuoteFilterCondition follows IGGridViewFilterConditionType");
+
+@interface IGGridViewSortingDataSourceHelper ()
+
+@property (nonatomic, strong) QuoteSortEngine *sortEngine;
+@property (nonatomic, strong, readwrite) QuoteSortCache *sortCache;
+@property (nonatomic, strong, readwrite) QuoteFilterEngine *filterEngine;
+@property (nonatomic, strong) QuoteSortOrder *sortOrder;
+@property (nonatomic, strong) QuotePartialSortOrder *partialSortOrder;
+@property (nonatomic, strong) QuoteSortScheduler *sortScheduler;
+// Rows reported changed while a background sort runs, a bit per store row,
+// replayed onto its order before it is shown.
+@property (nonatomic, strong) NSMutableData *pendingChangedRows;
+@property (nonatomic, assign) NSUInteger pendingChangedCount;
+@property (nonatomic, assign) QuoteFieldMask pendingChangedFields;
+
+@end
+
+static QuoteFieldMask QuoteFieldMaskForDescriptors(NSArray *descriptors) {
+    QuoteFieldMask fields = 0;
+    for (NSSortDescriptor *descriptor in descriptors) {
+        fields |= QuoteFieldMaskForKey(descriptor.key);
+    }
+    return fields;
+}
 
 @implementation IGGridViewSortingDataSourceHelper
 
+- (instancetype)init {
+    self = [super init];
+    if (self) {
+        _partialSortMinimumCount = kPartialSortMinimumCount;
+        _sortsInBackground = YES;
+        _backgroundSortMinimumCount = kBackgroundSortMinimumCount;
+        _sortScheduler = [[QuoteSortScheduler alloc] init];
+    }
+    return self;
+}
 
 -(IGGridViewHeaderCell *)gridView:(IGGridView *)gridView fixedLeftHeaderCellAt:(NSInteger)column {
     IGGridViewSortingHeaderCell *sortingHeaderCell = [gridView dequeueReusableCellWithIdentifier:@"SymbolHeadeCell"];
@@ -18,13 +76,7 @@
     sortingHeaderCell.textLabel.text = [[self gridView:gridView titleForHeaderInFixedLeftColumn:column] uppercaseString];
     
     IGGridViewColumnDefinition *col = self.fixedLeftColumns[column];
-    IGGridViewSortedColumn *sc = (self.sortedColumns.count == 0) ? nil : self.sortedColumns[0];
-    
-    if([sc.fieldName isEqualToString:col.sortFieldKey]) {
-        [sortingHeaderCell setSortDirection:sc.sortDirection];
-    } else {
-        [sortingHeaderCell setSortDirection:IGGridViewSortedColumnDirectionNone];
-    }
+    [self applySortingOfColumn:col toHeaderCell:sortingHeaderCell];
     
     return sortingHeaderCell;
 
@@ -43,15 +95,266 @@
     sortingHeaderCell.textLabel.text = [[self gridView:gridView titleForHeaderInColumn:column] uppercaseString];
 
     IGGridViewColumnDefinition *col = self.columns[column];
-    IGGridViewSortedColumn *sc = (self.sortedColumns.count == 0) ? nil : self.sortedColumns[0];
+    [self applySortingOfColumn:col toHeaderCell:sortingHeaderCell];
 
-    if([sc.fieldName isEqualToString:col.sortFieldKey]) {
-        [sortingHeaderCell setSortDirection:sc.sortDirection];
-    } else {
-        [sortingHeaderCell setSortDirection:IGGridViewSortedColumnDirectionNone];
+    return sortingHeaderCell;
+}
+
+#pragma mark - Filtering
+
+// Names are tokenized as the data arrives rather than on the first search,
+// and results kept for the old data are let go.
+- (void)setData:(NSArray *)data {
+    [super setData:data];
+    if ([self sortEngineForData:data]) {
+        [self.filterEngine forgetRefinements];
+        if (self.searchesNamesByWord) {
+            [self.filterEngine indexNames];
+        }
     }
+}
 
-    return sortingHeaderCell;
+// A value with no word would find no name, so it stays a substring match.
+- (BOOL)searchesNamesForFilterCondition:(QuoteFilterCondition)condition value:(NSString *)value {
+    return self.searchesNamesByWord && condition == QuoteFilterConditionContains
+        && [self.filteringKey isEqualToString:QuoteFieldKey(QuoteFieldSymbolName)]
+        && self.filteringCaseInsensitivity && self.filteringDiacriticInsensitiveFiltering
+        && [self.filterEngine canSearchName:value];
+}
+
+// The condition compiles once to a predicate over the filtering key's
+// column, which then runs over the rows in one pass. IG would build an
+// NSPredicate and read the key through valueForKey: on every row. As the
+// value is typed, each keystroke that narrows the last filters only the
+// last one's result, and a backspace gets the result before back.
+- (NSArray *)applyFilterForValue:(NSString *)value toData:(NSArray *)dataToFilter {
+    QuoteFilterCondition condition = (QuoteFilterCondition)self.filterType;
+    if (value.length == 0 || ![self sortEngineForData:dataToFilter]
+        || ![self.filterEngine canFilterKey:self.filteringKey condition:condition]) {
+        return [super applyFilterForValue:value toData:dataToFilter];
+    }
+    if ([self searchesNamesForFilterCondition:condition value:value]) {
+        return [self.filterEngine refinedItemsMatchingName:value inItems:dataToFilter];
+    }
+    QuoteFilterOptions options = 0;
+    if (self.filteringCaseInsensitivity) {
+        options |= QuoteFilterCaseInsensitive;
+    }
+    if (self.filteringDiacriticInsensitiveFiltering) {
+        options |= QuoteFilterDiacriticInsensitive;
+    }
+    QuoteFilterPredicate *predicate = [self.filterEngine predicateWithKey:self.filteringKey condition:condition
+                                                                    value:value options:options];
+    return [self.filterEngine refinedItems:dataToFilter usingPredicate:predicate];
+}
+
+#pragma mark - Sorting
+
+// IG asks for one sorted column per call. For quote rows the engine orders
+// the data by every sorted column at once when asked for the first; the
+// calls for the others get the data back already in order. The result is a
+// view of the sort order, which rowsDidChange: keeps sorted from then on.
+// The order of every row is taken from the cache's permutation, so a sort
+// seen before, or its reverse, is a pass over the rows; an order of every
+// row that ticks kept current goes back into the cache when replaced. A
+// filtered subset is sorted by itself, at the cost of its own rows. A new
+// sort of partialSortMinimumCount rows or more is sorted only as far as the
+// grid reads.
+- (NSArray *)applySort:(NSString *)sortKey toData:(NSArray *)dataToSort ascending:(BOOL)ascending caseInsensitive:(BOOL)caseInsensitive {
+    QuoteSortEngine *engine = [self sortEngineForData:dataToSort];
+    NSArray *descriptors = [self sortDescriptors];
+    if (!engine || self.groupingKey || ![engine canSortUsingDescriptors:descriptors]) {
+        self.sortOrder = nil;
+        self.partialSortOrder = nil;
+        return [super applySort:sortKey toData:dataToSort ascending:ascending caseInsensitive:caseInsensitive];
+    }
+    if (![sortKey isEqualToString:[descriptors.firstObject key]]) {
+        return dataToSort;
+    }
+    BOOL wholeStore = [engine.store isItemArray:dataToSort];
+    // an order of every row kept current, such as one a background sort
+    // just finished, is shown as it is
+    QuoteSortOrder *order = self.sortOrder;
+    if (wholeStore && order.current && order.count == dataToSort.count
+        && [order.descriptors isEqualToArray:descriptors]) {
+        self.partialSortOrder = nil;
+        return order.items;
+    }
+    [self cacheSortOrder];
+    if (dataToSort.count >= self.partialSortMinimumCount
+        && !(wholeStore && [self.sortCache hasPermutationForDescriptors:descriptors])) {
+        self.sortOrder = nil;
+        self.partialSortOrder = [[QuotePartialSortOrder alloc] initWithEngine:engine items:dataToSort
+                                                                   descriptors:descriptors];
+        return self.partialSortOrder.items;
+    }
+    self.partialSortOrder = nil;
+    if (!wholeStore) {
+        // a filtered subset sorts in its own size; a permutation of the store
+        // would cost a pass over every row
+        self.sortOrder = [[QuoteSortOrder alloc] initWithEngine:engine items:dataToSort descriptors:descriptors];
+        return self.sortOrder.items;
+    }
+    NSData *permutation = [self.sortCache permutationForDescriptors:descriptors];
+    self.sortOrder = [[QuoteSortOrder alloc] initWithEngine:engine items:dataToSort descriptors:descriptors
+                                                permutation:permutation];
+    return self.sortOrder.items;
+}
+
+// Hands the sort order to the cache if it covers every row and ticks kept
+// it current.
+- (void)cacheSortOrder {
+    QuoteSortOrder *order = self.sortOrder;
+    if (order.current && order.count == self.sortEngine.store.rowCount) {
+        NSData *rows = [NSData dataWithBytes:order.rows length:order.count * sizeof(uint32_t)];
+        [self.sortCache storePermutation:rows forDescriptors:order.descriptors];
+    }
+}
+
+// Sorts a copy of the columns the sort reads on the scheduler's queue while
+// the grid keeps showing the current order, then shows the new one. Only
+// for quote data covering the whole store, whose sort is not cached;
+// returns NO to sort on the spot instead.
+- (BOOL)sortInBackgroundForGridView:(IGGridView *)gridView {
+    NSArray *data = self.data;
+    // from partialSortMinimumCount rows the grid's rows are selected sooner
+    // than a background sort of all of them finishes
+    if (!self.sortsInBackground || self.groupingKey || data.count < self.backgroundSortMinimumCount
+        || data.count >= self.partialSortMinimumCount) {
+        return NO;
+    }
+    QuoteSortEngine *engine = [self sortEngineForData:data];
+    NSArray *descriptors = [self sortDescriptors];
+    if (!engine || data.count != engine.store.rowCount || ![engine canSortUsingDescriptors:descriptors]) {
+        return NO;
+    }
+    [self cacheSortOrder];
+    if ([self.sortCache hasPermutationForDescriptors:descriptors]) {
+        return NO;
+    }
+    [self.sortCache countMiss];
+    [self submitSortForDescriptors:descriptors engine:engine gridView:gridView
+                         resubmits:kBackgroundSortResubmitLimit];
+    return YES;
+}
+
+// Snapshots the columns the sort reads and sorts them on the scheduler's
+// queue; the rows that tick meanwhile are marked for showPermutation:.
+- (void)submitSortForDescriptors:(NSArray *)descriptors engine:(QuoteSortEngine *)engine
+                        gridView:(IGGridView *)gridView resubmits:(NSUInteger)resubmits {
+    QuoteStore *store = engine.store;
+    QuoteStore *snapshot = [[QuoteStore alloc] init];
+    [snapshot appendRows:store.rowCount];
+    [snapshot copyFields:QuoteFieldMaskForDescriptors(descriptors) fromStore:store toRow:0];
+    self.pendingChangedRows = [NSMutableData dataWithLength:(store.rowCount + 63) / 64 * sizeof(uint64_t)];
+    self.pendingChangedCount = 0;
+    self.pendingChangedFields = 0;
+
+    __weak IGGridViewSortingDataSourceHelper *weakSelf = self;
+    __weak IGGridView *weakGridView = gridView;
+    [self.sortScheduler submitWork:^id(BOOL (^isCancelled)(void)) {
+        QuoteSortEngine *snapshotEngine = [[QuoteSortEngine alloc] initWithStore:snapshot];
+        snapshotEngine.workerCount = engine.workerCount;
+        return [snapshotEngine permutationForDescriptors:descriptors cancelled:isCancelled];
+    } completion:^(NSData *permutation, uint64_t generation) {
+        [weakSelf showPermutation:permutation forDescriptors:descriptors engine:engine gridView:weakGridView
+                        resubmits:resubmits];
+    }];
+}
+
+- (void)showPermutation:(NSData *)permutation forDescriptors:(NSArray *)descriptors engine:(QuoteSortEngine *)engine
+               gridView:(IGGridView *)gridView resubmits:(NSUInteger)resubmits {
+    NSData *changedRows = self.pendingChangedRows;
+    NSUInteger changedCount = self.pendingChangedCount;
+    QuoteFieldMask changedFields = self.pendingChangedFields & QuoteFieldMaskForDescriptors(descriptors);
+    self.pendingChangedRows = nil;
+    if (engine != self.sortEngine || ![descriptors isEqualToArray:[self sortDescriptors]]
+        || self.data.count != engine.store.rowCount || permutation.length != self.data.count * sizeof(uint32_t)) {
+        return;
+    }
+    if (!changedFields) {
+        changedCount = 0;
+    }
+    if (changedCount > self.data.count / kBackgroundSortResortDivisor && resubmits > 0) {
+        [self submitSortForDescriptors:descriptors engine:engine gridView:gridView resubmits:resubmits - 1];
+        return;
+    }
+    // the snapshot missed the ticks since; move those rows now
+    uint32_t *rows = malloc(MAX(changedCount, 1) * sizeof(uint32_t));
+    if (!rows) {
+        [NSException raise:NSMallocException format:@"cannot replay %lu changed rows", (unsigned long)changedCount];
+    }
+    const uint64_t *bits = changedRows.bytes;
+    NSUInteger count = 0;
+    for (NSUInteger word = 0; count < changedCount && word < changedRows.length / sizeof(uint64_t); word++) {
+        for (uint64_t rest = bits[word]; rest; rest &= rest - 1) {
+            rows[count++] = (uint32_t)(word * 64 + __builtin_ctzll(rest));
+        }
+    }
+    QuoteSortOrder *order = [[QuoteSortOrder alloc] initWithEngine:engine items:self.data descriptors:descriptors
+                                                       permutation:permutation];
+    [order updateRows:rows count:count changedFields:changedFields];
+    free(rows);
+    self.sortOrder = order;
+
+    [self invalidateData];
+    [gridView updateData];
+}
+
+- (void)rowsDidChange:(const uint32_t *)rows count:(NSUInteger)count fields:(QuoteFieldMask)fields {
+    NSArray *descriptors = [self sortDescriptors];
+    if (self.pendingChangedRows) {
+        uint64_t *bits = self.pendingChangedRows.mutableBytes;
+        NSUInteger capacity = self.pendingChangedRows.length * 8;
+        NSUInteger added = 0;
+        for (NSUInteger i = 0; i < count; i++) {
+            uint32_t row = rows[i];
+            uint64_t bit = 1ull << (row % 64);
+            if (row < capacity && !(bits[row / 64] & bit)) {
+                bits[row / 64] |= bit;
+                added++;
+            }
+        }
+        self.pendingChangedCount += added;
+        self.pendingChangedFields |= fields;
+    }
+    // while a background sort runs the grid still shows the old order
+    if (self.pendingChangedRows || [self.sortOrder.descriptors isEqualToArray:descriptors]) {
+        [self.sortOrder updateRows:rows count:count changedFields:fields];
+    }
+    if ([self.partialSortOrder.descriptors isEqualToArray:descriptors]) {
+        [self.partialSortOrder updateRows:rows count:count changedFields:fields];
+    }
+}
+
+- (QuoteSortEngine *)sortEngineForData:(NSArray *)data {
+    id first = data.firstObject;
+    if (![first isKindOfClass:[QuoteItem class]]) {
+        return nil;
+    }
+    QuoteStore *store = ((QuoteItem *)first).store;
+    if (self.sortEngine.store != store) {
+        self.sortEngine = [[QuoteSortEngine alloc] initWithStore:store];
+        NSUInteger budget = MAX(kSortCacheByteBudget, kSortCacheMinimumPermutations * store.rowCount * sizeof(uint32_t));
+        self.sortCache = [[QuoteSortCache alloc] initWithEngine:self.sortEngine byteBudget:budget];
+        self.filterEngine = [[QuoteFilterEngine alloc] initWithStore:store];
+        self.sortOrder = nil;
+        self.partialSortOrder = nil;
+    }
+    return self.sortEngine;
+}
+
+- (NSArray *)sortDescriptors {
+    NSMutableArray *descriptors = [NSMutableArray arrayWithCapacity:self.sortedColumns.count];
+    for (IGGridViewSortedColumn *column in self.sortedColumns) {
+        if (column.sortDirection == IGGridViewSortedColumnDirectionNone) {
+            continue;
+        }
+        SEL selector = column.useCaseInsensitiveSort ? @selector(caseInsensitiveCompare:) : @selector(compare:);
+        BOOL ascending = column.sortDirection == IGGridViewSortedColumnDirectionAscending;
+        [descriptors addObject:[NSSortDescriptor sortDescriptorWithKey:column.fieldName ascending:ascending selector:selector]];
+    }
+    return descriptors;
 }
 
 #pragma mark - <IGGridViewSortingDelegate>
@@ -64,27 +367,81 @@
     if(self.sortedColumns.count > 0) {
         sc = self.sortedColumns[0];
         [self.sortedColumns removeAllObjects];
-        direction = [self getNextDirection:sc sortFieldPrefix:col.sortFieldKey];
+        direction = [self getNextDirection:sc forColumn:col];
     }
     
     sc = [self createSortedColumn:col direction:direction];
     
     [self.sortedColumns addObject:sc];
-    
-    if (![sc.fieldName hasPrefix:@"symbolSort"]) {
-        IGGridViewSortedColumn *secondary = [[IGGridViewSortedColumn alloc] initWithField:@"symbolSortAscending" forDirection:IGGridViewSortedColumnDirectionAscending];
-        [self.sortedColumns addObject:secondary];
+
+    [self showSortedColumnsInGridView:gridView];
+}
+
+- (void)gridView:(IGGridView *)gridView appendColumnSorting:(NSInteger)columnIndex fixedColumn:(BOOL)fixed {
+    IGGridViewColumnDefinition* col = fixed ? self.fixedLeftColumns[columnIndex] : self.columns[columnIndex];
+
+    [self appendSortingForColumn:col];
+
+    [self showSortedColumnsInGridView:gridView];
+}
+
+// Sorts by the new sortedColumns in the background when that is worth it,
+// else now, dropping any background sort still running.
+- (void)showSortedColumnsInGridView:(IGGridView *)gridView {
+    if ([self sortInBackgroundForGridView:gridView]) {
+        return;
     }
-        
+    [self.sortScheduler cancel];
+    self.pendingChangedRows = nil;
+
     [self invalidateData];
-    
+
     [gridView updateData];
 }
 
+- (void)appendSortingForColumn:(IGGridViewColumnDefinition *)column {
+    NSUInteger index = [self indexOfSortedColumnForColumn:column];
+    if (index == NSNotFound) {
+        [self.sortedColumns addObject:[self createSortedColumn:column direction:IGGridViewSortedColumnDirectionAscending]];
+        return;
+    }
+    IGGridViewSortedColumnDirection direction = [self getNextDirection:self.sortedColumns[index] forColumn:column];
+    if (direction == IGGridViewSortedColumnDirectionNone) {
+        [self.sortedColumns removeObjectAtIndex:index];
+    } else {
+        self.sortedColumns[index] = [self createSortedColumn:column direction:direction];
+    }
+}
+
+// A column sorts under any of its sort field names.
+- (BOOL)sortedColumn:(IGGridViewSortedColumn *)sortedColumn isForColumn:(IGGridViewColumnDefinition *)column {
+    NSString *field = sortedColumn.fieldName;
+    return [field isEqualToString:column.sortFieldKey] || [field isEqualToString:column.sortFieldKeyAscending]
+        || [field isEqualToString:column.sortFieldKeyDescending];
+}
+
+// The position of the column's key in sortedColumns, or NSNotFound.
+- (NSUInteger)indexOfSortedColumnForColumn:(IGGridViewColumnDefinition *)column {
+    return [self.sortedColumns indexOfObjectPassingTest:^BOOL(IGGridViewSortedColumn *sortedColumn, NSUInteger index, BOOL *stop) {
+        return [self sortedColumn:sortedColumn isForColumn:column];
+    }];
+}
+
+// Priorities are shown once there is more than one key.
+- (void)applySortingOfColumn:(IGGridViewColumnDefinition *)column toHeaderCell:(IGGridViewSortingHeaderCell *)cell {
+    NSUInteger index = [self indexOfSortedColumnForColumn:column];
+    if (index == NSNotFound) {
+        [cell setSortDirection:IGGridViewSortedColumnDirectionNone priority:0];
+        return;
+    }
+    IGGridViewSortedColumn *sortedColumn = self.sortedColumns[index];
+    [cell setSortDirection:sortedColumn.sortDirection priority:self.sortedColumns.count > 1 ? index + 1 : 0];
+}
+
 - (IGGridViewSortedColumnDirection)getNextDirection:(IGGridViewSortedColumn *) column
-                                    sortFieldPrefix:(NSString *)sortFieldPrefix {
+                                          forColumn:(IGGridViewColumnDefinition *)columnDefinition {
     IGGridViewSortedColumnDirection direction = column.sortDirection;
-    if ([column.fieldName hasPrefix:sortFieldPrefix]) {
+    if ([self sortedColumn:column isForColumn:columnDefinition]) {
         if(direction == IGGridViewSortedColumnDirectionAscending) {
             direction = IGGridViewSortedColumnDirectionDescending;
         } else if(direction == IGGridViewSortedColumnDirectionDescending) {
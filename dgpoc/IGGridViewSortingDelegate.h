@@ -3,6 +3,7 @@
 
 @protocol IGGridViewSortingDelegate <NSObject>
 - (void)gridView:(IGGridView *)gridView toggleColumnSorting:(NSInteger)columnIndex fixedColumn:(BOOL)fixed;
+- (void)gridView:(IGGridView *)gridView appendColumnSorting:(NSInteger)columnIndex fixedColumn:(BOOL)fixed;
 @end
 
 #endif /* IGGridViewSortingDelegate_h */
@@ -8,6 +8,8 @@
 @property (nonatomic, assign) BOOL fixed;
 
 - (void)setSortDirection:(IGGridViewSortedColumnDirection)direction;
+/// priority is the key's 1-based place in a multi-column sort, 0 to hide it.
+- (void)setSortDirection:(IGGridViewSortedColumnDirection)direction priority:(NSUInteger)priority;
 - (void)applyTheme:(TDAGridViewTheme *)theme;
 
     
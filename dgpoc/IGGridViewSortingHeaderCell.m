@@ -3,6 +3,7 @@
 @interface IGGridViewSortingHeaderCell ()
 
 @property (nonatomic, strong) UIView *sortIndicator;
+@property (nonatomic, strong) UILabel *priorityLabel;
 
 @end
 
@@ -14,10 +15,15 @@
     
     if (self) {
         UITapGestureRecognizer* tap = [[UITapGestureRecognizer alloc] initWithTarget:self action:@selector(sortHeaderTapped:)];
+        UILongPressGestureRecognizer* press = [[UILongPressGestureRecognizer alloc] initWithTarget:self action:@selector(sortHeaderPressed:)];
         
-        [self registerGestures:@[tap]];
+        [self registerGestures:@[tap, press]];
         self.sortIndicator = [[UIView alloc] init];
         [self addSubview:self.sortIndicator];
+        self.priorityLabel = [[UILabel alloc] init];
+        self.priorityLabel.font = [UIFont boldSystemFontOfSize:10];
+        self.priorityLabel.textAlignment = NSTextAlignmentRight;
+        [self addSubview:self.priorityLabel];
     }
     return self;
     
@@ -28,6 +34,13 @@
     
     self.backgroundColor = [theme headerCellBackgroundColor];
     self.textLabel.textColor = [theme headerCellTextColor];
+    self.priorityLabel.textColor = [theme headerCellTextColor];
+}
+
+- (void)layoutSubviews {
+    [super layoutSubviews];
+    CGRect bounds = self.bounds;
+    self.priorityLabel.frame = CGRectMake(CGRectGetMaxX(bounds) - 16, CGRectGetMinY(bounds), 12, CGRectGetHeight(bounds));
 }
 
 - (void)setSortDirection:(IGGridViewSortedColumnDirection)direction {
@@ -40,8 +53,19 @@
     }
 }
 
+- (void)setSortDirection:(IGGridViewSortedColumnDirection)direction priority:(NSUInteger)priority {
+    [self setSortDirection:direction];
+    self.priorityLabel.text = priority ? [NSString stringWithFormat:@"%lu", (unsigned long)priority] : nil;
+}
+
 - (void)sortHeaderTapped:(UITapGestureRecognizer *)sender {
     [self.delegate gridView:self.gridView toggleColumnSorting:self.path.columnIndex fixedColumn:self.fixed];
 }
 
+- (void)sortHeaderPressed:(UILongPressGestureRecognizer *)sender {
+    if (sender.state == UIGestureRecognizerStateBegan) {
+        [self.delegate gridView:self.gridView appendColumnSorting:self.path.columnIndex fixedColumn:self.fixed];
+    }
+}
+
 @end
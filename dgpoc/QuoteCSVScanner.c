@@ -0,0 +1,259 @@
+#include "QuoteCSVScanner.h"
+
+#include <string.h>
+
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+
+typedef struct {
+    uint64_t comma;
+    uint64_t quote;
+    uint64_t newline;
+} QuoteCSVBlockMasks;
+
+#if defined(__AVX2__)
+
+static inline QuoteCSVBlockMasks QuoteCSVClassify(const uint8_t *p) {
+    const __m256i comma = _mm256_set1_epi8(',');
+    const __m256i quote = _mm256_set1_epi8('"');
+    const __m256i newline = _mm256_set1_epi8('\n');
+    __m256i lo = _mm256_loadu_si256((const __m256i *)p);
+    __m256i hi = _mm256_loadu_si256((const __m256i *)(p + 32));
+
+    QuoteCSVBlockMasks m;
+    m.comma = (uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(lo, comma))
+        | (uint64_t)(uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(hi, comma)) << 32;
+    m.quote = (uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(lo, quote))
+        | (uint64_t)(uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(hi, quote)) << 32;
+    m.newline = (uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(lo, newline))
+        | (uint64_t)(uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(hi, newline)) << 32;
+    return m;
+}
+
+#elif defined(__SSE2__)
+
+static inline QuoteCSVBlockMasks QuoteCSVClassify(const uint8_t *p) {
+    const __m128i comma = _mm_set1_epi8(',');
+    const __m128i quote = _mm_set1_epi8('"');
+    const __m128i newline = _mm_set1_epi8('\n');
+
+    QuoteCSVBlockMasks m = { 0, 0, 0 };
+    for (int i = 0; i < 4; i++) {
+        __m128i v = _mm_loadu_si128((const __m128i *)(p + 16 * i));
+        m.comma |= (uint64_t)(uint16_t)_mm_movemask_epi8(_mm_cmpeq_epi8(v, comma)) << (16 * i);
+        m.quote |= (uint64_t)(uint16_t)_mm_movemask_epi8(_mm_cmpeq_epi8(v, quote)) << (16 * i);
+        m.newline |= (uint64_t)(uint16_t)_mm_movemask_epi8(_mm_cmpeq_epi8(v, newline)) << (16 * i);
+    }
+    return m;
+}
+
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+
+// NEON has no movemask; weight each lane by its bit and fold with pairwise adds.
+static inline uint64_t QuoteCSVMoveMask(uint8x16_t m0, uint8x16_t m1, uint8x16_t m2, uint8x16_t m3) {
+    const uint8x16_t bits = { 0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40, 0x80,
+                              0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40, 0x80 };
+    uint8x16_t s0 = vpaddq_u8(vandq_u8(m0, bits), vandq_u8(m1, bits));
+    uint8x16_t s1 = vpaddq_u8(vandq_u8(m2, bits), vandq_u8(m3, bits));
+    s0 = vpaddq_u8(s0, s1);
+    s0 = vpaddq_u8(s0, s0);
+    return vgetq_lane_u64(vreinterpretq_u64_u8(s0), 0);
+}
+
+static inline QuoteCSVBlockMasks QuoteCSVClassify(const uint8_t *p) {
+    uint8x16_t v0 = vld1q_u8(p), v1 = vld1q_u8(p + 16), v2 = vld1q_u8(p + 32), v3 = vld1q_u8(p + 48);
+    const uint8x16_t comma = vdupq_n_u8(',');
+    const uint8x16_t quote = vdupq_n_u8('"');
+    const uint8x16_t newline = vdupq_n_u8('\n');
+
+    QuoteCSVBlockMasks m;
+    m.comma = QuoteCSVMoveMask(vceqq_u8(v0, comma), vceqq_u8(v1, comma), vceqq_u8(v2, comma), vceqq_u8(v3, comma));
+    m.quote = QuoteCSVMoveMask(vceqq_u8(v0, quote), vceqq_u8(v1, quote), vceqq_u8(v2, quote), vceqq_u8(v3, quote));
+    m.newline = QuoteCSVMoveMask(vceqq_u8(v0, newline), vceqq_u8(v1, newline), vceqq_u8(v2, newline), vceqq_u8(v3, newline));
+    return m;
+}
+
+#else
+
+static inline QuoteCSVBlockMasks QuoteCSVClassify(const uint8_t *p) {
+    QuoteCSVBlockMasks m = { 0, 0, 0 };
+    for (int i = 0; i < 64; i++) {
+        m.comma |= (uint64_t)(p[i] == ',') << i;
+        m.quote |= (uint64_t)(p[i] == '"') << i;
+        m.newline |= (uint64_t)(p[i] == '\n') << i;
+    }
+    return m;
+}
+
+#endif
+
+// Bit i of the result is the parity of quote bits 0..i, i.e. set while inside quotes.
+static inline uint64_t QuoteCSVPrefixXor(uint64_t x) {
+    x ^= x << 1;
+    x ^= x << 2;
+    x ^= x << 4;
+    x ^= x << 8;
+    x ^= x << 16;
+    x ^= x << 32;
+    return x;
+}
+
+size_t QuoteCSVIndex(const char *bytes, size_t length, size_t from, size_t to,
+                     uint64_t *inQuotes, size_t *offsets) {
+    size_t count = 0;
+    uint8_t tail[64];
+
+    for (size_t base = from; base < to; base += 64) {
+        const uint8_t *block = (const uint8_t *)bytes + base;
+        size_t blockLength = length - base < 64 ? length - base : 64;
+        if (blockLength < 64) {
+            memset(tail, 0, sizeof(tail));
+            memcpy(tail, block, blockLength);
+            block = tail;
+        }
+
+        QuoteCSVBlockMasks m = QuoteCSVClassify(block);
+        uint64_t quoted = QuoteCSVPrefixXor(m.quote) ^ *inQuotes;
+        *inQuotes = (uint64_t)((int64_t)quoted >> 63);
+
+        uint64_t structural = (m.comma | m.newline) & ~quoted;
+        while (structural) {
+            offsets[count++] = base + (size_t)__builtin_ctzll(structural);
+            structural &= structural - 1;
+        }
+    }
+    return count;
+}
+
+void QuoteCSVScannerInit(QuoteCSVScanner *scanner, const void *bytes, size_t length) {
+    scanner->bytes = bytes;
+    scanner->length = length;
+    scanner->rowStart = 0;
+    scanner->indexed = 0;
+    scanner->inQuotes = 0;
+    scanner->head = 0;
+    scanner->count = 0;
+}
+
+static bool QuoteCSVScannerRefill(QuoteCSVScanner *scanner) {
+    scanner->head = 0;
+    scanner->count = 0;
+    while (scanner->count == 0 && scanner->indexed < scanner->length) {
+        size_t to = scanner->indexed + QUOTE_CSV_INDEX_CAPACITY;
+        if (to > scanner->length) {
+            to = scanner->length;
+        }
+        scanner->count = QuoteCSVIndex(scanner->bytes, scanner->length, scanner->indexed, to,
+                                       &scanner->inQuotes, scanner->offsets);
+        scanner->indexed = to;
+    }
+    return scanner->count > 0;
+}
+
+static inline void QuoteCSVSetField(QuoteCSVField *field, const char *bytes, size_t start, size_t end) {
+    const char *p = bytes + start;
+    size_t length = end - start;
+    field->escaped = false;
+    if (length >= 2 && p[0] == '"' && p[length - 1] == '"') {
+        p++;
+        length -= 2;
+        field->escaped = memchr(p, '"', length) != NULL;
+    }
+    field->bytes = p;
+    field->length = length;
+}
+
+size_t QuoteCSVScannerNextRow(QuoteCSVScanner *scanner, QuoteCSVField *fields, size_t capacity) {
+    const char *bytes = scanner->bytes;
+
+    while (scanner->rowStart < scanner->length) {
+        size_t count = 0;
+        size_t start = scanner->rowStart;
+        size_t end;
+        bool endOfLine = false;
+        bool empty = false;
+
+        while (!endOfLine) {
+            if (scanner->head == scanner->count && !QuoteCSVScannerRefill(scanner)) {
+                end = scanner->length;
+                endOfLine = true;
+            } else {
+                end = scanner->offsets[scanner->head++];
+                endOfLine = bytes[end] == '\n';
+            }
+
+            size_t fieldEnd = end;
+            if (endOfLine && fieldEnd > start && bytes[fieldEnd - 1] == '\r') {
+                fieldEnd--;
+            }
+            if (count == 0) {
+                empty = fieldEnd == start;
+            }
+            if (count < capacity) {
+                QuoteCSVSetField(&fields[count], bytes, start, fieldEnd);
+            }
+            count++;
+            start = end + 1;
+        }
+        scanner->rowStart = start;
+
+        // blank lines (typically the trailing one) are not rows
+        if (count > 1 || !empty) {
+            return count;
+        }
+    }
+    return 0;
+}
+
+bool QuoteCSVScannerSkipRow(QuoteCSVScanner *scanner) {
+    return QuoteCSVScannerNextRow(scanner, NULL, 0) > 0;
+}
+
+static size_t QuoteCSVCountQuotes(const char *p, const char *end) {
+    size_t count = 0;
+    while ((p = memchr(p, '"', (size_t)(end - p)))) {
+        count++;
+        p++;
+    }
+    return count;
+}
+
+void QuoteCSVSplitRows(const char *bytes, size_t length, size_t start, size_t chunkCount, size_t *boundaries) {
+    size_t position = start;
+    size_t quotes = 0;
+
+    boundaries[0] = start;
+    for (size_t i = 1; i < chunkCount; i++) {
+        size_t target = start + (length - start) / chunkCount * i;
+        if (target > position) {
+            quotes += QuoteCSVCountQuotes(bytes + position, bytes + target);
+            position = target;
+        }
+        // the chunk ends after the next newline that is not inside quotes
+        while (position < length) {
+            const char *newline = memchr(bytes + position, '\n', length - position);
+            size_t end = newline ? (size_t)(newline - bytes) : length;
+            quotes += QuoteCSVCountQuotes(bytes + position, bytes + end);
+            position = end < length ? end + 1 : end;
+            if (quotes % 2 == 0) {
+                break;
+            }
+        }
+        boundaries[i] = position;
+    }
+    boundaries[chunkCount] = length;
+}
+
+size_t QuoteCSVFieldUnescape(QuoteCSVField field, char *buffer, size_t capacity) {
+    size_t length = 0;
+    for (size_t i = 0; i < field.length && length < capacity; i++) {
+        buffer[length++] = field.bytes[i];
+        if (field.bytes[i] == '"' && i + 1 < field.length && field.bytes[i + 1] == '"') {
+            i++;
+        }
+    }
+    return length;
+}
@@ -0,0 +1,67 @@
+//
+//  QuoteCSVScanner.h
+//  dgpoc
+//
+//  Single pass, zero copy row scanner over a CSV buffer. Fields are handed
+//  back as slices into the buffer, so nothing is allocated per row or field.
+//
+//  Separators are found by a structural index pass (QuoteCSVIndex) that
+//  classifies 64 bytes at a time with SSE2/AVX2/NEON and masks out anything
+//  inside RFC 4180 quoted fields. The scanner only ever looks at the offsets
+//  it produces.
+//
+
+#ifndef QuoteCSVScanner_h
+#define QuoteCSVScanner_h
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define QUOTE_CSV_INDEX_CAPACITY 1024
+
+typedef struct {
+    const char *bytes;
+    size_t length;
+    bool escaped;   // quoted field containing "" pairs, see QuoteCSVFieldUnescape
+} QuoteCSVField;
+
+typedef struct {
+    const char *bytes;
+    size_t length;
+    size_t rowStart;
+    size_t indexed;
+    uint64_t inQuotes;
+    size_t head;
+    size_t count;
+    size_t offsets[QUOTE_CSV_INDEX_CAPACITY];
+} QuoteCSVScanner;
+
+void QuoteCSVScannerInit(QuoteCSVScanner *scanner, const void *bytes, size_t length);
+
+/// Splits the next non-empty row into fields. Returns the number of fields in
+/// the row (which may exceed capacity; extra fields are dropped) or 0 at end.
+/// Quoted fields come back without their surrounding quotes.
+size_t QuoteCSVScannerNextRow(QuoteCSVScanner *scanner, QuoteCSVField *fields, size_t capacity);
+
+/// Skips the next row without splitting it, e.g. the header.
+bool QuoteCSVScannerSkipRow(QuoteCSVScanner *scanner);
+
+/// Collapses "" pairs of an escaped field into buffer. Returns the unescaped
+/// length, truncated to capacity.
+size_t QuoteCSVFieldUnescape(QuoteCSVField field, char *buffer, size_t capacity);
+
+/// Splits bytes[start, length) into chunkCount runs of whole rows of roughly
+/// equal size, never breaking inside a quoted field. boundaries receives
+/// chunkCount + 1 offsets; chunk i is [boundaries[i], boundaries[i + 1]) and
+/// may be empty when there are fewer rows than chunks.
+void QuoteCSVSplitRows(const char *bytes, size_t length, size_t start, size_t chunkCount, size_t *boundaries);
+
+/// Appends the offsets of every unquoted ',' and '\n' in bytes[from, to) to
+/// offsets, returning how many were written. from and to must be multiples of
+/// 64 unless to == length. inQuotes carries quote state between calls and must
+/// start at 0. offsets needs room for (to - from) entries.
+size_t QuoteCSVIndex(const char *bytes, size_t length, size_t from, size_t to,
+                     uint64_t *inQuotes, size_t *offsets);
+
+#endif /* QuoteCSVScanner_h */
@@ -0,0 +1,134 @@
+//
+//  QuoteFilterEngine.h
+//  dgpoc
+//
+//  Filters the rows of a QuoteStore by a condition on one field without KVC
+//  or a predicate per row. The condition is compiled once into a
+//  QuoteFilterPredicate typed by the column behind its key:
+//
+//      fixed       the value parsed to the field's ticks, exactly; a range
+//                  of int64s
+//      double      the value parsed once; a range of doubles
+//      string      the condition decided once per distinct string, over its
+//                  folded bytes, into a match flag by code
+//
+//  so a row costs a load and a compare, and a list of rows is filtered in
+//  one pass with no branch per row. Missing values match only not-equal, as
+//  nil does in an NSPredicate.
+//
+//  Folding (lowercase and/or marks stripped, as NSString folding does) is
+//  done once per distinct string and kept by the engine, which folds new
+//  strings as the store interns them.
+//
+//  A case-insensitive begins-with on symbol or underlying symbol over the
+//  whole store's items (QuoteStore isItemArray:) skips the pass altogether:
+//  the symbol index hands back just the matching rows.
+//
+//  Names are also searched by word (itemsMatchingName:): the engine keeps a
+//  QuoteNameIndex over the names folded of case and marks, fed as the store
+//  interns them, and orders the rows it finds by how well their names
+//  match.
+//
+//  Search as you type keeps each query's result, so a query that narrows
+//  the last one filters only what that one found (refinedItems:).
+//
+
+#import <Foundation/Foundation.h>
+#import "QuoteStore.h"
+#import "QuoteSymbolIndex.h"
+
+/// The conditions of IGGridViewFilterConditionType, in its order. The
+/// first five are for string fields, the rest for numeric ones.
+typedef NS_ENUM(NSUInteger, QuoteFilterCondition) {
+    QuoteFilterConditionContains,
+    QuoteFilterConditionBeginsWith,
+    QuoteFilterConditionEndsWith,
+    QuoteFilterConditionLike,           // NSPredicate LIKE: * and ? wildcards
+    QuoteFilterConditionMatches,        // NSPredicate MATCHES: a regular expression
+    QuoteFilterConditionEqual,
+    QuoteFilterConditionNotEqual,
+    QuoteFilterConditionGreater,
+    QuoteFilterConditionGreaterOrEqual,
+    QuoteFilterConditionLess,
+    QuoteFilterConditionLessOrEqual,
+};
+
+typedef NS_OPTIONS(NSUInteger, QuoteFilterOptions) {
+    QuoteFilterCaseInsensitive = 1 << 0,
+    QuoteFilterDiacriticInsensitive = 1 << 1,
+};
+
+/// A compiled condition. Only the engine that made it can evaluate it; it
+/// stays valid as rows are appended and strings interned.
+@interface QuoteFilterPredicate : NSObject
+
+@property (nonatomic, readonly) QuoteField field;
+@property (nonatomic, readonly) QuoteFilterCondition condition;
+@property (nonatomic, readonly) NSString *value;
+@property (nonatomic, readonly) QuoteFilterOptions options;
+
+- (instancetype)init NS_UNAVAILABLE;
+
+@end
+
+@interface QuoteFilterEngine : NSObject
+
+@property (nonatomic, readonly) QuoteStore *store;
+/// Built on first use. Changes to the symbols of rows already in the store
+/// must be reported to it (QuoteSymbolIndex updateRows:).
+@property (nonatomic, readonly) QuoteSymbolIndex *symbolIndex;
+
+- (instancetype)initWithStore:(QuoteStore *)store NS_DESIGNATED_INITIALIZER;
+- (instancetype)init NS_UNAVAILABLE;
+
+/// YES when key names a store field of the condition's kind: a string field
+/// for the string conditions, a fixed or double field for the others.
+- (BOOL)canFilterKey:(NSString *)key condition:(QuoteFilterCondition)condition;
+
+/// Compiles the condition; canFilterKey: must allow it. Numeric values may
+/// carry more places than the field: "bid > 1.00005" keeps bids of 1.0001
+/// and up. A value that is not a number matches no rows.
+- (QuoteFilterPredicate *)predicateWithKey:(NSString *)key condition:(QuoteFilterCondition)condition
+                                     value:(NSString *)value options:(QuoteFilterOptions)options;
+
+/// Writes the index in rows of each row predicate matches, in order, to
+/// matches, which has room for count, and returns how many there are.
+- (NSUInteger)filterRows:(const uint32_t *)rows count:(NSUInteger)count
+          usingPredicate:(QuoteFilterPredicate *)predicate matches:(uint32_t *)matches;
+
+/// The items, which must be QuoteItems of the store, that predicate matches,
+/// in their order.
+- (NSArray *)filteredItems:(NSArray *)items usingPredicate:(QuoteFilterPredicate *)predicate;
+
+/// Indexes the words of names interned since the last call. Searches do so
+/// themselves; loaders call it once the names are in so the first
+/// keystroke does not.
+- (void)indexNames;
+
+/// YES when query has a word, a run of letters or digits, to search names
+/// by; a query of spaces and punctuation alone finds no name.
+- (BOOL)canSearchName:(NSString *)query;
+
+/// The items, QuoteItems of the store, whose symbol name has every word of
+/// query as a word, the start of one, or (from three letters) part of one,
+/// folded of case and marks: "first so" finds First Solar, "wesson" Smith &
+/// Wesson. Better matches come first, exact words before starts before
+/// parts, then names in case-insensitive order, then the items' order.
+- (NSArray *)itemsMatchingName:(NSString *)query inItems:(NSArray *)items;
+
+/// The same two, for search as you type. Each result is kept on a stack
+/// while the queries after it refine it: a contains, begins-with or
+/// ends-with value that still holds the last one, or a name query whose
+/// words grow ("AA" then "AAP"), is filtered from the last result, not from
+/// items. A query that does not refine pops results until one it does, so
+/// backspacing to a query on the stack returns its result at once. The
+/// stack is dropped for other items (any of the store's own items arrays of
+/// one length count as the same), another key, condition or options, or
+/// once the filtered field changes in the store.
+- (NSArray *)refinedItems:(NSArray *)items usingPredicate:(QuoteFilterPredicate *)predicate;
+- (NSArray *)refinedItemsMatchingName:(NSString *)query inItems:(NSArray *)items;
+
+/// Drops the kept results, as when the data being filtered is replaced.
+- (void)forgetRefinements;
+
+@end
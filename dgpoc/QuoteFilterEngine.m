@@ -0,0 +1,769 @@
+#import "QuoteFilterEngine.h"
+#import "QuoteItem.h"
+#import "QuoteNameIndex.h"
+#import "QuoteNumberParser.h"
+
+typedef enum {
+    QuoteFilterColumnTypeFixed,
+    QuoteFilterColumnTypeDouble,
+    QuoteFilterColumnTypeCode,
+} QuoteFilterColumnType;
+
+static QuoteFilterColumnType QuoteFilterColumnTypeOf(QuoteField field) {
+    switch (QuoteFieldTypeOf(field)) {
+        case QuoteFieldTypeFixed:
+            return QuoteFilterColumnTypeFixed;
+        case QuoteFieldTypeDouble:
+            return QuoteFilterColumnTypeDouble;
+        case QuoteFieldTypeString:
+            return QuoteFilterColumnTypeCode;
+    }
+}
+
+static BOOL QuoteFilterConditionIsNumeric(QuoteFilterCondition condition) {
+    return condition >= QuoteFilterConditionEqual;
+}
+
+// value as ticks of `decimals` places rounded toward minus infinity; exact
+// is NO when digits past those places were dropped that were not all zero.
+static BOOL QuoteFilterParseFixed(NSString *value, unsigned decimals, int64_t *ticks, BOOL *exact) {
+    NSData *utf8 = [value dataUsingEncoding:NSUTF8StringEncoding];
+    const char *bytes = utf8.bytes;
+    size_t length = utf8.length;
+    size_t kept = length;
+    *exact = YES;
+    const char *point = memchr(bytes, '.', length);
+    if (point && length - (size_t)(point + 1 - bytes) > decimals) {
+        kept = (size_t)(point - bytes) + (decimals ? decimals + 1 : 0);
+        for (size_t i = (size_t)(point + 1 - bytes) + decimals; i < length; i++) {
+            if (bytes[i] < '0' || bytes[i] > '9') {
+                return NO;
+            }
+            *exact &= bytes[i] == '0';
+        }
+    }
+    if (!QuoteParseFixed(bytes, kept, decimals, ticks)) {
+        return NO;
+    }
+    // the digits dropped truncated toward zero
+    if (!*exact && length && bytes[0] == '-') {
+        (*ticks)--;
+    }
+    return YES;
+}
+
+// Appends the bytes folded by options: ASCII letters lowered in place, any
+// other string through NSString folding.
+static void QuoteFilterAppendFolded(NSMutableData *heap, const char *bytes, size_t length, QuoteFilterOptions options) {
+    BOOL ascii = YES;
+    for (size_t i = 0; i < length && ascii; i++) {
+        ascii = (uint8_t)bytes[i] < 0x80;
+    }
+    if (ascii) {
+        NSUInteger start = heap.length;
+        [heap appendBytes:bytes length:length];
+        if (options & QuoteFilterCaseInsensitive) {
+            char *folded = (char *)heap.mutableBytes + start;
+            for (size_t i = 0; i < length; i++) {
+                if (folded[i] >= 'A' && folded[i] <= 'Z') {
+                    folded[i] += 'a' - 'A';
+                }
+            }
+        }
+        return;
+    }
+    NSStringCompareOptions foldOptions = 0;
+    if (options & QuoteFilterCaseInsensitive) {
+        foldOptions |= NSCaseInsensitiveSearch;
+    }
+    if (options & QuoteFilterDiacriticInsensitive) {
+        foldOptions |= NSDiacriticInsensitiveSearch;
+    }
+    @autoreleasepool {
+        NSString *string = [[NSString alloc] initWithBytesNoCopy:(void *)bytes length:length
+                                                        encoding:NSUTF8StringEncoding freeWhenDone:NO];
+        NSString *folded = [string stringByFoldingWithOptions:foldOptions locale:nil];
+        [heap appendBytes:folded.UTF8String length:[folded lengthOfBytesUsingEncoding:NSUTF8StringEncoding]];
+    }
+}
+
+// Rows inside [low, high] match, or outside it when inverted. The range
+// test is one unsigned compare.
+static NSUInteger QuoteFilterFixedRows(const int64_t *column, const uint32_t *rows, NSUInteger count,
+                                       int64_t low, int64_t high, bool inverted, uint32_t *matches) {
+    uint64_t width = (uint64_t)high - (uint64_t)low;
+    NSUInteger matchCount = 0;
+    for (NSUInteger i = 0; i < count; i++) {
+        matches[matchCount] = (uint32_t)i;
+        matchCount += ((uint64_t)column[rows[i]] - (uint64_t)low <= width) ^ inverted;
+    }
+    return matchCount;
+}
+
+// NaN is outside every range, so missing values match only when inverted.
+static NSUInteger QuoteFilterDoubleRows(const double *column, const uint32_t *rows, NSUInteger count,
+                                        double low, double high, bool inverted, uint32_t *matches) {
+    NSUInteger matchCount = 0;
+    for (NSUInteger i = 0; i < count; i++) {
+        double value = column[rows[i]];
+        matches[matchCount] = (uint32_t)i;
+        matchCount += ((value >= low) & (value <= high)) ^ inverted;
+    }
+    return matchCount;
+}
+
+static NSUInteger QuoteFilterCodeRows(const uint32_t *column, const uint8_t *matchesByCode, const uint32_t *rows,
+                                      NSUInteger count, uint32_t *matches) {
+    NSUInteger matchCount = 0;
+    for (NSUInteger i = 0; i < count; i++) {
+        matches[matchCount] = (uint32_t)i;
+        matchCount += matchesByCode[column[rows[i]]];
+    }
+    return matchCount;
+}
+
+#pragma mark -
+
+// One string table's strings folded by one set of options, by code, grown
+// as the table grows.
+@interface QuoteFilterFoldedStrings : NSObject
+
+@property (nonatomic, readonly) NSMutableData *heap;
+// uint32s; code c folds to heap[offsets[c - 1], offsets[c])
+@property (nonatomic, readonly) NSMutableData *offsets;
+@property (nonatomic, readonly) uint32_t count;
+
+@end
+
+@implementation QuoteFilterFoldedStrings
+
+- (instancetype)init {
+    self = [super init];
+    if (self) {
+        _heap = [NSMutableData data];
+        uint32_t start = 0;
+        _offsets = [NSMutableData dataWithBytes:&start length:sizeof(start)];
+    }
+    return self;
+}
+
+- (uint32_t)count {
+    return (uint32_t)(_offsets.length / sizeof(uint32_t) - 1);
+}
+
+@end
+
+#pragma mark -
+
+@interface QuoteFilterPredicate ()
+
+- (instancetype)initWithField:(QuoteField)field condition:(QuoteFilterCondition)condition value:(NSString *)value
+                      options:(QuoteFilterOptions)options NS_DESIGNATED_INITIALIZER;
+
+@property (nonatomic, readwrite) QuoteField field;
+@property (nonatomic, readwrite) QuoteFilterCondition condition;
+@property (nonatomic, readwrite, copy) NSString *value;
+@property (nonatomic, readwrite) QuoteFilterOptions options;
+@property (nonatomic, assign) QuoteFilterColumnType columnType;
+
+// fixed and double fields: rows inside [low, high] match, or outside it
+// when inverted
+@property (nonatomic, assign) int64_t fixedLow;
+@property (nonatomic, assign) int64_t fixedHigh;
+@property (nonatomic, assign) double doubleLow;
+@property (nonatomic, assign) double doubleHigh;
+@property (nonatomic, assign) BOOL inverted;
+
+// string fields: the folded value for contains and the ends, a predicate
+// for like and matches, and a flag per code decided so far; code 0, no
+// string, never matches
+@property (nonatomic, strong) NSData *foldedValue;
+@property (nonatomic, strong) NSPredicate *stringPredicate;
+@property (nonatomic, strong) NSMutableData *matchesByCode;
+
+@end
+
+@implementation QuoteFilterPredicate
+
+- (instancetype)initWithField:(QuoteField)field condition:(QuoteFilterCondition)condition value:(NSString *)value
+                      options:(QuoteFilterOptions)options {
+    self = [super init];
+    if (self) {
+        _field = field;
+        _condition = condition;
+        _value = [value copy];
+        _options = options;
+        _columnType = QuoteFilterColumnTypeOf(field);
+        switch (_columnType) {
+            case QuoteFilterColumnTypeFixed:
+                [self compileFixed];
+                break;
+            case QuoteFilterColumnTypeDouble:
+                [self compileDouble];
+                break;
+            case QuoteFilterColumnTypeCode:
+                [self compileString];
+                break;
+        }
+    }
+    return self;
+}
+
+// The range of integer ticks x with x <condition> v, v being the value. A
+// value between two ticks has none equal to it.
+- (void)compileFixed {
+    NSString *value = [_value stringByTrimmingCharactersInSet:[NSCharacterSet whitespaceCharacterSet]];
+    int64_t ticks;
+    BOOL exact;
+    if (!QuoteFilterParseFixed(value, QuoteFieldDecimals(_field), &ticks, &exact)) {
+        [self setFixedLow:1 high:0 inverted:NO];
+        return;
+    }
+    // keeps the neighbours below in range; no price comes near either end
+    ticks = MAX(MIN(ticks, INT64_MAX - 1), INT64_MIN + 2);
+    int64_t above = ticks + 1;
+    int64_t below = exact ? ticks - 1 : ticks;
+    int64_t atLeast = exact ? ticks : ticks + 1;
+    int64_t atMost = ticks;
+    // missing is INT64_MIN, below every range but the inverted ones
+    int64_t lowest = INT64_MIN + 1;
+    switch (_condition) {
+        case QuoteFilterConditionEqual:
+            [self setFixedLow:atLeast high:atMost inverted:NO];
+            break;
+        case QuoteFilterConditionNotEqual:
+            [self setFixedLow:atLeast high:atMost inverted:YES];
+            break;
+        case QuoteFilterConditionGreater:
+            [self setFixedLow:above high:INT64_MAX inverted:NO];
+            break;
+        case QuoteFilterConditionGreaterOrEqual:
+            [self setFixedLow:atLeast high:INT64_MAX inverted:NO];
+            break;
+        case QuoteFilterConditionLess:
+            [self setFixedLow:lowest high:below inverted:NO];
+            break;
+        case QuoteFilterConditionLessOrEqual:
+            [self setFixedLow:lowest high:atMost inverted:NO];
+            break;
+        default:
+            NSAssert(NO, @"%lu is not a numeric condition", (unsigned long)_condition);
+            break;
+    }
+}
+
+// An empty range matches nothing, or everything when inverted; both are
+// kept as the full range, which the unsigned range test needs.
+- (void)setFixedLow:(int64_t)low high:(int64_t)high inverted:(BOOL)inverted {
+    if (low > high) {
+        low = INT64_MIN;
+        high = INT64_MAX;
+        inverted = !inverted;
+    }
+    _fixedLow = low;
+    _fixedHigh = high;
+    _inverted = inverted;
+}
+
+- (void)compileDouble {
+    NSData *utf8 = [_value dataUsingEncoding:NSUTF8StringEncoding];
+    double value;
+    _inverted = NO;
+    _doubleLow = INFINITY;
+    _doubleHigh = -INFINITY;
+    if (!QuoteParseDouble(utf8.bytes, utf8.length, &value)) {
+        return;
+    }
+    switch (_condition) {
+        case QuoteFilterConditionEqual:
+            _doubleLow = _doubleHigh = value;
+            break;
+        case QuoteFilterConditionNotEqual:
+            _doubleLow = _doubleHigh = value;
+            _inverted = YES;
+            break;
+        case QuoteFilterConditionGreater:
+            _doubleLow = nextafter(value, INFINITY);
+            _doubleHigh = INFINITY;
+            break;
+        case QuoteFilterConditionGreaterOrEqual:
+            _doubleLow = value;
+            _doubleHigh = INFINITY;
+            break;
+        case QuoteFilterConditionLess:
+            _doubleLow = -INFINITY;
+            _doubleHigh = nextafter(value, -INFINITY);
+            break;
+        case QuoteFilterConditionLessOrEqual:
+            _doubleLow = -INFINITY;
+            _doubleHigh = value;
+            break;
+        default:
+            NSAssert(NO, @"%lu is not a numeric condition", (unsigned long)_condition);
+            break;
+    }
+}
+
+- (void)compileString {
+    uint8_t noString = 0;
+    _matchesByCode = [NSMutableData dataWithBytes:&noString length:1];
+    if (_condition == QuoteFilterConditionLike || _condition == QuoteFilterConditionMatches) {
+        NSString *modifiers = @"";
+        if (_options) {
+            modifiers = [NSString stringWithFormat:@"[%@%@]", _options & QuoteFilterCaseInsensitive ? @"c" : @"",
+                         _options & QuoteFilterDiacriticInsensitive ? @"d" : @""];
+        }
+        NSString *operator = _condition == QuoteFilterConditionLike ? @"LIKE" : @"MATCHES";
+        NSString *format = [NSString stringWithFormat:@"SELF %@%@ %%@", operator, modifiers];
+        _stringPredicate = [NSPredicate predicateWithFormat:format, _value];
+        return;
+    }
+    NSData *utf8 = [_value dataUsingEncoding:NSUTF8StringEncoding];
+    NSMutableData *folded = [NSMutableData data];
+    QuoteFilterAppendFolded(folded, utf8.bytes, utf8.length, _options);
+    _foldedValue = folded;
+}
+
+@end
+
+#pragma mark -
+
+// A filter's result, kept while the queries after it refine it.
+@interface QuoteFilterRefinement : NSObject
+
+@property (nonatomic, assign) QuoteField field;
+@property (nonatomic, assign) QuoteFilterCondition condition;
+@property (nonatomic, assign) QuoteFilterOptions options;
+@property (nonatomic, assign) BOOL byName;          // itemsMatchingName:, not a predicate
+@property (nonatomic, strong) NSData *value;        // folded as the filter compares it
+@property (nonatomic, strong) NSArray *result;
+
+@end
+
+@implementation QuoteFilterRefinement
+
+- (BOOL)isSameFilterAs:(QuoteFilterRefinement *)other {
+    return _field == other.field && _condition == other.condition && _options == other.options
+        && _byName == other.byName;
+}
+
+// YES when query's result is a subset of this one's (or is this one's), so
+// it can be filtered from it.
+- (BOOL)isRefinedBy:(QuoteFilterRefinement *)query {
+    NSData *refined = query.value;
+    if ([_value isEqualToData:refined]) {
+        return YES;
+    }
+    if (_byName) {
+        return QuoteNameIndexQueryRefines(_value.bytes, _value.length, refined.bytes, refined.length);
+    }
+    // an empty value matches nothing, so nothing narrows from it
+    if (_value.length == 0 || refined.length < _value.length) {
+        return NO;
+    }
+    switch (_condition) {
+        case QuoteFilterConditionContains:
+            return memmem(refined.bytes, refined.length, _value.bytes, _value.length) != NULL;
+        case QuoteFilterConditionBeginsWith:
+            return memcmp(refined.bytes, _value.bytes, _value.length) == 0;
+        case QuoteFilterConditionEndsWith:
+            return memcmp((const char *)refined.bytes + refined.length - _value.length, _value.bytes,
+                          _value.length) == 0;
+        default:
+            return NO;
+    }
+}
+
+@end
+
+#pragma mark -
+
+// Refinements kept at most; the oldest goes first.
+static const NSUInteger kQuoteFilterRefinementDepth = 32;
+
+// Names are indexed and searched folded both ways, whatever the grid's
+// settings.
+static const QuoteFilterOptions kQuoteFilterNameFolding = QuoteFilterCaseInsensitive | QuoteFilterDiacriticInsensitive;
+
+@implementation QuoteFilterEngine {
+    NSMutableDictionary *_foldedStrings;    // by string table owner and options
+    QuoteSymbolIndex *_symbolIndex;
+    QuoteNameIndex _nameIndex;              // name codes 1...nameCount
+    NSMutableArray *_refinements;           // each refining the one before
+    NSArray *_refinedItems;                 // the items they filtered
+    uint64_t _refinedVersion;               // of their field, then
+}
+
+- (instancetype)initWithStore:(QuoteStore *)store {
+    NSParameterAssert(store);
+    self = [super init];
+    if (self) {
+        _store = store;
+        _foldedStrings = [NSMutableDictionary dictionary];
+        QuoteNameIndexInit(&_nameIndex);
+        _refinements = [NSMutableArray array];
+    }
+    return self;
+}
+
+- (void)dealloc {
+    QuoteNameIndexFree(&_nameIndex);
+}
+
+- (BOOL)canFilterKey:(NSString *)key condition:(QuoteFilterCondition)condition {
+    QuoteField field = key ? QuoteFieldForKey(key) : QuoteFieldCount;
+    if (field == QuoteFieldCount || condition > QuoteFilterConditionLessOrEqual) {
+        return NO;
+    }
+    BOOL stringField = QuoteFieldTypeOf(field) == QuoteFieldTypeString;
+    return stringField != QuoteFilterConditionIsNumeric(condition);
+}
+
+- (QuoteFilterPredicate *)predicateWithKey:(NSString *)key condition:(QuoteFilterCondition)condition
+                                     value:(NSString *)value options:(QuoteFilterOptions)options {
+    if (![self canFilterKey:key condition:condition]) {
+        [NSException raise:NSInvalidArgumentException format:@"QuoteFilterEngine cannot filter %@ by condition %lu",
+         key, (unsigned long)condition];
+    }
+    return [[QuoteFilterPredicate alloc] initWithField:QuoteFieldForKey(key) condition:condition value:value ?: @""
+                                               options:options];
+}
+
+- (NSUInteger)filterRows:(const uint32_t *)rows count:(NSUInteger)count
+          usingPredicate:(QuoteFilterPredicate *)predicate matches:(uint32_t *)matches {
+    QuoteField field = predicate.field;
+    switch (predicate.columnType) {
+        case QuoteFilterColumnTypeFixed:
+            return QuoteFilterFixedRows([_store fixedColumn:field], rows, count, predicate.fixedLow,
+                                        predicate.fixedHigh, predicate.inverted, matches);
+        case QuoteFilterColumnTypeDouble:
+            return QuoteFilterDoubleRows([_store doubleColumn:field], rows, count, predicate.doubleLow,
+                                         predicate.doubleHigh, predicate.inverted, matches);
+        case QuoteFilterColumnTypeCode:
+            [self decideCodesOfPredicate:predicate];
+            return QuoteFilterCodeRows([_store codeColumn:field], predicate.matchesByCode.bytes, rows, count, matches);
+    }
+}
+
+- (QuoteSymbolIndex *)symbolIndex {
+    if (!_symbolIndex) {
+        _symbolIndex = [[QuoteSymbolIndex alloc] initWithStore:_store];
+    }
+    return _symbolIndex;
+}
+
+- (NSArray *)filteredItems:(NSArray *)items usingPredicate:(QuoteFilterPredicate *)predicate {
+    NSUInteger count = items.count;
+    if (count == 0) {
+        return @[];
+    }
+    if ([self canLookUpPredicate:predicate] && [_store isItemArray:items]) {
+        return [self lookUpItems:items usingPredicate:predicate];
+    }
+    uint32_t *rows = malloc(2 * count * sizeof(uint32_t));
+    __unsafe_unretained id *objects = (__unsafe_unretained id *)malloc(count * sizeof(id));
+    if (!rows || !objects) {
+        free(rows);
+        free(objects);
+        [NSException raise:NSMallocException format:@"QuoteFilterEngine cannot filter %lu items", (unsigned long)count];
+    }
+    [items getObjects:objects range:NSMakeRange(0, count)];
+    for (NSUInteger i = 0; i < count; i++) {
+        QuoteItem *item = objects[i];
+        if (item.store != _store) {
+            free(rows);
+            free(objects);
+            [NSException raise:NSInvalidArgumentException format:@"%@ is not a row of the filtered store", item];
+        }
+        rows[i] = (uint32_t)item.row;
+    }
+
+    uint32_t *matches = rows + count;
+    NSUInteger matchCount = [self filterRows:rows count:count usingPredicate:predicate matches:matches];
+    // each match is at or after its place, so the objects move down in place
+    for (NSUInteger i = 0; i < matchCount; i++) {
+        objects[i] = objects[matches[i]];
+    }
+    NSArray *result = [NSArray arrayWithObjects:objects count:matchCount];
+    free(rows);
+    free(objects);
+    return result;
+}
+
+#pragma mark - Symbol lookups
+
+// The index folds ASCII case only, as the value must then be ASCII; an
+// empty value matches nothing here but everything there.
+- (BOOL)canLookUpPredicate:(QuoteFilterPredicate *)predicate {
+    QuoteField field = predicate.field;
+    if ((field != QuoteFieldSymbol && field != QuoteFieldUnderlyingSymbol)
+        || predicate.condition != QuoteFilterConditionBeginsWith || !(predicate.options & QuoteFilterCaseInsensitive)
+        || predicate.value.length == 0) {
+        return NO;
+    }
+    return [predicate.value canBeConvertedToEncoding:NSASCIIStringEncoding];
+}
+
+// items is the store's own, so the index's row ids are its indexes.
+- (NSArray *)lookUpItems:(NSArray *)items usingPredicate:(QuoteFilterPredicate *)predicate {
+    NSData *found = [self.symbolIndex rowsWithPrefix:predicate.value fields:QuoteFieldMaskOf(predicate.field)];
+    const uint32_t *rows = found.bytes;
+    NSUInteger rowCount = found.length / sizeof(uint32_t);
+    NSUInteger count = items.count;
+    NSMutableArray *result = [NSMutableArray arrayWithCapacity:rowCount];
+    // ascending, so rows appended after items was made come last
+    for (NSUInteger i = 0; i < rowCount && rows[i] < count; i++) {
+        [result addObject:items[rows[i]]];
+    }
+    return result;
+}
+
+#pragma mark - Name search
+
+- (void)indexNames {
+    QuoteFilterFoldedStrings *folded = [self foldedStringsForField:QuoteFieldSymbolName
+                                                          options:kQuoteFilterNameFolding];
+    uint32_t count = folded.count;
+    if (_nameIndex.nameCount == count) {
+        return;
+    }
+    const char *heap = folded.heap.bytes;
+    const uint32_t *offsets = folded.offsets.bytes;
+    for (uint32_t code = _nameIndex.nameCount + 1; code <= count; code++) {
+        if (!QuoteNameIndexAdd(&_nameIndex, code, heap + offsets[code - 1], offsets[code] - offsets[code - 1])) {
+            [NSException raise:NSMallocException format:@"QuoteFilterEngine cannot index name %u", code];
+        }
+    }
+    // the ranking's tie break, so it is not sorted on the first search either
+    [_store stringRanksForField:QuoteFieldSymbolName caseInsensitive:YES];
+}
+
+- (BOOL)canSearchName:(NSString *)query {
+    NSData *utf8 = [query dataUsingEncoding:NSUTF8StringEncoding];
+    return QuoteNameIndexWordCount(utf8.bytes, utf8.length) > 0;
+}
+
+// The index ranks the matching names; the items are then bucketed by their
+// name's place in that ranking, in one pass each way.
+- (NSArray *)itemsMatchingName:(NSString *)query inItems:(NSArray *)items {
+    [self indexNames];
+    NSMutableData *folded = [NSMutableData data];
+    NSData *utf8 = [query dataUsingEncoding:NSUTF8StringEncoding] ?: [NSData data];
+    QuoteFilterAppendFolded(folded, utf8.bytes, utf8.length, kQuoteFilterNameFolding);
+    const uint32_t *ranks = [_store stringRanksForField:QuoteFieldSymbolName caseInsensitive:YES];
+    QuoteNameMatch *matches;
+    size_t matchCount;
+    if (!QuoteNameIndexSearch(&_nameIndex, folded.bytes, folded.length, ranks, &matches, &matchCount)) {
+        [NSException raise:NSMallocException format:@"QuoteFilterEngine cannot search names for %@", query];
+    }
+    NSUInteger count = items.count;
+    if (matchCount == 0 || count == 0) {
+        free(matches);
+        return @[];
+    }
+
+    // places[code] is 1 + the name's place in the ranking, 0 for no match;
+    // starts[place] counts its items, then is where they go
+    uint32_t *places = calloc((size_t)_nameIndex.nameCount + 1, sizeof(uint32_t));
+    uint32_t *starts = calloc(matchCount + 1, sizeof(uint32_t));
+    uint32_t *itemPlaces = malloc(count * sizeof(uint32_t));
+    __unsafe_unretained id *objects = (__unsafe_unretained id *)malloc(2 * count * sizeof(id));
+    if (!places || !starts || !itemPlaces || !objects) {
+        free(matches);
+        free(places);
+        free(starts);
+        free(itemPlaces);
+        free(objects);
+        [NSException raise:NSMallocException format:@"QuoteFilterEngine cannot search %lu items", (unsigned long)count];
+    }
+    for (size_t i = 0; i < matchCount; i++) {
+        places[matches[i].name] = (uint32_t)i + 1;
+    }
+    free(matches);
+
+    [items getObjects:objects range:NSMakeRange(0, count)];
+    const uint32_t *names = [_store codeColumn:QuoteFieldSymbolName];
+    for (NSUInteger i = 0; i < count; i++) {
+        QuoteItem *item = objects[i];
+        if (item.store != _store) {
+            free(places);
+            free(starts);
+            free(itemPlaces);
+            free(objects);
+            [NSException raise:NSInvalidArgumentException format:@"%@ is not a row of the searched store", item];
+        }
+        itemPlaces[i] = places[names[item.row]];
+        starts[itemPlaces[i]]++;
+    }
+    NSUInteger foundCount = count - starts[0];
+    uint32_t next = 0;
+    for (size_t place = 1; place <= matchCount; place++) {
+        uint32_t placeCount = starts[place];
+        starts[place] = next;
+        next += placeCount;
+    }
+    __unsafe_unretained id *found = objects + count;
+    for (NSUInteger i = 0; i < count; i++) {
+        if (itemPlaces[i]) {
+            found[starts[itemPlaces[i]]++] = objects[i];
+        }
+    }
+    NSArray *result = [NSArray arrayWithObjects:found count:foundCount];
+    free(places);
+    free(starts);
+    free(itemPlaces);
+    free(objects);
+    return result;
+}
+
+#pragma mark - Refinement
+
+- (NSArray *)refinedItems:(NSArray *)items usingPredicate:(QuoteFilterPredicate *)predicate {
+    QuoteFilterRefinement *query = [[QuoteFilterRefinement alloc] init];
+    query.field = predicate.field;
+    query.condition = predicate.condition;
+    query.options = predicate.options;
+    query.value = predicate.foldedValue ?: [predicate.value dataUsingEncoding:NSUTF8StringEncoding];
+    QuoteFilterRefinement *refined = [self refinementOfItems:items refinedBy:query];
+    if ([refined.value isEqualToData:query.value]) {
+        return refined.result;
+    }
+    query.result = [self filteredItems:refined ? refined.result : items usingPredicate:predicate];
+    [self pushRefinement:query];
+    return query.result;
+}
+
+- (NSArray *)refinedItemsMatchingName:(NSString *)query inItems:(NSArray *)items {
+    QuoteFilterRefinement *search = [[QuoteFilterRefinement alloc] init];
+    search.field = QuoteFieldSymbolName;
+    search.options = kQuoteFilterNameFolding;
+    search.byName = YES;
+    NSData *utf8 = [query dataUsingEncoding:NSUTF8StringEncoding] ?: [NSData data];
+    NSMutableData *folded = [NSMutableData data];
+    QuoteFilterAppendFolded(folded, utf8.bytes, utf8.length, kQuoteFilterNameFolding);
+    search.value = folded;
+    QuoteFilterRefinement *refined = [self refinementOfItems:items refinedBy:search];
+    if ([refined.value isEqualToData:search.value]) {
+        return refined.result;
+    }
+    // the ranking is the names'; items of one name keep their order in any
+    // result, so a narrower search of a result ranks as one of the items
+    search.result = [self itemsMatchingName:query inItems:refined ? refined.result : items];
+    [self pushRefinement:search];
+    return search.result;
+}
+
+- (void)forgetRefinements {
+    [_refinements removeAllObjects];
+    _refinedItems = nil;
+}
+
+// Pops the results query does not refine and returns the one left on top,
+// if any. The stack is cleared for other items, another filter, or once the
+// field has changed.
+- (QuoteFilterRefinement *)refinementOfItems:(NSArray *)items refinedBy:(QuoteFilterRefinement *)query {
+    uint64_t version = [_store versionOfFields:QuoteFieldMaskOf(query.field)];
+    // the store's own items arrays of one length are the same items
+    BOOL sameItems = items == _refinedItems
+        || (items.count == _refinedItems.count && [_store isItemArray:items] && [_store isItemArray:_refinedItems]);
+    if (!sameItems || version != _refinedVersion || ![_refinements.firstObject isSameFilterAs:query]) {
+        [self forgetRefinements];
+        _refinedItems = items;
+        _refinedVersion = version;
+        return nil;
+    }
+    while (_refinements.count && ![_refinements.lastObject isRefinedBy:query]) {
+        [_refinements removeLastObject];
+    }
+    return _refinements.lastObject;
+}
+
+- (void)pushRefinement:(QuoteFilterRefinement *)refinement {
+    if (_refinements.count == kQuoteFilterRefinementDepth) {
+        [_refinements removeObjectAtIndex:0];
+    }
+    [_refinements addObject:refinement];
+}
+
+#pragma mark - Strings
+
+// Decides the condition for every code interned since it was last used.
+- (void)decideCodesOfPredicate:(QuoteFilterPredicate *)predicate {
+    QuoteField field = predicate.field;
+    QuoteStringTable *table = [_store stringTableForField:field];
+    uint32_t count = QuoteStringTableCount(table);
+    NSMutableData *matchesByCode = predicate.matchesByCode;
+    uint32_t decided = (uint32_t)matchesByCode.length - 1;
+    if (decided == count) {
+        return;
+    }
+    matchesByCode.length = (NSUInteger)count + 1;
+    uint8_t *matches = matchesByCode.mutableBytes;
+
+    if (predicate.stringPredicate) {
+        for (uint32_t code = decided + 1; code <= count; code++) {
+            @autoreleasepool {
+                matches[code] = [predicate.stringPredicate evaluateWithObject:[_store stringForCode:code field:field]];
+            }
+        }
+        return;
+    }
+
+    QuoteFilterFoldedStrings *folded = predicate.options ? [self foldedStringsForField:field options:predicate.options] : nil;
+    const char *heap = folded.heap.bytes;
+    const uint32_t *offsets = folded.offsets.bytes;
+    const char *needle = predicate.foldedValue.bytes;
+    size_t needleLength = predicate.foldedValue.length;
+    for (uint32_t code = decided + 1; code <= count; code++) {
+        const char *bytes;
+        size_t length;
+        if (folded) {
+            bytes = heap + offsets[code - 1];
+            length = offsets[code] - offsets[code - 1];
+        } else {
+            bytes = QuoteStringTableBytes(table, code, &length);
+        }
+        BOOL match = NO;
+        // an empty value is in no string, as with rangeOfString:
+        if (needleLength && needleLength <= length) {
+            switch (predicate.condition) {
+                case QuoteFilterConditionContains:
+                    match = memmem(bytes, length, needle, needleLength) != NULL;
+                    break;
+                case QuoteFilterConditionBeginsWith:
+                    match = memcmp(bytes, needle, needleLength) == 0;
+                    break;
+                case QuoteFilterConditionEndsWith:
+                    match = memcmp(bytes + length - needleLength, needle, needleLength) == 0;
+                    break;
+                default:
+                    break;
+            }
+        }
+        matches[code] = match;
+    }
+}
+
+// The field's strings folded by options, folding any interned since the
+// last call.
+- (QuoteFilterFoldedStrings *)foldedStringsForField:(QuoteField)field options:(QuoteFilterOptions)options {
+    QuoteField owner = QuoteFieldStringTableOwner(field);
+    NSNumber *key = @(owner << 2 | options);
+    QuoteFilterFoldedStrings *folded = _foldedStrings[key];
+    if (!folded) {
+        folded = [[QuoteFilterFoldedStrings alloc] init];
+        _foldedStrings[key] = folded;
+    }
+    QuoteStringTable *table = [_store stringTableForField:owner];
+    uint32_t count = QuoteStringTableCount(table);
+    for (uint32_t code = folded.count + 1; code <= count; code++) {
+        size_t length;
+        const char *bytes = QuoteStringTableBytes(table, code, &length);
+        QuoteFilterAppendFolded(folded.heap, bytes, length, options);
+        uint32_t end = (uint32_t)folded.heap.length;
+        [folded.offsets appendBytes:&end length:sizeof(end)];
+    }
+    return folded;
+}
+
+@end
@@ -1,9 +1,22 @@
 
 
 #import <Foundation/Foundation.h>
+#import "QuoteSchema.h"
 
+@class QuoteStore;
+
+/// One row of a QuoteStore. The properties read and write the store's
+/// columns; the item itself holds nothing but the store and the row id.
 @interface QuoteItem : NSObject
 
+@property (nonatomic, readonly) QuoteStore *store;
+@property (nonatomic, readonly) NSUInteger row;
+
+- (instancetype)initWithStore:(QuoteStore *)store row:(NSUInteger)row NS_DESIGNATED_INITIALIZER;
+
+/// A row of a new single-row store, for quotes built up one at a time.
+- (instancetype)init;
+
 @property (nonatomic, strong)  NSString *assetType;
 @property (nonatomic, strong)  NSString *symbol;
 @property (nonatomic, strong)  NSString *symbolName;
@@ -28,7 +41,14 @@
 @property (nonatomic, strong)  NSNumber *bidSize;
 @property (nonatomic, strong)  NSNumber *FiftyDayMovingAverage;
 @property (nonatomic, strong)  NSNumber *earningsShare;
-@property (nonatomic, strong)  NSString *symbolSortAscending;
-@property (nonatomic, strong)  NSString *symbolSortDescending;
+/// The store's cached sort strings for the symbol column.
+@property (nonatomic, readonly) NSString *symbolSortAscending;
+@property (nonatomic, readonly) NSString *symbolSortDescending;
+
+/// The asset type, symbol and underlying as the integers the store keeps:
+/// equal tickers have equal ids across both symbol columns, 0 when missing.
+@property (nonatomic, readonly) QuoteAssetType quoteAssetType;
+@property (nonatomic, readonly) uint32_t symbolId;
+@property (nonatomic, readonly) uint32_t underlyingSymbolId;
 
 @end
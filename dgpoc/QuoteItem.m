@@ -1,47 +1,70 @@
 
 #import "QuoteItem.h"
+#import "QuoteStore.h"
 
-@implementation QuoteItem
+#define QUOTE_ITEM_PROPERTY(type, getter, Setter, field) \
+    - (type *)getter { return [_store valueForField:field row:_row]; } \
+    - (void)set##Setter:(type *)value { [_store setValue:value forField:field row:_row]; }
 
+@implementation QuoteItem
 
-- (NSString *)symbolSortAscending {
-    if([_assetType isEqualToString:@"E"]) {
-        return [NSString stringWithFormat:@"%@_0", _symbol];
-    } else if([_assetType isEqualToString:@"O"]) {
-        return [self createOptionSortKey];
+- (instancetype)initWithStore:(QuoteStore *)store row:(NSUInteger)row {
+    self = [super init];
+    if (self) {
+        _store = store;
+        _row = row;
     }
-    return _symbol;
+    return self;
 }
 
-- (NSString *)symbolSortDescending {
-    if([_assetType isEqualToString:@"E"]) {
-        return [NSString stringWithFormat:@"%@_9", _symbol];
-    } else if([_assetType isEqualToString:@"O"]) {
-        return [self createOptionSortKey];
-    }
-    return _symbol;
+- (instancetype)init {
+    QuoteStore *store = [[QuoteStore alloc] init];
+    return [self initWithStore:store row:[store appendRows:1]];
+}
+
+QUOTE_ITEM_PROPERTY(NSString, assetType, AssetType, QuoteFieldAssetType)
+QUOTE_ITEM_PROPERTY(NSString, symbol, Symbol, QuoteFieldSymbol)
+QUOTE_ITEM_PROPERTY(NSString, symbolName, SymbolName, QuoteFieldSymbolName)
+QUOTE_ITEM_PROPERTY(NSString, underlyingSymbol, UnderlyingSymbol, QuoteFieldUnderlyingSymbol)
+QUOTE_ITEM_PROPERTY(NSNumber, lastTrade, LastTrade, QuoteFieldLastTrade)
+QUOTE_ITEM_PROPERTY(NSString, lastTradeDate, LastTradeDate, QuoteFieldLastTradeDate)
+QUOTE_ITEM_PROPERTY(NSString, lastTradeTime, LastTradeTime, QuoteFieldLastTradeTime)
+QUOTE_ITEM_PROPERTY(NSNumber, changePercentChange, ChangePercentChange, QuoteFieldChangePercentChange)
+QUOTE_ITEM_PROPERTY(NSNumber, change, Change, QuoteFieldChange)
+QUOTE_ITEM_PROPERTY(NSNumber, open, Open, QuoteFieldOpen)
+QUOTE_ITEM_PROPERTY(NSNumber, daysHigh, DaysHigh, QuoteFieldDaysHigh)
+QUOTE_ITEM_PROPERTY(NSNumber, daysLow, DaysLow, QuoteFieldDaysLow)
+QUOTE_ITEM_PROPERTY(NSNumber, volume, Volume, QuoteFieldVolume)
+QUOTE_ITEM_PROPERTY(NSNumber, ask, Ask, QuoteFieldAsk)
+QUOTE_ITEM_PROPERTY(NSNumber, averageDailyVolume, AverageDailyVolume, QuoteFieldAverageDailyVolume)
+QUOTE_ITEM_PROPERTY(NSNumber, askSize, AskSize, QuoteFieldAskSize)
+QUOTE_ITEM_PROPERTY(NSNumber, FiftyTwoWeekHigh, FiftyTwoWeekHigh, QuoteFieldFiftyTwoWeekHigh)
+QUOTE_ITEM_PROPERTY(NSNumber, changeFrom52weekHigh, ChangeFrom52weekHigh, QuoteFieldChangeFrom52weekHigh)
+QUOTE_ITEM_PROPERTY(NSNumber, percentChangeFrom52weeklow, PercentChangeFrom52weeklow, QuoteFieldPercentChangeFrom52weeklow)
+QUOTE_ITEM_PROPERTY(NSString, FiftyTwoWeekRange, FiftyTwoWeekRange, QuoteFieldFiftyTwoWeekRange)
+QUOTE_ITEM_PROPERTY(NSNumber, bid, Bid, QuoteFieldBid)
+QUOTE_ITEM_PROPERTY(NSNumber, bidSize, BidSize, QuoteFieldBidSize)
+QUOTE_ITEM_PROPERTY(NSNumber, FiftyDayMovingAverage, FiftyDayMovingAverage, QuoteFieldFiftyDayMovingAverage)
+QUOTE_ITEM_PROPERTY(NSNumber, earningsShare, EarningsShare, QuoteFieldEarningsShare)
+
+- (QuoteAssetType)quoteAssetType {
+    return [_store assetTypeForRow:_row];
 }
 
-- (NSString *)createOptionSortKey {
-    NSRange offset = [_symbol rangeOfString:@"_"];
-    offset.location++;
-    offset.length = 2;
-    NSString* month = [_symbol substringWithRange:offset];
-    offset.location += offset.length;
-    
-    NSString* day = [_symbol substringWithRange:offset];
-    offset.location += offset.length;
-    
-    NSString* year = [_symbol substringWithRange:offset];
-    offset.location += offset.length;
-
-    offset.length = 1;
-    NSString* type = [_symbol substringWithRange:offset];
-    offset.location += offset.length;
-
-    offset.length = _symbol.length - offset.location;
-    NSString* strike = [_symbol substringWithRange:offset];
-    return [NSString stringWithFormat:@"%@_%@_%@_%@_%@_%@", _underlyingSymbol, year, month, day, strike, type];
+- (uint32_t)symbolId {
+    return [_store codeColumn:QuoteFieldSymbol][_row];
+}
+
+- (uint32_t)underlyingSymbolId {
+    return [_store codeColumn:QuoteFieldUnderlyingSymbol][_row];
+}
+
+- (NSString *)symbolSortAscending {
+    return [_store symbolSortStringForRow:_row ascending:YES];
+}
+
+- (NSString *)symbolSortDescending {
+    return [_store symbolSortStringForRow:_row ascending:NO];
 }
 
 // symbol
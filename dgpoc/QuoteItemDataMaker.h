@@ -1,8 +1,40 @@
-
 #import <Foundation/Foundation.h>
+#import "QuoteSchema.h"
+#import "QuoteStore.h"
+
+/// A quote store with only some fields decoded. The mapped source stays
+/// around so other fields can be backfilled when they are first needed.
+@interface QuoteItemProjection : NSObject
+
+@property (nonatomic, readonly) QuoteStore *store;
+/// QuoteItem views over the store's rows.
+@property (nonatomic, readonly) NSArray *items;
+@property (nonatomic, readonly) QuoteFieldMask decodedFields;
+
+/// Decodes whichever of fields have not been decoded yet into the store.
+- (void)decodeFields:(QuoteFieldMask)fields;
+
+@end
 
 @interface QuoteItemDataMaker : NSObject
 
+/// Served from a binary snapshot in Caches when one exists for the bundled
+/// quotes.csv; otherwise parses the CSV and writes the snapshot for next time.
 + (NSArray *)quoteItemsFromCannedData;
 
+/// Like quoteItemsFromCannedData, but when the CSV has to be parsed only
+/// fields (plus QuoteFieldMaskIdentity) are decoded up front.
++ (QuoteItemProjection *)cannedQuoteItemsWithFields:(QuoteFieldMask)fields;
+
+/// Memory-maps the file and decodes rows straight out of the mapped bytes.
+/// Files of a few MB and up are decoded on every active core.
++ (NSArray *)quoteItemsFromCSVAtURL:(NSURL *)url;
+
+/// Splits the rows into `concurrency` chunks and decodes them in parallel.
+/// Items come back in file order regardless of concurrency.
++ (NSArray *)quoteItemsFromCSVAtURL:(NSURL *)url concurrency:(NSUInteger)concurrency;
+
++ (QuoteItemProjection *)projectionOfCSVAtURL:(NSURL *)url fields:(QuoteFieldMask)fields;
++ (QuoteItemProjection *)projectionOfCSVAtURL:(NSURL *)url fields:(QuoteFieldMask)fields concurrency:(NSUInteger)concurrency;
+
 @end
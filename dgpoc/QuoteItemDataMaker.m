@@ -1,53 +1,300 @@
 #import "QuoteItemDataMaker.h"
-#import "QuoteItem.h"
+#import "QuoteCSVScanner.h"
+#import "QuoteNumberParser.h"
+#import "QuoteSnapshot.h"
+
+static const unsigned long long kParallelLoadMinimumBytes = 4 * 1024 * 1024;
+
+static inline NSString *QuoteString(QuoteCSVField field) {
+    if (field.escaped) {
+        NSMutableData *buffer = [NSMutableData dataWithLength:field.length];
+        size_t length = QuoteCSVFieldUnescape(field, buffer.mutableBytes, field.length);
+        return [[NSString alloc] initWithBytes:buffer.bytes length:length encoding:NSUTF8StringEncoding];
+    }
+    return [[NSString alloc] initWithBytes:field.bytes length:field.length encoding:NSUTF8StringEncoding];
+}
+
+// Interns a field's text, collapsing "" pairs of quoted fields first.
+static inline uint32_t QuoteInternField(QuoteStringTable *table, QuoteCSVField field) {
+    if (!field.escaped) {
+        return QuoteStringTableIntern(table, field.bytes, field.length);
+    }
+    char stackBuffer[256];
+    char *buffer = field.length <= sizeof(stackBuffer) ? stackBuffer : malloc(field.length);
+    size_t length = QuoteCSVFieldUnescape(field, buffer, field.length);
+    uint32_t code = QuoteStringTableIntern(table, buffer, length);
+    if (buffer != stackBuffer) {
+        free(buffer);
+    }
+    return code;
+}
+
+// Header columns past this are never split out of a row.
+#define QUOTE_MAX_COLUMNS 256
+
+// Where each field sits in the file, read once from the header row.
+// QUOTE_MAX_COLUMNS marks a field the file does not have.
+typedef struct {
+    size_t columns[QuoteFieldCount];
+} QuoteColumnMap;
+
+typedef struct {
+    size_t column;
+    QuoteField field;
+    QuoteFieldType type;
+    unsigned decimals;
+} QuoteDecodeStep;
+
+// The per-row work for one set of fields, in column order. Columns outside
+// the schema, or not asked for, have no step and are never looked at.
+typedef struct {
+    size_t width;           // fields to split out of each row
+    size_t required;        // rows narrower than this lack an identity field
+    size_t stepCount;
+    QuoteDecodeStep steps[QuoteFieldCount];
+} QuoteDecodePlan;
+
+static QuoteColumnMap QuoteColumnMapFromHeader(const QuoteCSVField *header, size_t count) {
+    QuoteColumnMap map;
+    for (QuoteField field = 0; field < QuoteFieldCount; field++) {
+        map.columns[field] = QUOTE_MAX_COLUMNS;
+    }
+    for (size_t column = 0; column < MIN(count, (size_t)QUOTE_MAX_COLUMNS); column++) {
+        QuoteField field = QuoteFieldForHeader(QuoteString(header[column]));
+        if (field < QuoteFieldCount && map.columns[field] == QUOTE_MAX_COLUMNS) {
+            map.columns[field] = column;
+        }
+    }
+    return map;
+}
+
+static QuoteDecodePlan QuoteDecodePlanCompile(const QuoteColumnMap *map, QuoteFieldMask fields) {
+    QuoteDecodePlan plan = { 0 };
+    for (QuoteField field = 0; field < QuoteFieldCount; field++) {
+        size_t column = map->columns[field];
+        if (column == QUOTE_MAX_COLUMNS) {
+            continue;
+        }
+        // every plan over a file skips the same rows, so backfills line up
+        if (QuoteFieldMaskIdentity & QuoteFieldMaskOf(field)) {
+            plan.required = MAX(plan.required, column + 1);
+        }
+        if (!(fields & QuoteFieldMaskOf(field))) {
+            continue;
+        }
+        // insertion by column keeps each row's fields read front to back
+        size_t i = plan.stepCount++;
+        for (; i > 0 && plan.steps[i - 1].column > column; i--) {
+            plan.steps[i] = plan.steps[i - 1];
+        }
+        plan.steps[i] = (QuoteDecodeStep){ column, field, QuoteFieldTypeOf(field), QuoteFieldDecimals(field) };
+        plan.width = MAX(plan.width, column + 1);
+    }
+    return plan;
+}
+
+// Decodes the rows of one chunk into new rows of store, straight into its
+// columns.
+//
+// Rows too short to carry the identity fields are skipped; a row that only
+// stops short of later fields leaves them missing.
+static void QuoteStoreDecodeChunk(QuoteCSVScanner *scanner, const QuoteDecodePlan *plan, QuoteStore *store) {
+    QuoteCSVField c[QUOTE_MAX_COLUMNS];
+    const QuoteDecodeStep *steps = plan->steps;
+    const QuoteDecodeStep *end = steps + plan->stepCount;
+    QuoteStoreColumns columns = [store columns];
+    NSUInteger capacity = store.capacity;
+    size_t count;
+
+    while ((count = QuoteCSVScannerNextRow(scanner, c, plan->width))) {
+        if (count < plan->required) {
+            continue;
+        }
+
+        NSUInteger row = [store appendRows:1];
+        if (store.capacity != capacity) {
+            columns = [store columns];
+            capacity = store.capacity;
+        }
+        for (const QuoteDecodeStep *step = steps; step < end && step->column < count; step++) {
+            QuoteCSVField field = c[step->column];
+            switch (step->type) {
+                case QuoteFieldTypeDouble: {
+                    // a blank or "N/A" field stays missing rather than reading as 0
+                    double value;
+                    if (QuoteParseDouble(field.bytes, field.length, &value)) {
+                        columns.doubles[step->field][row] = value;
+                    }
+                    break;
+                }
+                case QuoteFieldTypeFixed: {
+                    int64_t value;
+                    if (QuoteParseFixed(field.bytes, field.length, step->decimals, &value)) {
+                        columns.fixed[step->field][row] = value;
+                    }
+                    break;
+                }
+                case QuoteFieldTypeString:
+                    columns.codes[step->field][row] = QuoteInternField(columns.tables[step->field], field);
+                    break;
+            }
+        }
+    }
+}
+
+// Decodes each chunk into a store of its own, all at once, one work item per
+// chunk so at most chunkCount threads decode together.
+static NSArray *QuoteStoresDecodeChunks(NSData *data, const size_t *boundaries, size_t chunkCount,
+                                        const QuoteDecodePlan *plan) {
+    NSMutableArray *stores = [NSMutableArray arrayWithCapacity:chunkCount];
+    for (size_t i = 0; i < chunkCount; i++) {
+        [stores addObject:[[QuoteStore alloc] init]];
+    }
+    QuoteDecodePlan chunkPlan = *plan;
+    dispatch_apply(chunkCount, dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_HIGH, 0), ^(size_t i) {
+        QuoteCSVScanner scanner;
+        QuoteCSVScannerInit(&scanner, (const char *)data.bytes + boundaries[i], boundaries[i + 1] - boundaries[i]);
+        QuoteStoreDecodeChunk(&scanner, &chunkPlan, stores[i]);
+    });
+    return stores;
+}
+
+@interface QuoteItemProjection ()
+
+@property (nonatomic, strong) QuoteStore *store;
+@property (nonatomic, assign) QuoteFieldMask decodedFields;
+@property (nonatomic, strong) NSData *data;
+@property (nonatomic, strong) NSData *boundaries;
+@property (nonatomic, strong) NSArray *chunkFirstRows;
+@property (nonatomic, assign) QuoteColumnMap columnMap;
+
+@end
+
+@implementation QuoteItemProjection {
+    NSArray *_items;
+}
+
+- (NSArray *)items {
+    if (!_items) {
+        _items = [self.store items];
+    }
+    return _items;
+}
+
+- (void)decodeFields:(QuoteFieldMask)fields {
+    QuoteFieldMask missing = fields & ~self.decodedFields;
+    if (!missing || !self.data) {
+        return;
+    }
+
+    QuoteColumnMap columnMap = self.columnMap;
+    QuoteDecodePlan plan = QuoteDecodePlanCompile(&columnMap, missing);
+    NSArray *chunkStores = QuoteStoresDecodeChunks(self.data, self.boundaries.bytes, self.chunkFirstRows.count, &plan);
+    [chunkStores enumerateObjectsUsingBlock:^(QuoteStore *chunkStore, NSUInteger i, BOOL *stop) {
+        [self.store copyFields:missing fromStore:chunkStore toRow:[self.chunkFirstRows[i] unsignedIntegerValue]];
+    }];
+    self.decodedFields |= missing;
+}
+
+@end
 
 @implementation QuoteItemDataMaker
 
 + (NSArray *)quoteItemsFromCannedData {
-    NSMutableArray *dataList = [[NSMutableArray alloc] init];
-    QuoteItem *q;
-    
+    return [self cannedQuoteItemsWithFields:QuoteFieldMaskAll].items;
+}
+
++ (QuoteItemProjection *)cannedQuoteItemsWithFields:(QuoteFieldMask)fields {
     NSURL *url = [[NSBundle mainBundle] URLForResource:@"quotes" withExtension:@"csv"];
+    NSURL *cachesURL = [[[NSFileManager defaultManager] URLsForDirectory:NSCachesDirectory inDomains:NSUserDomainMask] firstObject];
+    NSURL *snapshotURL = [cachesURL URLByAppendingPathComponent:@"quotes.qsnp"];
+    uint64_t sourceStamp = [QuoteSnapshot sourceStampForURL:url];
+
+    QuoteStore *snapshotStore = [[QuoteSnapshot snapshotWithContentsOfURL:snapshotURL sourceStamp:sourceStamp] quoteStore];
+    if (snapshotStore) {
+        QuoteItemProjection *projection = [[QuoteItemProjection alloc] init];
+        projection.store = snapshotStore;
+        projection.decodedFields = QuoteFieldMaskAll;
+        return projection;
+    }
+
+    QuoteItemProjection *projection = [self projectionOfCSVAtURL:url fields:fields];
+    if (projection.decodedFields == QuoteFieldMaskAll) {
+        [QuoteSnapshot writeQuoteStore:projection.store sourceStamp:sourceStamp toURL:snapshotURL];
+    } else {
+        // the snapshot needs every field; build it off the main thread for next launch
+        dispatch_async(dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_BACKGROUND, 0), ^{
+            QuoteStore *store = [self projectionOfCSVAtURL:url fields:QuoteFieldMaskAll].store;
+            [QuoteSnapshot writeQuoteStore:store sourceStamp:sourceStamp toURL:snapshotURL];
+        });
+    }
+    return projection;
+}
+
++ (NSArray *)quoteItemsFromCSVAtURL:(NSURL *)url {
+    return [self projectionOfCSVAtURL:url fields:QuoteFieldMaskAll].items;
+}
+
++ (NSArray *)quoteItemsFromCSVAtURL:(NSURL *)url concurrency:(NSUInteger)concurrency {
+    return [self projectionOfCSVAtURL:url fields:QuoteFieldMaskAll concurrency:concurrency].items;
+}
+
++ (QuoteItemProjection *)projectionOfCSVAtURL:(NSURL *)url fields:(QuoteFieldMask)fields {
+    NSDictionary *attributes = [[NSFileManager defaultManager] attributesOfItemAtPath:url.path error:NULL];
+    NSUInteger concurrency = 1;
+    if ([attributes fileSize] >= kParallelLoadMinimumBytes) {
+        concurrency = [NSProcessInfo processInfo].activeProcessorCount;
+    }
+    return [self projectionOfCSVAtURL:url fields:fields concurrency:concurrency];
+}
 
-    NSData *data = [NSData dataWithContentsOfURL:url];
-    NSString *fileContents = [NSString stringWithUTF8String:[data bytes]];
-    
-    NSMutableArray *rows = [[fileContents componentsSeparatedByString:@"\n"] mutableCopy];
-    [rows removeObjectAtIndex:0];
-    
-    for (NSString *row in rows) {
-        q = [[QuoteItem alloc] init];
-        int i = 0;
-
-        NSArray *c = [row componentsSeparatedByString:@","];
-        q.assetType = c[i++];
-        q.symbol = c[i++];
-        q.symbolName = c[i++];
-        q.underlyingSymbol = c[i++];
-        q.lastTrade = [NSNumber numberWithDouble:[c[i++] doubleValue]];
-        q.lastTradeDate = c[i++];
-        q.lastTradeTime = c[i++];
-        q.changePercentChange = [NSNumber numberWithDouble:[c[i++]  doubleValue]];
-        q.change = [NSNumber numberWithDouble:[c[i++] doubleValue]];
-        q.open = [NSNumber numberWithDouble:[c[i++] doubleValue]];
-        q.daysHigh = [NSNumber numberWithDouble:[c[i++] doubleValue]];
-        q.daysLow = [NSNumber numberWithDouble:[c[i++] doubleValue]];
-        q.volume = [NSNumber numberWithDouble:[c[i++] doubleValue]];
-        q.ask = [NSNumber numberWithDouble:[c[i++] doubleValue]];
-        q.averageDailyVolume = [NSNumber numberWithDouble:[c[i++] doubleValue]];
-        q.askSize = [NSNumber numberWithDouble:[c[i++] doubleValue]];
-        q.FiftyTwoWeekHigh = [NSNumber numberWithDouble:[c[i++] doubleValue]];
-        q.changeFrom52weekHigh = [NSNumber numberWithDouble:[c[i++] doubleValue]];
-        q.percentChangeFrom52weeklow = [NSNumber numberWithDouble:[c[i++] doubleValue]];
-        q.FiftyTwoWeekRange = c[i++];
-        q.bid = [NSNumber numberWithDouble:[c[i++] doubleValue]];
-        q.bidSize = [NSNumber numberWithDouble:[c[i++] doubleValue]];
-        q.FiftyDayMovingAverage = [NSNumber numberWithDouble:[c[i++] doubleValue]];
-        q.earningsShare = [NSNumber numberWithDouble:[c[i++] doubleValue]];
-        
-        [dataList addObject:q];
-    }
-    return dataList;
++ (QuoteItemProjection *)projectionOfCSVAtURL:(NSURL *)url fields:(QuoteFieldMask)fields concurrency:(NSUInteger)concurrency {
+    QuoteItemProjection *projection = [[QuoteItemProjection alloc] init];
+    fields |= QuoteFieldMaskIdentity;
+    concurrency = MAX(concurrency, 1u);
+
+    NSData *data = [NSData dataWithContentsOfURL:url options:NSDataReadingMappedAlways error:NULL];
+    if (!data) {
+        projection.store = [[QuoteStore alloc] init];
+        projection.decodedFields = QuoteFieldMaskAll;
+        return projection;
+    }
+
+    QuoteCSVScanner scanner;
+    QuoteCSVScannerInit(&scanner, data.bytes, data.length);
+    QuoteCSVField header[QUOTE_MAX_COLUMNS];
+    size_t headerCount = QuoteCSVScannerNextRow(&scanner, header, QUOTE_MAX_COLUMNS);
+    QuoteColumnMap columnMap = QuoteColumnMapFromHeader(header, headerCount);
+    QuoteDecodePlan plan = QuoteDecodePlanCompile(&columnMap, fields);
+
+    NSMutableData *boundaryData = [NSMutableData dataWithLength:(concurrency + 1) * sizeof(size_t)];
+    size_t *boundaries = boundaryData.mutableBytes;
+    QuoteCSVSplitRows(data.bytes, data.length, scanner.rowStart, concurrency, boundaries);
+
+    NSArray *chunkStores = QuoteStoresDecodeChunks(data, boundaries, concurrency, &plan);
+    QuoteStore *store = chunkStores.firstObject;
+    NSMutableArray *chunkFirstRows = [NSMutableArray arrayWithObject:@0];
+    if (concurrency > 1) {
+        store = [[QuoteStore alloc] init];
+        [store reserveCapacity:[[chunkStores valueForKeyPath:@"@sum.rowCount"] unsignedIntegerValue]];
+        for (QuoteStore *chunkStore in chunkStores) {
+            [store appendStore:chunkStore];
+            [chunkFirstRows addObject:@(store.rowCount)];
+        }
+        [chunkFirstRows removeLastObject];
+    }
+
+    // option symbols are parsed here, once each, not per sort key
+    [store optionContracts];
+    projection.store = store;
+    projection.decodedFields = fields;
+    if (fields != QuoteFieldMaskAll) {
+        projection.data = data;
+        projection.boundaries = boundaryData;
+        projection.chunkFirstRows = chunkFirstRows;
+        projection.columnMap = columnMap;
+    }
+    return projection;
 }
 
 @end
@@ -0,0 +1,361 @@
+#include "QuoteKeySort.h"
+
+#include <dispatch/dispatch.h>
+#include <stdlib.h>
+
+// Runs this short are insertion sorted before merging.
+#define QUOTE_SORT_RUN 16
+
+// The parallel sort cuts the input into at most this many slices.
+#define QUOTE_SORT_SLICE_MAXIMUM 64
+
+// Selection over more than eight samples' worth of keys picks its pivot
+// from this many, this many places past nth's share of them.
+#define QUOTE_SORT_SAMPLE 256
+#define QUOTE_SORT_SAMPLE_MARGIN 8
+
+#define QUOTE_SORT_MIN(a, b) ((a) < (b) ? (a) : (b))
+
+static void QuoteSortEntriesInsertion(QuoteSortEntry *entries, size_t count) {
+    for (size_t i = 1; i < count; i++) {
+        QuoteSortEntry entry = entries[i];
+        size_t j = i;
+        while (j > 0 && QuoteSortEntryLess(&entry, &entries[j - 1])) {
+            entries[j] = entries[j - 1];
+            j--;
+        }
+        entries[j] = entry;
+    }
+}
+
+// Bottom-up. Neighbouring runs already in order are copied rather than
+// merged, so re-sorting sorted rows is one compare per run.
+void QuoteSortEntriesMerge(QuoteSortEntry *entries, QuoteSortEntry *scratch, size_t count) {
+    for (size_t start = 0; start < count; start += QUOTE_SORT_RUN) {
+        QuoteSortEntriesInsertion(entries + start, QUOTE_SORT_MIN(QUOTE_SORT_RUN, count - start));
+    }
+    QuoteSortEntry *from = entries, *to = scratch;
+    for (size_t width = QUOTE_SORT_RUN; width < count; width *= 2) {
+        for (size_t left = 0; left < count; left += 2 * width) {
+            size_t middle = QUOTE_SORT_MIN(left + width, count);
+            size_t right = QUOTE_SORT_MIN(left + 2 * width, count);
+            if (middle == right || !QuoteSortEntryLess(&from[middle], &from[middle - 1])) {
+                memcpy(to + left, from + left, (right - left) * sizeof(QuoteSortEntry));
+                continue;
+            }
+            size_t i = left, j = middle, k = left;
+            while (i < middle && j < right) {
+                to[k++] = QuoteSortEntryLess(&from[j], &from[i]) ? from[j++] : from[i++];
+            }
+            memcpy(to + k, from + i, (middle - i) * sizeof(QuoteSortEntry));
+            k += middle - i;
+            memcpy(to + k, from + j, (right - j) * sizeof(QuoteSortEntry));
+        }
+        QuoteSortEntry *swap = from;
+        from = to;
+        to = swap;
+    }
+    if (from != entries) {
+        memcpy(entries, from, count * sizeof(QuoteSortEntry));
+    }
+}
+
+// Byte digit of an entry's key, 0 the lowest byte of lo, 8 the lowest of hi.
+static inline unsigned QuoteSortEntryDigit(const QuoteSortEntry *entry, unsigned digit) {
+    uint64_t word = digit < 8 ? entry->lo : entry->hi;
+    return (unsigned)(word >> (8 * (digit & 7))) & 0xFF;
+}
+
+// One counting pass fills every digit's histogram; a digit where all keys
+// share a byte is skipped, and keys already in order are left as they are.
+void QuoteSortEntriesRadix(QuoteSortEntry *entries, QuoteSortEntry *scratch, size_t count, size_t keyBytes) {
+    if (count < 2) {
+        return;
+    }
+    unsigned firstDigit = keyBytes > 8 ? 0 : 8;
+    uint32_t counts[16][256];
+    memset(counts[firstDigit], 0, (16 - firstDigit) * sizeof(counts[0]));
+
+    bool sorted = true;
+    for (size_t i = 0; i < count; i++) {
+        const QuoteSortEntry *entry = &entries[i];
+        uint64_t hi = entry->hi;
+        for (unsigned b = 0; b < 8; b++) {
+            counts[8 + b][(hi >> (8 * b)) & 0xFF]++;
+        }
+        if (firstDigit == 0) {
+            uint64_t lo = entry->lo;
+            for (unsigned b = 0; b < 8; b++) {
+                counts[b][(lo >> (8 * b)) & 0xFF]++;
+            }
+        }
+        sorted = sorted && (i == 0 || !QuoteSortEntryLess(entry, entry - 1));
+    }
+    if (sorted) {
+        return;
+    }
+
+    QuoteSortEntry *from = entries, *to = scratch;
+    for (unsigned digit = firstDigit; digit < 16; digit++) {
+        uint32_t *offsets = counts[digit];
+        if (offsets[QuoteSortEntryDigit(&from[0], digit)] == count) {
+            continue;
+        }
+        uint32_t total = 0;
+        for (unsigned byte = 0; byte < 256; byte++) {
+            uint32_t bucket = offsets[byte];
+            offsets[byte] = total;
+            total += bucket;
+        }
+        for (size_t i = 0; i < count; i++) {
+            to[offsets[QuoteSortEntryDigit(&from[i], digit)]++] = from[i];
+        }
+        QuoteSortEntry *swap = from;
+        from = to;
+        to = swap;
+    }
+    if (from != entries) {
+        memcpy(entries, from, count * sizeof(QuoteSortEntry));
+    }
+}
+
+static void QuoteSortEntriesSerial(QuoteSortEntry *entries, QuoteSortEntry *scratch, size_t count, size_t keyBytes) {
+    if (count >= QUOTE_SORT_RADIX_MINIMUM) {
+        QuoteSortEntriesRadix(entries, scratch, count, keyBytes);
+    } else {
+        QuoteSortEntriesMerge(entries, scratch, count);
+    }
+}
+
+// Slice s of the input is [sliceStarts[s], sliceStarts[s + 1]). Once the
+// slices are sorted, bucket b of slice s is [bounds[s][b], bounds[s][b + 1]):
+// its keys from splitter b - 1 up to but not including splitter b, so every
+// copy of a key lands in one bucket. Bucket b of the output starts at
+// offsets[b] and is the merge of bucket b of every slice.
+typedef struct {
+    QuoteSortEntry *entries;
+    QuoteSortEntry *scratch;
+    size_t keyBytes;
+    size_t sliceCount;
+    size_t *sliceStarts;        // sliceCount + 1
+    size_t *bounds;             // sliceCount rows of sliceCount + 1
+    size_t *offsets;            // sliceCount + 1
+} QuoteParallelSort;
+
+static void QuoteParallelSortSlice(void *context, size_t slice) {
+    const QuoteParallelSort *sort = context;
+    size_t start = sort->sliceStarts[slice];
+    QuoteSortEntriesSerial(sort->entries + start, sort->scratch + start, sort->sliceStarts[slice + 1] - start,
+                           sort->keyBytes);
+}
+
+// The first entry of [begin, end) whose key is not less than key's.
+static size_t QuoteSortLowerBound(const QuoteSortEntry *entries, size_t begin, size_t end, const QuoteSortEntry *key) {
+    while (begin < end) {
+        size_t middle = begin + (end - begin) / 2;
+        if (QuoteSortEntryLess(&entries[middle], key)) {
+            begin = middle + 1;
+        } else {
+            end = middle;
+        }
+    }
+    return begin;
+}
+
+// Merges bucket b of every slice into the scratch. On equal keys the
+// lowest slice goes first, which keeps input order.
+static void QuoteParallelSortMergeBucket(void *context, size_t bucket) {
+    const QuoteParallelSort *sort = context;
+    size_t sliceCount = sort->sliceCount;
+    size_t heads[QUOTE_SORT_SLICE_MAXIMUM], ends[QUOTE_SORT_SLICE_MAXIMUM];
+    size_t active = 0;
+    for (size_t slice = 0; slice < sliceCount; slice++) {
+        const size_t *bounds = sort->bounds + slice * (sliceCount + 1);
+        if (bounds[bucket] < bounds[bucket + 1]) {
+            heads[active] = bounds[bucket];
+            ends[active++] = bounds[bucket + 1];
+        }
+    }
+
+    const QuoteSortEntry *entries = sort->entries;
+    QuoteSortEntry *out = sort->scratch + sort->offsets[bucket];
+    while (active > 1) {
+        size_t best = 0;
+        for (size_t i = 1; i < active; i++) {
+            if (QuoteSortEntryLess(&entries[heads[i]], &entries[heads[best]])) {
+                best = i;
+            }
+        }
+        *out++ = entries[heads[best]++];
+        if (heads[best] == ends[best]) {
+            // keep the remaining slices in slice order
+            memmove(heads + best, heads + best + 1, (active - best - 1) * sizeof(size_t));
+            memmove(ends + best, ends + best + 1, (active - best - 1) * sizeof(size_t));
+            active--;
+        }
+    }
+    if (active == 1) {
+        memcpy(out, entries + heads[0], (ends[0] - heads[0]) * sizeof(QuoteSortEntry));
+    }
+}
+
+static void QuoteParallelSortCopyBucket(void *context, size_t bucket) {
+    const QuoteParallelSort *sort = context;
+    size_t start = sort->offsets[bucket];
+    memcpy(sort->entries + start, sort->scratch + start, (sort->offsets[bucket + 1] - start) * sizeof(QuoteSortEntry));
+}
+
+// Splitters are every sliceCount-th of sliceCount evenly spaced samples
+// from each sorted slice, so buckets come out about even unless one key
+// covers much of the input.
+static void QuoteParallelSortSplit(QuoteParallelSort *sort, QuoteSortEntry *samples) {
+    size_t sliceCount = sort->sliceCount;
+    size_t sampleCount = 0;
+    for (size_t slice = 0; slice < sliceCount; slice++) {
+        size_t start = sort->sliceStarts[slice];
+        size_t length = sort->sliceStarts[slice + 1] - start;
+        for (size_t i = 0; i < sliceCount; i++) {
+            samples[sampleCount++] = sort->entries[start + length * i / sliceCount];
+        }
+    }
+    QuoteSortEntriesMerge(samples, samples + sampleCount, sampleCount);
+
+    for (size_t slice = 0; slice < sliceCount; slice++) {
+        size_t *bounds = sort->bounds + slice * (sliceCount + 1);
+        bounds[0] = sort->sliceStarts[slice];
+        bounds[sliceCount] = sort->sliceStarts[slice + 1];
+        for (size_t bucket = 1; bucket < sliceCount; bucket++) {
+            bounds[bucket] = QuoteSortLowerBound(sort->entries, bounds[bucket - 1], bounds[sliceCount],
+                                                 &samples[bucket * sliceCount]);
+        }
+    }
+    size_t offset = 0;
+    for (size_t bucket = 0; bucket < sliceCount; bucket++) {
+        sort->offsets[bucket] = offset;
+        for (size_t slice = 0; slice < sliceCount; slice++) {
+            const size_t *bounds = sort->bounds + slice * (sliceCount + 1);
+            offset += bounds[bucket + 1] - bounds[bucket];
+        }
+    }
+    sort->offsets[sliceCount] = offset;
+}
+
+void QuoteSortEntriesParallel(QuoteSortEntry *entries, QuoteSortEntry *scratch, size_t count, size_t keyBytes,
+                              size_t workerCount) {
+    size_t sliceCount = QUOTE_SORT_MIN(QUOTE_SORT_MIN(workerCount, QUOTE_SORT_SLICE_MAXIMUM), count / QUOTE_SORT_RUN);
+    if (sliceCount < 2) {
+        QuoteSortEntriesSerial(entries, scratch, count, keyBytes);
+        return;
+    }
+    QuoteParallelSort sort = { entries, scratch, keyBytes, sliceCount, NULL, NULL, NULL };
+    sort.sliceStarts = malloc((sliceCount + 1) * sizeof(size_t));
+    sort.bounds = malloc(sliceCount * (sliceCount + 1) * sizeof(size_t));
+    sort.offsets = malloc((sliceCount + 1) * sizeof(size_t));
+    QuoteSortEntry *samples = malloc(2 * sliceCount * sliceCount * sizeof(QuoteSortEntry));
+    if (!sort.sliceStarts || !sort.bounds || !sort.offsets || !samples) {
+        QuoteSortEntriesSerial(entries, scratch, count, keyBytes);
+    } else {
+        for (size_t slice = 0; slice <= sliceCount; slice++) {
+            sort.sliceStarts[slice] = (size_t)((uint64_t)count * slice / sliceCount);
+        }
+        dispatch_queue_t queue = dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_HIGH, 0);
+        dispatch_apply_f(sliceCount, queue, &sort, QuoteParallelSortSlice);
+        QuoteParallelSortSplit(&sort, samples);
+        dispatch_apply_f(sliceCount, queue, &sort, QuoteParallelSortMergeBucket);
+        dispatch_apply_f(sliceCount, queue, &sort, QuoteParallelSortCopyBucket);
+    }
+    free(sort.sliceStarts);
+    free(sort.bounds);
+    free(sort.offsets);
+    free(samples);
+}
+
+static inline void QuoteSortEntriesSwap(QuoteSortEntry *a, QuoteSortEntry *b) {
+    QuoteSortEntry entry = *a;
+    *a = *b;
+    *b = entry;
+}
+
+// The median of the first, middle and last keys, so sorted and reversed
+// input select in linear time.
+static QuoteSortEntry QuoteSortEntriesPivot(const QuoteSortEntry *entries, size_t count) {
+    const QuoteSortEntry *a = &entries[0], *b = &entries[count / 2], *c = &entries[count - 1];
+    if (QuoteSortEntryLess(b, a)) {
+        const QuoteSortEntry *swap = a;
+        a = b;
+        b = swap;
+    }
+    if (QuoteSortEntryLess(c, b)) {
+        b = QuoteSortEntryLess(c, a) ? a : c;
+    }
+    return *b;
+}
+
+// A pivot a little past rank nth of [0, count), read off a sorted sample of
+// the keys, so that most keys fall on its far side.
+static QuoteSortEntry QuoteSortEntriesSamplePivot(const QuoteSortEntry *entries, size_t count, size_t nth,
+                                                  QuoteSortEntry *sample) {
+    for (size_t i = 0; i < QUOTE_SORT_SAMPLE; i++) {
+        sample[i] = entries[(uint64_t)count * i / QUOTE_SORT_SAMPLE];
+    }
+    QuoteSortEntriesMerge(sample, sample + QUOTE_SORT_SAMPLE, QUOTE_SORT_SAMPLE);
+    size_t rank = (size_t)((uint64_t)nth * QUOTE_SORT_SAMPLE / count) + QUOTE_SORT_SAMPLE_MARGIN;
+    return sample[QUOTE_SORT_MIN(rank, QUOTE_SORT_SAMPLE - 1)];
+}
+
+void QuoteSortEntriesSelect(QuoteSortEntry *entries, size_t count, size_t nth, size_t *equalStart, size_t *equalEnd) {
+    QuoteSortEntry sample[2 * QUOTE_SORT_SAMPLE];
+    size_t begin = 0, end = count;
+    for (;;) {
+        if (end - begin > 8 * QUOTE_SORT_SAMPLE) {
+            // keys up to the pivot to the front; the rest are never moved,
+            // which is nearly all of them when nth is near either end
+            QuoteSortEntry pivot = QuoteSortEntriesSamplePivot(entries + begin, end - begin, nth - begin, sample);
+            size_t split = begin;
+            for (size_t i = begin; i < end; i++) {
+                if (!QuoteSortEntryLess(&pivot, &entries[i])) {
+                    QuoteSortEntriesSwap(&entries[split++], &entries[i]);
+                }
+            }
+            if (nth < split && split < end) {
+                end = split;
+                continue;
+            }
+            if (nth >= split) {
+                begin = split;
+                continue;
+            }
+        }
+
+        // three-way partition of [begin, end): less, equal, greater
+        QuoteSortEntry pivot = QuoteSortEntriesPivot(entries + begin, end - begin);
+        size_t less = begin, i = begin, greater = end;
+        while (i < greater) {
+            if (QuoteSortEntryLess(&entries[i], &pivot)) {
+                QuoteSortEntriesSwap(&entries[less++], &entries[i++]);
+            } else if (QuoteSortEntryLess(&pivot, &entries[i])) {
+                QuoteSortEntriesSwap(&entries[i], &entries[--greater]);
+            } else {
+                i++;
+            }
+        }
+        if (nth < less) {
+            end = less;
+        } else if (nth >= greater) {
+            begin = greater;
+        } else {
+            *equalStart = less;
+            *equalEnd = greater;
+            return;
+        }
+    }
+}
+
+void QuoteSortEntries(QuoteSortEntry *entries, QuoteSortEntry *scratch, size_t count, size_t keyBytes,
+                      size_t workerCount) {
+    if (workerCount > 1 && count >= QUOTE_SORT_PARALLEL_MINIMUM) {
+        QuoteSortEntriesParallel(entries, scratch, count, keyBytes, workerCount);
+    } else {
+        QuoteSortEntriesSerial(entries, scratch, count, keyBytes);
+    }
+}
@@ -0,0 +1,88 @@
+//
+//  QuoteKeySort.h
+//  dgpoc
+//
+//  Stable sorts of 128-bit unsigned keys, each tagged with the index of the
+//  row it came from. Typed values are first made into keys that order as
+//  unsigned integers:
+//
+//      fixed       int64 ticks, sign bit flipped; missing first
+//      double      IEEE bits made monotonic; NaN (missing) first
+//
+//  Short inputs are merge sorted; from QUOTE_SORT_RADIX_MINIMUM keys up an
+//  LSD radix sort takes a byte per pass, skipping bytes every key shares, so
+//  prices with small magnitudes or ranks below 2^16 cost only a few passes.
+//  From QUOTE_SORT_PARALLEL_MINIMUM keys, given more than one worker, slices
+//  are sorted at once on GCD's global queue and k-way merged in parallel,
+//  each worker filling its own range of key values. Every path keeps equal
+//  keys in input order, so all of them give the same result.
+//
+
+#ifndef QuoteKeySort_h
+#define QuoteKeySort_h
+
+#include <math.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#ifndef QUOTE_SORT_RADIX_MINIMUM
+#define QUOTE_SORT_RADIX_MINIMUM 2048
+#endif
+
+#ifndef QUOTE_SORT_PARALLEL_MINIMUM
+#define QUOTE_SORT_PARALLEL_MINIMUM 262144
+#endif
+
+typedef struct {
+    uint64_t hi;
+    uint64_t lo;
+    uint32_t index;                 // into the rows being sorted
+} QuoteSortEntry;
+
+static inline uint64_t QuoteSortBitsOfFixed(int64_t value) {
+    // QUOTE_FIXED_MISSING, INT64_MIN, becomes 0
+    return (uint64_t)value ^ ((uint64_t)1 << 63);
+}
+
+static inline uint64_t QuoteSortBitsOfDouble(double value) {
+    if (isnan(value)) {
+        return 0;
+    }
+    if (value == 0) {
+        value = 0;  // -0 compares equal to 0
+    }
+    uint64_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    return (bits >> 63) ? ~bits : bits | ((uint64_t)1 << 63);
+}
+
+static inline bool QuoteSortEntryLess(const QuoteSortEntry *a, const QuoteSortEntry *b) {
+    return a->hi < b->hi || (a->hi == b->hi && a->lo < b->lo);
+}
+
+static inline bool QuoteSortEntryEqual(const QuoteSortEntry *a, const QuoteSortEntry *b) {
+    return a->hi == b->hi && a->lo == b->lo;
+}
+
+/// Sorts count entries by key on up to workerCount threads; scratch holds
+/// count entries. keyBytes is 8 when every lo is the same, else 16. count
+/// must be below 2^32.
+void QuoteSortEntries(QuoteSortEntry *entries, QuoteSortEntry *scratch, size_t count, size_t keyBytes,
+                      size_t workerCount);
+
+/// The algorithms QuoteSortEntries chooses between, for benchmarks. The
+/// parallel sort runs serially if its bookkeeping cannot be allocated.
+void QuoteSortEntriesMerge(QuoteSortEntry *entries, QuoteSortEntry *scratch, size_t count);
+void QuoteSortEntriesRadix(QuoteSortEntry *entries, QuoteSortEntry *scratch, size_t count, size_t keyBytes);
+void QuoteSortEntriesParallel(QuoteSortEntry *entries, QuoteSortEntry *scratch, size_t count, size_t keyBytes,
+                              size_t workerCount);
+
+/// Quickselect: reorders entries so the one with key rank nth (0 based) is
+/// found and every entry with that key sits in [*equalStart, *equalEnd),
+/// with the smaller keys before and the larger after, neither in any order.
+/// Expected O(count); nth must be below count.
+void QuoteSortEntriesSelect(QuoteSortEntry *entries, size_t count, size_t nth, size_t *equalStart, size_t *equalEnd);
+
+#endif /* QuoteKeySort_h */
@@ -0,0 +1,448 @@
+#include "QuoteNameIndex.h"
+#include "QuoteKeySort.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#define QUOTE_NAME_MIN_CAPACITY 64
+
+typedef struct {
+    const char *bytes;
+    size_t length;
+} QuoteNameWord;
+
+static inline bool QuoteNameIsTokenByte(uint8_t c) {
+    return (c >= '0' && c <= '9') || (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c >= 0x80;
+}
+
+// Cuts bytes into at most capacity words; returns how many.
+static size_t QuoteNameWords(const char *bytes, size_t length, QuoteNameWord *words, size_t capacity) {
+    size_t count = 0;
+    size_t i = 0;
+    while (i < length && count < capacity) {
+        while (i < length && !QuoteNameIsTokenByte((uint8_t)bytes[i])) {
+            i++;
+        }
+        size_t start = i;
+        while (i < length && QuoteNameIsTokenByte((uint8_t)bytes[i])) {
+            i++;
+        }
+        if (i > start) {
+            words[count].bytes = bytes + start;
+            words[count].length = i - start;
+            count++;
+        }
+    }
+    return count;
+}
+
+// Doubles *capacity until it holds count; false past UINT32_MAX.
+static bool QuoteNameCapacityFor(uint32_t *capacity, size_t count) {
+    size_t grown = *capacity ? *capacity : QUOTE_NAME_MIN_CAPACITY;
+    while (grown < count) {
+        grown *= 2;
+    }
+    if (grown >= UINT32_MAX) {
+        return false;
+    }
+    *capacity = (uint32_t)grown;
+    return true;
+}
+
+static bool QuoteNameIndexReserveNames(QuoteNameIndex *index, uint32_t name) {
+    if (name < index->nameCapacity) {
+        return true;
+    }
+    uint32_t capacity = index->nameCapacity;
+    if (!QuoteNameCapacityFor(&capacity, (size_t)name + 1)) {
+        return false;
+    }
+    QuoteNameProgress *progress = realloc(index->progress, capacity * sizeof(QuoteNameProgress));
+    if (!progress) {
+        return false;
+    }
+    memset(progress + index->nameCapacity, 0, (capacity - index->nameCapacity) * sizeof(QuoteNameProgress));
+    index->progress = progress;
+    index->nameCapacity = capacity;
+    return true;
+}
+
+void QuoteNameIndexInit(QuoteNameIndex *index) {
+    memset(index, 0, sizeof(*index));
+    QuoteStringTableInit(&index->tokens);
+}
+
+void QuoteNameIndexFree(QuoteNameIndex *index) {
+    QuoteStringTableFree(&index->tokens);
+    free(index->added);
+    free(index->listStarts);
+    free(index->listNames);
+    free(index->suffixes);
+    free(index->progress);
+    memset(index, 0, sizeof(*index));
+}
+
+bool QuoteNameIndexAdd(QuoteNameIndex *index, uint32_t name, const char *bytes, size_t length) {
+    if (name <= index->nameCount || !QuoteNameIndexReserveNames(index, name)) {
+        return false;
+    }
+    index->nameCount = name;
+    uint32_t nameStart = index->addedCount;
+    size_t i = 0;
+    QuoteNameWord word;
+    while (QuoteNameWords(bytes + i, length - i, &word, 1)) {
+        i = (size_t)(word.bytes - bytes) + word.length;
+        uint32_t token = QuoteStringTableIntern(&index->tokens, word.bytes, word.length);
+        if (token == 0) {
+            return false;
+        }
+        bool repeated = false;
+        for (uint32_t j = nameStart; j < index->addedCount && !repeated; j++) {
+            repeated = index->added[j].token == token;
+        }
+        if (repeated) {
+            continue;
+        }
+        if (index->addedCount == index->addedCapacity) {
+            uint32_t capacity = index->addedCapacity;
+            if (!QuoteNameCapacityFor(&capacity, (size_t)index->addedCount + 1)) {
+                return false;
+            }
+            QuoteNamePosting *added = realloc(index->added, capacity * sizeof(QuoteNamePosting));
+            if (!added) {
+                return false;
+            }
+            index->added = added;
+            index->addedCapacity = capacity;
+        }
+        index->added[index->addedCount].token = token;
+        index->added[index->addedCount].name = name;
+        index->addedCount++;
+    }
+    return true;
+}
+
+static inline const char *QuoteNameSuffixBytes(const QuoteNameIndex *index, QuoteNameSuffix suffix, size_t *length) {
+    *length = index->tokens.offsets[suffix.token] - suffix.position;
+    return index->tokens.heap + suffix.position;
+}
+
+static int QuoteNameSuffixCompare(const QuoteNameIndex *index, QuoteNameSuffix a, QuoteNameSuffix b) {
+    size_t aLength, bLength;
+    const char *aBytes = QuoteNameSuffixBytes(index, a, &aLength);
+    const char *bBytes = QuoteNameSuffixBytes(index, b, &bLength);
+    int order = memcmp(aBytes, bBytes, aLength < bLength ? aLength : bLength);
+    if (order) {
+        return order < 0 ? -1 : 1;
+    }
+    return aLength < bLength ? -1 : aLength > bLength;
+}
+
+// The suffix against a word as QuoteStringTableComparePrefix does: 0 when
+// the suffix begins with it.
+static int QuoteNameSuffixComparePrefix(const QuoteNameIndex *index, QuoteNameSuffix suffix, QuoteNameWord word) {
+    size_t length;
+    const char *bytes = QuoteNameSuffixBytes(index, suffix, &length);
+    int order = memcmp(bytes, word.bytes, length < word.length ? length : word.length);
+    if (order) {
+        return order < 0 ? -1 : 1;
+    }
+    return length < word.length ? -1 : 0;
+}
+
+// Sixteen bytes of a suffix as a key; token bytes are never 0, so padding
+// with 0 orders a shorter suffix first.
+static void QuoteNameSuffixKey(const QuoteNameIndex *index, QuoteNameSuffix suffix, QuoteSortEntry *entry) {
+    size_t length;
+    const uint8_t *bytes = (const uint8_t *)QuoteNameSuffixBytes(index, suffix, &length);
+    entry->hi = 0;
+    entry->lo = 0;
+    for (size_t i = 0; i < 16; i++) {
+        uint64_t byte = i < length ? bytes[i] : 0;
+        if (i < 8) {
+            entry->hi = entry->hi << 8 | byte;
+        } else {
+            entry->lo = entry->lo << 8 | byte;
+        }
+    }
+}
+
+// Moves the postings added since the last call into the lists. Names were
+// added in id order, so each list stays ascending.
+static bool QuoteNameIndexListAdded(QuoteNameIndex *index) {
+    if (index->addedCount == 0) {
+        return true;
+    }
+    uint32_t tokenCount = QuoteStringTableCount(&index->tokens);
+    size_t postingCount = (size_t)index->postingCount + index->addedCount;
+    uint32_t *starts = calloc((size_t)tokenCount + 2, sizeof(uint32_t));
+    uint32_t *names = malloc(postingCount * sizeof(uint32_t));
+    if (!starts || !names || postingCount >= UINT32_MAX) {
+        free(starts);
+        free(names);
+        return false;
+    }
+    // starts[token + 1] counts the token's names, then starts[token] is where
+    // they go, and once they are in, where they end
+    for (uint32_t token = 1; token <= index->listedTokens; token++) {
+        starts[token + 1] = index->listStarts[token] - index->listStarts[token - 1];
+    }
+    for (uint32_t i = 0; i < index->addedCount; i++) {
+        starts[index->added[i].token + 1]++;
+    }
+    for (uint32_t token = 1; token <= tokenCount + 1; token++) {
+        starts[token] += starts[token - 1];
+    }
+    for (uint32_t token = 1; token <= index->listedTokens; token++) {
+        uint32_t start = index->listStarts[token - 1], end = index->listStarts[token];
+        memcpy(names + starts[token], index->listNames + start, (end - start) * sizeof(uint32_t));
+        starts[token] += end - start;
+    }
+    for (uint32_t i = 0; i < index->addedCount; i++) {
+        names[starts[index->added[i].token]++] = index->added[i].name;
+    }
+    free(index->listStarts);
+    free(index->listNames);
+    index->listStarts = starts;
+    index->listNames = names;
+    index->postingCount = (uint32_t)postingCount;
+    index->addedCount = 0;
+    return true;
+}
+
+// Puts the suffixes of tokens interned since the last call in order:
+// sorted by their first sixteen bytes, ties past those settled by
+// insertion, then merged with the suffixes already in order.
+static bool QuoteNameIndexOrderSuffixes(QuoteNameIndex *index, uint32_t orderedTokens) {
+    uint32_t tokenCount = QuoteStringTableCount(&index->tokens);
+    if (orderedTokens == tokenCount) {
+        return true;
+    }
+    const uint32_t *offsets = index->tokens.offsets;
+    size_t addedCount = offsets[tokenCount] - offsets[orderedTokens];
+    size_t total = index->suffixCount + addedCount;
+    if (total >= UINT32_MAX) {
+        return false;
+    }
+    QuoteNameSuffix *added = malloc(addedCount * sizeof(QuoteNameSuffix));
+    QuoteSortEntry *entries = malloc(2 * addedCount * sizeof(QuoteSortEntry));
+    QuoteNameSuffix *merged = malloc(total * sizeof(QuoteNameSuffix));
+    if (!added || !entries || !merged) {
+        free(added);
+        free(entries);
+        free(merged);
+        return false;
+    }
+
+    size_t count = 0;
+    for (uint32_t token = orderedTokens + 1; token <= tokenCount; token++) {
+        for (uint32_t position = offsets[token - 1]; position < offsets[token]; position++) {
+            added[count].token = token;
+            added[count].position = position;
+            QuoteNameSuffixKey(index, added[count], &entries[count]);
+            entries[count].index = (uint32_t)count;
+            count++;
+        }
+    }
+    QuoteSortEntries(entries, entries + count, count, 16, 1);
+    QuoteNameSuffix *sorted = (QuoteNameSuffix *)(entries + count);
+    for (size_t i = 0; i < count; i++) {
+        sorted[i] = added[entries[i].index];
+    }
+    for (size_t start = 0, end; start < count; start = end) {
+        for (end = start + 1; end < count && QuoteSortEntryEqual(&entries[start], &entries[end]); end++) {
+        }
+        for (size_t i = start + 1; i < end; i++) {
+            QuoteNameSuffix suffix = sorted[i];
+            size_t j = i;
+            while (j > start && QuoteNameSuffixCompare(index, suffix, sorted[j - 1]) < 0) {
+                sorted[j] = sorted[j - 1];
+                j--;
+            }
+            sorted[j] = suffix;
+        }
+    }
+
+    size_t i = 0, j = 0, k = 0;
+    while (i < index->suffixCount && j < count) {
+        merged[k++] = QuoteNameSuffixCompare(index, sorted[j], index->suffixes[i]) < 0
+            ? sorted[j++] : index->suffixes[i++];
+    }
+    if (i < index->suffixCount) {
+        memcpy(merged + k, index->suffixes + i, (index->suffixCount - i) * sizeof(QuoteNameSuffix));
+        k += index->suffixCount - i;
+    }
+    memcpy(merged + k, sorted + j, (count - j) * sizeof(QuoteNameSuffix));
+    free(index->suffixes);
+    free(added);
+    free(entries);
+    index->suffixes = merged;
+    index->suffixCount = (uint32_t)total;
+    return true;
+}
+
+// Advances, or scores better, every name on token's list that matched the
+// words before this one; want is the progress of such a name.
+static bool QuoteNameIndexScoreToken(QuoteNameIndex *index, uint32_t token, uint32_t want, uint8_t score,
+                                     uint32_t **candidates, size_t *candidateCount, size_t *candidateCapacity) {
+    bool first = (want & 0xFF) == 0;
+    const uint32_t *names = index->listNames + index->listStarts[token - 1];
+    uint32_t count = index->listStarts[token] - index->listStarts[token - 1];
+    if (first && *candidateCount + count > *candidateCapacity) {
+        size_t capacity = *candidateCapacity * 2;
+        if (capacity < *candidateCount + count) {
+            capacity = *candidateCount + count;
+        }
+        uint32_t *grown = realloc(*candidates, capacity * sizeof(uint32_t));
+        if (!grown) {
+            return false;
+        }
+        *candidates = grown;
+        *candidateCapacity = capacity;
+    }
+    for (uint32_t i = 0; i < count; i++) {
+        QuoteNameProgress *progress = &index->progress[names[i]];
+        // the first word starts every name left over from earlier searches
+        if (first ? (progress->progress & ~0xFFu) != want : progress->progress == want) {
+            progress->progress = want + 1;
+            progress->score = (first ? 0 : progress->score) + score;
+            progress->best = score;
+            if (first) {
+                (*candidates)[(*candidateCount)++] = names[i];
+            }
+        } else if (progress->progress == want + 1 && score > progress->best) {
+            progress->score += score - progress->best;
+            progress->best = score;
+        }
+    }
+    return true;
+}
+
+bool QuoteNameIndexSearch(QuoteNameIndex *index, const char *query, size_t length, const uint32_t *ranks,
+                          QuoteNameMatch **matches, size_t *count) {
+    *matches = NULL;
+    *count = 0;
+    QuoteNameWord words[QUOTE_NAME_QUERY_WORDS];
+    size_t wordCount = QuoteNameWords(query, length, words, QUOTE_NAME_QUERY_WORDS);
+    if (wordCount == 0 || index->nameCount == 0) {
+        return true;
+    }
+    uint32_t tokenCount = QuoteStringTableCount(&index->tokens);
+    if (index->addedCount) {
+        if (!QuoteNameIndexListAdded(index) || !QuoteNameIndexOrderSuffixes(index, index->listedTokens)) {
+            return false;
+        }
+        index->listedTokens = tokenCount;
+    }
+    // progress from earlier searches never equals this one's
+    if (++index->generation == 1 << 24) {
+        memset(index->progress, 0, index->nameCapacity * sizeof(QuoteNameProgress));
+        index->generation = 1;
+    }
+    uint32_t generation = index->generation << 8;
+
+    uint32_t *candidates = NULL;
+    size_t candidateCount = 0, candidateCapacity = 0;
+    const uint32_t *offsets = index->tokens.offsets;
+    for (size_t w = 0; w < wordCount; w++) {
+        QuoteNameWord word = words[w];
+        uint32_t low = 0, high = index->suffixCount;
+        while (low < high) {
+            uint32_t middle = low + (high - low) / 2;
+            if (QuoteNameSuffixComparePrefix(index, index->suffixes[middle], word) < 0) {
+                low = middle + 1;
+            } else {
+                high = middle;
+            }
+        }
+        uint32_t first = low;
+        high = index->suffixCount;
+        while (low < high) {
+            uint32_t middle = low + (high - low) / 2;
+            if (QuoteNameSuffixComparePrefix(index, index->suffixes[middle], word) <= 0) {
+                low = middle + 1;
+            } else {
+                high = middle;
+            }
+        }
+
+        uint32_t want = generation | (uint32_t)w;
+        for (uint32_t i = first; i < low; i++) {
+            QuoteNameSuffix suffix = index->suffixes[i];
+            uint8_t score;
+            if (suffix.position != offsets[suffix.token - 1]) {
+                if (word.length < QUOTE_NAME_SUBSTRING_MINIMUM) {
+                    continue;
+                }
+                score = QUOTE_NAME_SCORE_SUBSTRING;
+            } else {
+                score = offsets[suffix.token] - suffix.position == word.length
+                    ? QUOTE_NAME_SCORE_EXACT : QUOTE_NAME_SCORE_PREFIX;
+            }
+            if (!QuoteNameIndexScoreToken(index, suffix.token, want, score, &candidates, &candidateCount,
+                                          &candidateCapacity)) {
+                free(candidates);
+                return false;
+            }
+        }
+    }
+
+    uint32_t matched = generation | (uint32_t)wordCount;
+    size_t matchCount = 0;
+    for (size_t i = 0; i < candidateCount; i++) {
+        if (index->progress[candidates[i]].progress == matched) {
+            candidates[matchCount++] = candidates[i];
+        }
+    }
+    if (matchCount == 0) {
+        free(candidates);
+        return true;
+    }
+    QuoteSortEntry *entries = malloc(2 * matchCount * sizeof(QuoteSortEntry));
+    QuoteNameMatch *found = malloc(matchCount * sizeof(QuoteNameMatch));
+    if (!entries || !found) {
+        free(candidates);
+        free(entries);
+        free(found);
+        return false;
+    }
+    for (size_t i = 0; i < matchCount; i++) {
+        uint32_t name = candidates[i];
+        entries[i].hi = (uint64_t)(UINT8_MAX - index->progress[name].score) << 32 | (ranks ? ranks[name] : name);
+        entries[i].lo = name;
+        entries[i].index = name;
+    }
+    QuoteSortEntries(entries, entries + matchCount, matchCount, 16, 1);
+    for (size_t i = 0; i < matchCount; i++) {
+        found[i].name = entries[i].index;
+        found[i].score = index->progress[entries[i].index].score;
+    }
+    free(candidates);
+    free(entries);
+    *matches = found;
+    *count = matchCount;
+    return true;
+}
+
+size_t QuoteNameIndexWordCount(const char *query, size_t length) {
+    QuoteNameWord words[QUOTE_NAME_QUERY_WORDS];
+    return QuoteNameWords(query, length, words, QUOTE_NAME_QUERY_WORDS);
+}
+
+bool QuoteNameIndexQueryRefines(const char *query, size_t length, const char *refined, size_t refinedLength) {
+    QuoteNameWord words[QUOTE_NAME_QUERY_WORDS], refinedWords[QUOTE_NAME_QUERY_WORDS];
+    size_t wordCount = QuoteNameWords(query, length, words, QUOTE_NAME_QUERY_WORDS);
+    size_t refinedCount = QuoteNameWords(refined, refinedLength, refinedWords, QUOTE_NAME_QUERY_WORDS);
+    // no words match no names, and nothing narrows from that
+    if (wordCount == 0 || refinedCount < wordCount) {
+        return false;
+    }
+    for (size_t i = 0; i < wordCount; i++) {
+        QuoteNameWord word = words[i], refinedWord = refinedWords[i];
+        if (refinedWord.length < word.length || memcmp(refinedWord.bytes, word.bytes, word.length) != 0
+            || (word.length < QUOTE_NAME_SUBSTRING_MINIMUM && refinedWord.length >= QUOTE_NAME_SUBSTRING_MINIMUM)) {
+            return false;
+        }
+    }
+    return true;
+}
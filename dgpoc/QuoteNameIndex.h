@@ -0,0 +1,112 @@
+//
+//  QuoteNameIndex.h
+//  dgpoc
+//
+//  Full-text search over company names by word. Each name is cut into
+//  tokens, runs of ASCII letters and digits and of non-ASCII bytes, which
+//  are interned once; each token keeps the list of names holding it, and
+//  every suffix of every token is kept in byte order. The tokens a query
+//  word begins, is, or is inside of are then one run of suffixes found by
+//  binary search, so a search never looks at a name that does not match.
+//
+//  A name matches when every word of the query matches one of its tokens:
+//
+//      exact       the token is the word                       QUOTE_NAME_SCORE_EXACT
+//      prefix      the token begins with it ("so" in "solar")  QUOTE_NAME_SCORE_PREFIX
+//      substring   the token holds it ("esson" in "wesson"),   QUOTE_NAME_SCORE_SUBSTRING
+//                  for words of QUOTE_NAME_SUBSTRING_MINIMUM
+//                  bytes or more
+//
+//  and scores the sum of its words' best matches. Names are added with
+//  increasing ids, already folded (case, marks) the way queries will be;
+//  adding costs a few words per token, and the next search merges what was
+//  added into the lists, each one token's names back to back, and the new
+//  suffixes into order.
+//
+//  Not thread safe; an index has one user at a time.
+//
+
+#ifndef QuoteNameIndex_h
+#define QuoteNameIndex_h
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "QuoteStringTable.h"
+
+#define QUOTE_NAME_SCORE_EXACT 4
+#define QUOTE_NAME_SCORE_PREFIX 2
+#define QUOTE_NAME_SCORE_SUBSTRING 1
+
+#define QUOTE_NAME_SUBSTRING_MINIMUM 3
+
+// Query words past this many are ignored.
+#define QUOTE_NAME_QUERY_WORDS 16
+
+typedef struct {
+    uint32_t name;
+    uint32_t score;
+} QuoteNameMatch;
+
+typedef struct {
+    uint32_t token;
+    uint32_t name;
+} QuoteNamePosting;
+
+typedef struct {
+    uint32_t token;
+    uint32_t position;          // of the suffix's first byte in the token heap
+} QuoteNameSuffix;
+
+typedef struct {
+    uint32_t progress;          // generation << 8 | words matched
+    uint8_t score;
+    uint8_t best;               // score of the current word's best match
+} QuoteNameProgress;
+
+typedef struct {
+    QuoteStringTable tokens;
+    QuoteNamePosting *added;    // postings not yet in the lists
+    uint32_t addedCount;
+    uint32_t addedCapacity;
+    uint32_t *listStarts;       // token id's names are listNames[listStarts[id - 1], listStarts[id])
+    uint32_t *listNames;
+    uint32_t listedTokens;
+    uint32_t postingCount;
+    QuoteNameSuffix *suffixes;  // of tokens 1...listedTokens, in byte order
+    uint32_t suffixCount;
+    uint32_t nameCount;         // highest name id added
+    uint32_t nameCapacity;
+    QuoteNameProgress *progress;    // by name id, for the search under way
+    uint32_t generation;
+} QuoteNameIndex;
+
+void QuoteNameIndexInit(QuoteNameIndex *index);
+void QuoteNameIndexFree(QuoteNameIndex *index);
+
+/// Indexes the tokens of name, whose id must be above every id added so
+/// far. Returns false when the index cannot grow.
+bool QuoteNameIndexAdd(QuoteNameIndex *index, uint32_t name, const char *bytes, size_t length);
+
+/// The names matching every word of query, best score first and equal
+/// scores by ranks[name] (or id, when ranks is NULL), then id. *matches is
+/// malloc'd for the caller to free, NULL when there are none. Returns
+/// false, with no matches, when memory runs out.
+bool QuoteNameIndexSearch(QuoteNameIndex *index, const char *query, size_t length, const uint32_t *ranks,
+                          QuoteNameMatch **matches, size_t *count);
+
+/// How many words of query a search matches names on, up to
+/// QUOTE_NAME_QUERY_WORDS. A query of none, only spaces and punctuation,
+/// matches no name.
+size_t QuoteNameIndexWordCount(const char *query, size_t length);
+
+/// True when every name matching refined also matches query, so a search
+/// for refined can look only at query's matches: refined has query's words,
+/// each the same or longer, and perhaps more after them ("first s" then
+/// "first so", "first so inc"). A word that grows to
+/// QUOTE_NAME_SUBSTRING_MINIMUM bytes starts matching inside tokens, so it
+/// does not refine.
+bool QuoteNameIndexQueryRefines(const char *query, size_t length, const char *refined, size_t refinedLength);
+
+#endif /* QuoteNameIndex_h */
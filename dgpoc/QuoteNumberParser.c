@@ -0,0 +1,246 @@
+#if !defined(__APPLE__) && !defined(_GNU_SOURCE)
+#define _GNU_SOURCE     // strtod_l
+#endif
+
+#include "QuoteNumberParser.h"
+
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#ifdef __APPLE__
+#include <xlocale.h>
+#else
+#include <locale.h>
+#endif
+
+// Longest input handed to the strtod_l fallback; fields longer than this are
+// not numbers this app will ever see.
+#define QUOTE_NUMBER_MAX_LENGTH 128
+
+static const double kQuotePowersOfTen[] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22,
+};
+
+static const uint64_t kQuoteMaxExactMantissa = (uint64_t)1 << 53;
+
+static locale_t QuoteCLocale;
+static pthread_once_t QuoteCLocaleOnce = PTHREAD_ONCE_INIT;
+
+static void QuoteCreateCLocale(void) {
+    QuoteCLocale = newlocale(LC_ALL_MASK, "C", (locale_t)0);
+}
+
+static inline bool QuoteIsBlank(char c) {
+    return c == ' ' || c == '\t' || c == '\r';
+}
+
+static inline bool QuoteIsDigit(char c) {
+    return (unsigned char)(c - '0') < 10;
+}
+
+static inline void QuoteTrim(const char **begin, const char **end) {
+    while (*begin < *end && QuoteIsBlank(**begin)) {
+        (*begin)++;
+    }
+    while (*end > *begin && QuoteIsBlank((*end)[-1])) {
+        (*end)--;
+    }
+}
+
+// Slow path for inputs outside the exact range: libc's correctly rounded
+// conversion, pinned to the C locale so ',' is never taken as the decimal point.
+static bool QuoteParseDoubleFallback(const char *begin, const char *end, double *value) {
+    char buffer[QUOTE_NUMBER_MAX_LENGTH + 1];
+    size_t length = (size_t)(end - begin);
+    if (length > QUOTE_NUMBER_MAX_LENGTH) {
+        return false;
+    }
+    memcpy(buffer, begin, length);
+    buffer[length] = '\0';
+
+    pthread_once(&QuoteCLocaleOnce, QuoteCreateCLocale);
+    *value = strtod_l(buffer, NULL, QuoteCLocale);
+    return true;
+}
+
+bool QuoteParseDouble(const char *bytes, size_t length, double *value) {
+    const char *p = bytes;
+    const char *end = bytes + length;
+    *value = 0;
+
+    QuoteTrim(&p, &end);
+    const char *begin = p;
+
+    bool negative = false;
+    if (p < end && (*p == '-' || *p == '+')) {
+        negative = *p == '-';
+        p++;
+    }
+
+    // Up to 19 significant digits fit in the mantissa; the rest only move the
+    // exponent, and mark the value inexact if any of them is non-zero.
+    uint64_t mantissa = 0;
+    int digits = 0;
+    int64_t exponent = 0;
+    bool any = false;
+    bool truncated = false;
+
+    for (; p < end && QuoteIsDigit(*p); p++) {
+        unsigned d = (unsigned)(*p - '0');
+        any = true;
+        if (mantissa == 0 && d == 0) {
+            continue;
+        }
+        if (digits < 19) {
+            mantissa = mantissa * 10 + d;
+            digits++;
+        } else {
+            exponent++;
+            truncated |= d != 0;
+        }
+    }
+    if (p < end && *p == '.') {
+        for (p++; p < end && QuoteIsDigit(*p); p++) {
+            unsigned d = (unsigned)(*p - '0');
+            any = true;
+            if (mantissa == 0 && d == 0) {
+                exponent--;
+            } else if (digits < 19) {
+                mantissa = mantissa * 10 + d;
+                digits++;
+                exponent--;
+            } else {
+                truncated |= d != 0;
+            }
+        }
+    }
+    if (!any) {
+        return false;
+    }
+
+    if (p < end && (*p == 'e' || *p == 'E')) {
+        p++;
+        bool negativeExponent = false;
+        if (p < end && (*p == '-' || *p == '+')) {
+            negativeExponent = *p == '-';
+            p++;
+        }
+        if (p == end || !QuoteIsDigit(*p)) {
+            return false;
+        }
+        int64_t e = 0;
+        for (; p < end && QuoteIsDigit(*p); p++) {
+            if (e < 100000) {
+                e = e * 10 + (*p - '0');
+            }
+        }
+        exponent += negativeExponent ? -e : e;
+    }
+    if (p != end) {
+        return false;
+    }
+
+    if (mantissa == 0) {
+        *value = negative ? -0.0 : 0.0;
+        return true;
+    }
+
+    // Clinger's fast path: an exact mantissa and an exact power of ten give a
+    // correctly rounded result with a single multiply or divide.
+    if (!truncated && mantissa <= kQuoteMaxExactMantissa) {
+        double v = (double)mantissa;
+        bool exact = true;
+        if (exponent < 0 && exponent >= -22) {
+            v /= kQuotePowersOfTen[-exponent];
+        } else if (exponent >= 0 && exponent <= 22) {
+            v *= kQuotePowersOfTen[exponent];
+        } else if (exponent > 22 && exponent <= 22 + 15) {
+            uint64_t scaled = mantissa;
+            for (int64_t i = 22; i < exponent && scaled <= kQuoteMaxExactMantissa; i++) {
+                scaled *= 10;
+            }
+            exact = scaled <= kQuoteMaxExactMantissa;
+            v = (double)scaled * 1e22;
+        } else {
+            exact = false;
+        }
+        if (exact) {
+            *value = negative ? -v : v;
+            return true;
+        }
+    }
+
+    return QuoteParseDoubleFallback(begin, end, value);
+}
+
+bool QuoteParseFixed(const char *bytes, size_t length, unsigned scale, int64_t *value) {
+    const char *p = bytes;
+    const char *end = bytes + length;
+    *value = 0;
+
+    if (scale > 18) {
+        return false;
+    }
+    QuoteTrim(&p, &end);
+
+    bool negative = false;
+    if (p < end && (*p == '-' || *p == '+')) {
+        negative = *p == '-';
+        p++;
+    }
+
+    const uint64_t limit = negative ? (uint64_t)INT64_MAX + 1 : (uint64_t)INT64_MAX;
+    uint64_t magnitude = 0;
+    unsigned kept = 0;
+    bool any = false;
+    bool roundUp = false;
+
+    for (; p < end && QuoteIsDigit(*p); p++) {
+        unsigned d = (unsigned)(*p - '0');
+        any = true;
+        if (magnitude > (limit - d) / 10) {
+            return false;
+        }
+        magnitude = magnitude * 10 + d;
+    }
+    if (p < end && *p == '.') {
+        for (p++; p < end && QuoteIsDigit(*p); p++) {
+            unsigned d = (unsigned)(*p - '0');
+            any = true;
+            if (kept < scale) {
+                if (magnitude > (limit - d) / 10) {
+                    return false;
+                }
+                magnitude = magnitude * 10 + d;
+                kept++;
+            } else if (kept == scale) {
+                roundUp = d >= 5;
+                kept++;
+            }
+        }
+    }
+    if (!any || p != end) {
+        return false;
+    }
+
+    for (; kept < scale; kept++) {
+        if (magnitude > limit / 10) {
+            return false;
+        }
+        magnitude *= 10;
+    }
+    if (roundUp) {
+        if (magnitude == limit) {
+            return false;
+        }
+        magnitude++;
+    }
+
+    if (negative) {
+        *value = magnitude == 0 ? 0 : -(int64_t)(magnitude - 1) - 1;
+    } else {
+        *value = (int64_t)magnitude;
+    }
+    return true;
+}
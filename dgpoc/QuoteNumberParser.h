@@ -0,0 +1,25 @@
+//
+//  QuoteNumberParser.h
+//  dgpoc
+//
+//  Locale independent number parsing straight off CSV field bytes. Nothing
+//  is allocated and the bytes need not be NUL terminated.
+//
+
+#ifndef QuoteNumberParser_h
+#define QuoteNumberParser_h
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/// Parses [+-]digits[.digits][(e|E)[+-]digits], surrounding blanks allowed.
+/// The result is correctly rounded. Returns false (and 0) for anything else.
+bool QuoteParseDouble(const char *bytes, size_t length, double *value);
+
+/// Parses [+-]digits[.digits] into value * 10^scale without going through
+/// floating point, rounding half away from zero past the last kept digit.
+/// Returns false (and 0) for malformed input or int64 overflow.
+bool QuoteParseFixed(const char *bytes, size_t length, unsigned scale, int64_t *value);
+
+#endif /* QuoteNumberParser_h */
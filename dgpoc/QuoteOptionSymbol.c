@@ -0,0 +1,105 @@
+#include "QuoteOptionSymbol.h"
+#include "QuoteNumberParser.h"
+#include "QuotePrice.h"
+
+#include <string.h>
+
+// The OCC tail after the root: YYMMDD, C or P, 8 strike digits.
+#define QUOTE_OCC_TAIL_LENGTH 15
+#define QUOTE_OCC_ROOT_LENGTH 6
+
+static inline bool QuoteReadDigits(const char *bytes, size_t count, uint32_t *value) {
+    uint32_t result = 0;
+    for (size_t i = 0; i < count; i++) {
+        unsigned d = (unsigned)(unsigned char)bytes[i] - '0';
+        if (d > 9) {
+            return false;
+        }
+        result = result * 10 + d;
+    }
+    *value = result;
+    return true;
+}
+
+static inline bool QuoteReadRight(char c, QuoteOptionRight *right) {
+    if (c == 'C') {
+        *right = QuoteOptionRightCall;
+    } else if (c == 'P') {
+        *right = QuoteOptionRightPut;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+// Two-digit years are this century, as on every listed contract.
+static bool QuoteMakeExpiry(uint32_t year, uint32_t month, uint32_t day, uint32_t *expiry) {
+    static const uint8_t kDaysInMonth[] = { 31, 29, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31 };
+    if (month < 1 || month > 12 || day < 1 || day > kDaysInMonth[month - 1]) {
+        return false;
+    }
+    year += 2000;
+    if (month == 2 && day == 29 && !(year % 4 == 0 && (year % 100 != 0 || year % 400 == 0))) {
+        return false;
+    }
+    *expiry = year * 10000 + month * 100 + day;
+    return true;
+}
+
+static bool QuoteParseOCC(const char *bytes, size_t length, QuoteOptionSymbol *option) {
+    if (length <= QUOTE_OCC_TAIL_LENGTH || length > QUOTE_OCC_ROOT_LENGTH + QUOTE_OCC_TAIL_LENGTH) {
+        return false;
+    }
+    const char *tail = bytes + length - QUOTE_OCC_TAIL_LENGTH;
+    uint32_t year, month, day, strike;
+    if (!QuoteReadDigits(tail, 2, &year) || !QuoteReadDigits(tail + 2, 2, &month)
+        || !QuoteReadDigits(tail + 4, 2, &day) || !QuoteReadRight(tail[6], &option->right)
+        || !QuoteReadDigits(tail + 7, 8, &strike)
+        || !QuoteMakeExpiry(year, month, day, &option->expiry)) {
+        return false;
+    }
+
+    size_t rootLength = (size_t)(tail - bytes);
+    while (rootLength > 0 && bytes[rootLength - 1] == ' ') {
+        rootLength--;
+    }
+    if (rootLength == 0 || memchr(bytes, ' ', rootLength)) {
+        return false;
+    }
+    option->underlying = bytes;
+    option->underlyingLength = rootLength;
+    // thousandths of a dollar to ticks
+    option->strike = (int64_t)strike * QuoteFixedScale(QUOTE_PRICE_DECIMALS) / 1000;
+    return true;
+}
+
+static bool QuoteParseUnderscore(const char *bytes, size_t length, QuoteOptionSymbol *option) {
+    const char *separator = memchr(bytes, '_', length);
+    if (!separator || separator == bytes) {
+        return false;
+    }
+    const char *code = separator + 1;
+    const char *end = bytes + length;
+    uint32_t month, day, year;
+    if (end - code < 8
+        || !QuoteReadDigits(code, 2, &month) || !QuoteReadDigits(code + 2, 2, &day)
+        || !QuoteReadDigits(code + 4, 2, &year) || !QuoteReadRight(code[6], &option->right)
+        || !QuoteMakeExpiry(year, month, day, &option->expiry)
+        || !QuoteParseFixed(code + 7, (size_t)(end - code - 7), QUOTE_PRICE_DECIMALS, &option->strike)
+        || option->strike < 0) {
+        return false;
+    }
+    option->underlying = bytes;
+    option->underlyingLength = (size_t)(separator - bytes);
+    return true;
+}
+
+bool QuoteOptionSymbolParse(const char *bytes, size_t length, QuoteOptionSymbol *option) {
+    memset(option, 0, sizeof(*option));
+    bool parsed = memchr(bytes, '_', length) ? QuoteParseUnderscore(bytes, length, option)
+                                             : QuoteParseOCC(bytes, length, option);
+    if (!parsed) {
+        memset(option, 0, sizeof(*option));
+    }
+    return parsed;
+}
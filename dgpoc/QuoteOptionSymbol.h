@@ -0,0 +1,42 @@
+//
+//  QuoteOptionSymbol.h
+//  dgpoc
+//
+//  Parses an option symbol into its underlying, expiry, call/put and strike.
+//  Two spellings are understood:
+//
+//      FSLR_012016C100         this app's feed: ROOT_MMDDYY, C or P, strike
+//                              as a plain decimal
+//      FSLR  160120C00100000   OCC: root padded to 6, YYMMDD, C or P, strike
+//                              times 1000 in 8 digits; the padding may be
+//                              left out
+//
+//  Nothing is allocated and malformed input is reported, never trapped.
+//
+
+#ifndef QuoteOptionSymbol_h
+#define QuoteOptionSymbol_h
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+typedef enum {
+    QuoteOptionRightNone = 0,
+    QuoteOptionRightCall = 1,
+    QuoteOptionRightPut = 2,
+} QuoteOptionRight;
+
+typedef struct {
+    const char *underlying;     // into the parsed bytes
+    size_t underlyingLength;
+    uint32_t expiry;            // yyyymmdd
+    QuoteOptionRight right;
+    int64_t strike;             // QUOTE_PRICE_DECIMALS ticks
+} QuoteOptionSymbol;
+
+/// Parses either spelling. Returns false, leaving option zeroed, for
+/// anything else: a missing part, a bad date, a non-numeric strike.
+bool QuoteOptionSymbolParse(const char *bytes, size_t length, QuoteOptionSymbol *option);
+
+#endif /* QuoteOptionSymbol_h */
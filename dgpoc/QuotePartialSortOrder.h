@@ -0,0 +1,46 @@
+//
+//  QuotePartialSortOrder.h
+//  dgpoc
+//
+//  Rows of a store sorted only as far as anyone has looked. Nothing is
+//  sorted up front; asking for the item at an index selects the rows up to
+//  it plus prefetchCount more (QuoteSortEngine sortRows:...toCount:), so a
+//  grid showing the top thirty of a million rows pays for one pass over them
+//  and a sort of a hundred or so. Each extension at least doubles the sorted
+//  head, so scrolling to the bottom costs about one full sort in all.
+//
+//  A tick keeps the sorted head: changed rows in it are put back in place
+//  and rows past it are only compared with its last row. The head is cut
+//  short where a row past it now sorts, and dropped when more than an eighth
+//  of the rows changed at once; the next access selects from there.
+//
+
+#import <Foundation/Foundation.h>
+#import "QuoteSortEngine.h"
+
+@interface QuotePartialSortOrder : NSObject
+
+/// Takes items, which must be QuoteItems of the engine's store, without
+/// sorting any of them yet.
+- (instancetype)initWithEngine:(QuoteSortEngine *)engine items:(NSArray *)items
+                   descriptors:(NSArray *)descriptors NS_DESIGNATED_INITIALIZER;
+- (instancetype)init NS_UNAVAILABLE;
+
+@property (nonatomic, readonly) NSArray *descriptors;
+@property (nonatomic, readonly) NSUInteger count;
+/// Leading rows that are in their sorted place.
+@property (nonatomic, readonly) NSUInteger sortedCount;
+/// Rows sorted past the one asked for, for the rows about to scroll into
+/// view. 64 unless set.
+@property (nonatomic) NSUInteger prefetchCount;
+/// The items in sorted order, sorting further as later ones are read.
+@property (nonatomic, readonly) NSArray *items;
+
+- (QuoteItem *)itemAtIndex:(NSUInteger)index;
+
+/// Puts rows whose fields changed back in order within the sorted head, if
+/// fields include one the descriptors read. Rows not among the items are
+/// ignored.
+- (void)updateRows:(const uint32_t *)rows count:(NSUInteger)count changedFields:(QuoteFieldMask)fields;
+
+@end
@@ -0,0 +1,123 @@
+#import "QuotePartialSortOrder.h"
+#import "QuoteItem.h"
+
+static const NSUInteger kQuotePartialSortPrefetchCount = 64;
+// Past this share of the rows changing at once, selecting again is cheaper.
+static const NSUInteger kQuotePartialSortReselectDivisor = 8;
+
+@interface QuotePartialSortOrderItemArray : NSArray
+
+- (instancetype)initWithOrder:(QuotePartialSortOrder *)order;
+
+@end
+
+@implementation QuotePartialSortOrder {
+    QuoteSortEngine *_engine;
+    NSArray *_sourceItems;
+    __unsafe_unretained id *_itemsByRow;    // kept alive by _sourceItems
+    uint32_t *_rows;
+    NSUInteger _rowCapacity;                // store rows _itemsByRow covers
+    QuoteFieldMask _fields;
+}
+
+- (instancetype)initWithEngine:(QuoteSortEngine *)engine items:(NSArray *)items descriptors:(NSArray *)descriptors {
+    NSParameterAssert(engine && [engine canSortUsingDescriptors:descriptors]);
+    self = [super init];
+    if (self) {
+        _engine = engine;
+        _sourceItems = [items copy];
+        _descriptors = [descriptors copy];
+        _count = _sourceItems.count;
+        _prefetchCount = kQuotePartialSortPrefetchCount;
+        for (NSSortDescriptor *descriptor in _descriptors) {
+            _fields |= QuoteFieldMaskForKey(descriptor.key);
+        }
+
+        _rowCapacity = engine.store.rowCount;
+        _rows = malloc(MAX(_count, 1) * sizeof(uint32_t));
+        _itemsByRow = (__unsafe_unretained id *)calloc(MAX(_rowCapacity, 1), sizeof(id));
+        if (!_rows || !_itemsByRow) {
+            [NSException raise:NSMallocException format:@"QuotePartialSortOrder cannot hold %lu rows",
+             (unsigned long)_count];
+        }
+        NSUInteger i = 0;
+        for (QuoteItem *item in _sourceItems) {
+            if (item.store != engine.store || item.row >= _rowCapacity) {
+                [NSException raise:NSInvalidArgumentException format:@"%@ is not a row of the sorted store", item];
+            }
+            _rows[i++] = (uint32_t)item.row;
+            _itemsByRow[item.row] = item;
+        }
+    }
+    return self;
+}
+
+- (void)dealloc {
+    free(_rows);
+    free(_itemsByRow);
+}
+
+- (NSArray *)items {
+    return [[QuotePartialSortOrderItemArray alloc] initWithOrder:self];
+}
+
+- (QuoteItem *)itemAtIndex:(NSUInteger)index {
+    if (index >= _sortedCount) {
+        NSUInteger target = MAX(index + 1 + _prefetchCount, 2 * _sortedCount);
+        _sortedCount = [_engine sortRows:_rows count:_count sortedCount:_sortedCount
+                                 toCount:MIN(target, _count) usingDescriptors:_descriptors];
+    }
+    return _itemsByRow[_rows[index]];
+}
+
+- (void)updateRows:(const uint32_t *)rows count:(NSUInteger)count changedFields:(QuoteFieldMask)fields {
+    if (!(fields & _fields) || count == 0 || _sortedCount == 0) {
+        return;
+    }
+    if (count > _count / kQuotePartialSortReselectDivisor) {
+        _sortedCount = 0;
+        return;
+    }
+    uint32_t *changed = malloc(count * sizeof(uint32_t));
+    if (!changed) {
+        [NSException raise:NSMallocException format:@"QuotePartialSortOrder cannot update %lu rows",
+         (unsigned long)count];
+    }
+    NSUInteger changedCount = 0;
+    for (NSUInteger i = 0; i < count; i++) {
+        if (rows[i] < _rowCapacity && _itemsByRow[rows[i]]) {
+            changed[changedCount++] = rows[i];
+        }
+    }
+    _sortedCount = [_engine updateSortedRows:_rows count:_count sortedCount:_sortedCount
+                                 changedRows:changed count:changedCount usingDescriptors:_descriptors];
+    free(changed);
+}
+
+@end
+
+@implementation QuotePartialSortOrderItemArray {
+    QuotePartialSortOrder *_order;
+}
+
+- (instancetype)initWithOrder:(QuotePartialSortOrder *)order {
+    self = [super init];
+    if (self) {
+        _order = order;
+    }
+    return self;
+}
+
+- (NSUInteger)count {
+    return _order.count;
+}
+
+- (id)objectAtIndex:(NSUInteger)index {
+    if (index >= _order.count) {
+        [NSException raise:NSRangeException format:@"index %lu beyond bounds [0 .. %lu]",
+         (unsigned long)index, (unsigned long)_order.count];
+    }
+    return [_order itemAtIndex:index];
+}
+
+@end
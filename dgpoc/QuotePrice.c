@@ -0,0 +1,78 @@
+#include "QuotePrice.h"
+
+#include <math.h>
+#include <string.h>
+
+static const int64_t kQuotePowersOfTen[] = {
+    1LL, 10LL, 100LL, 1000LL, 10000LL, 100000LL, 1000000LL, 10000000LL, 100000000LL,
+    1000000000LL, 10000000000LL, 100000000000LL, 1000000000000LL, 10000000000000LL,
+    100000000000000LL, 1000000000000000LL, 10000000000000000LL, 100000000000000000LL,
+    1000000000000000000LL,
+};
+
+int64_t QuoteFixedScale(unsigned decimals) {
+    return decimals <= 18 ? kQuotePowersOfTen[decimals] : 0;
+}
+
+int64_t QuoteFixedFromDouble(double value, unsigned decimals) {
+    double scaled = round(value * (double)QuoteFixedScale(decimals));
+    if (isnan(scaled)) {
+        return QUOTE_FIXED_MISSING;
+    }
+    // 2^63 is exact in double; anything at or past it does not fit
+    if (scaled >= 9223372036854775808.0) {
+        return INT64_MAX;
+    }
+    if (scaled <= -9223372036854775808.0) {
+        return INT64_MIN + 1;
+    }
+    return (int64_t)scaled;
+}
+
+size_t QuoteFixedFormat(int64_t value, unsigned decimals, unsigned shown, char *buffer, size_t capacity) {
+    char digits[32];
+    size_t length = 0;
+    bool negative = value < 0;
+    uint64_t magnitude = negative ? (uint64_t)0 - (uint64_t)value : (uint64_t)value;
+
+    if (decimals > 18) {
+        decimals = 18;
+    }
+    if (shown > decimals) {
+        shown = decimals;
+    }
+    if (shown < decimals) {
+        uint64_t drop = (uint64_t)kQuotePowersOfTen[decimals - shown];
+        uint64_t remainder = magnitude % drop;
+        magnitude /= drop;
+        if (remainder >= drop - remainder) {
+            magnitude++;
+        }
+    }
+    negative &= magnitude != 0;
+
+    // digits come out least significant first
+    unsigned place = 0;
+    do {
+        if (place == shown && shown > 0) {
+            digits[length++] = '.';
+        } else if (place > shown && (place - shown) % 3 == 0) {
+            digits[length++] = ',';
+        }
+        digits[length++] = (char)('0' + magnitude % 10);
+        magnitude /= 10;
+        place++;
+    } while (magnitude > 0 || place <= shown);
+    if (negative) {
+        digits[length++] = '-';
+    }
+
+    size_t written = 0;
+    for (; written < length && written + 1 < capacity; written++) {
+        buffer[written] = digits[length - 1 - written];
+    }
+    if (capacity > 0) {
+        buffer[written] = '\0';
+    }
+    return written;
+}
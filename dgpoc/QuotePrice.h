@@ -0,0 +1,50 @@
+//
+//  QuotePrice.h
+//  dgpoc
+//
+//  Prices as int64 ticks of 10^-QUOTE_PRICE_DECIMALS. Adding, comparing and
+//  formatting ticks is exact, so repeated tick updates never drift the way
+//  binary doubles do.
+//
+
+#ifndef QuotePrice_h
+#define QuotePrice_h
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifndef QUOTE_PRICE_DECIMALS
+#define QUOTE_PRICE_DECIMALS 4
+#endif
+
+#if QUOTE_PRICE_DECIMALS < 2 || QUOTE_PRICE_DECIMALS > 8
+#error QUOTE_PRICE_DECIMALS must keep whole cents and leave room for prices
+#endif
+
+typedef int64_t QuotePrice;
+
+/// Marks a fixed-point value that was never set.
+#define QUOTE_FIXED_MISSING INT64_MIN
+
+/// 10^decimals for decimals <= 18.
+int64_t QuoteFixedScale(unsigned decimals);
+
+static inline QuotePrice QuotePriceFromCents(int64_t cents) {
+    return cents * (QuoteFixedScale(QUOTE_PRICE_DECIMALS) / 100);
+}
+
+static inline double QuoteFixedToDouble(int64_t value, unsigned decimals) {
+    return (double)value / (double)QuoteFixedScale(decimals);
+}
+
+/// Rounds value * 10^decimals half away from zero. Out of range values clamp.
+int64_t QuoteFixedFromDouble(double value, unsigned decimals);
+
+/// Writes value, a fixed-point number with `decimals` places, rounded half
+/// away from zero to `shown` places and with ',' between thousands, e.g.
+/// "-1,234.57". Returns the length written, excluding the NUL; capacity 32
+/// always suffices.
+size_t QuoteFixedFormat(int64_t value, unsigned decimals, unsigned shown, char *buffer, size_t capacity);
+
+#endif /* QuotePrice_h */
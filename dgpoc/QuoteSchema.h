@@ -0,0 +1,91 @@
+//
+//  QuoteSchema.h
+//  dgpoc
+//
+//  The fields of a quote, in quotes.csv column order, with the QuoteItem
+//  property each one maps to.
+//
+
+#import <Foundation/Foundation.h>
+#import "QuotePrice.h"
+
+typedef NS_ENUM(NSUInteger, QuoteField) {
+    QuoteFieldAssetType,
+    QuoteFieldSymbol,
+    QuoteFieldSymbolName,
+    QuoteFieldUnderlyingSymbol,
+    QuoteFieldLastTrade,
+    QuoteFieldLastTradeDate,
+    QuoteFieldLastTradeTime,
+    QuoteFieldChangePercentChange,
+    QuoteFieldChange,
+    QuoteFieldOpen,
+    QuoteFieldDaysHigh,
+    QuoteFieldDaysLow,
+    QuoteFieldVolume,
+    QuoteFieldAsk,
+    QuoteFieldAverageDailyVolume,
+    QuoteFieldAskSize,
+    QuoteFieldFiftyTwoWeekHigh,
+    QuoteFieldChangeFrom52weekHigh,
+    QuoteFieldPercentChangeFrom52weeklow,
+    QuoteFieldFiftyTwoWeekRange,
+    QuoteFieldBid,
+    QuoteFieldBidSize,
+    QuoteFieldFiftyDayMovingAverage,
+    QuoteFieldEarningsShare,
+    QuoteFieldCount
+};
+
+typedef NS_ENUM(uint8_t, QuoteFieldType) {
+    QuoteFieldTypeString,
+    QuoteFieldTypeDouble,
+    QuoteFieldTypeFixed,    // int64 with QuoteFieldDecimals places, see QuotePrice.h
+};
+
+/// What the single-letter Asset Type column holds.
+typedef NS_ENUM(uint8_t, QuoteAssetType) {
+    QuoteAssetTypeUnknown,
+    QuoteAssetTypeEquity,   // "E"
+    QuoteAssetTypeOption,   // "O"
+};
+
+/// The QuoteItem property name, e.g. @"lastTrade".
+NSString *QuoteFieldKey(QuoteField field);
+/// The quotes.csv header title, e.g. @"Last Trade".
+NSString *QuoteFieldTitle(QuoteField field);
+/// The field a CSV header names, by title or property key and ignoring case,
+/// or QuoteFieldCount for a column that is not part of the schema.
+QuoteField QuoteFieldForHeader(NSString *header);
+QuoteFieldType QuoteFieldTypeOf(QuoteField field);
+/// Decimal places of a QuoteFieldTypeFixed field: QUOTE_PRICE_DECIMALS for
+/// prices, 0 for share counts. 0 for other types.
+unsigned QuoteFieldDecimals(QuoteField field);
+/// The field whose property key is key, or QuoteFieldCount.
+QuoteField QuoteFieldForKey(NSString *key);
+/// The string field whose table a string field's codes index; the field
+/// itself unless it shares one. Symbol and underlying symbol share, so a
+/// ticker has the same id in both columns.
+QuoteField QuoteFieldStringTableOwner(QuoteField field);
+
+QuoteAssetType QuoteAssetTypeFromBytes(const char *bytes, size_t length);
+
+/// Hash over every field's key, type, decimals and string table; changes
+/// whenever the schema does.
+uint64_t QuoteSchemaHash(void);
+
+typedef uint32_t QuoteFieldMask;
+
+static inline QuoteFieldMask QuoteFieldMaskOf(QuoteField field) {
+    return (QuoteFieldMask)1 << field;
+}
+
+extern const QuoteFieldMask QuoteFieldMaskAll;
+
+/// Fields every row needs whatever columns are showing: the symbol cell, the
+/// row height and the symbol sort keys are built from them.
+extern const QuoteFieldMask QuoteFieldMaskIdentity;
+
+/// Fields a KVC key on QuoteItem reads: the field itself for stored properties,
+/// its inputs for derived ones like symbolSortAscending. 0 for unknown keys.
+QuoteFieldMask QuoteFieldMaskForKey(NSString *key);
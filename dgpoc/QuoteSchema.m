@@ -0,0 +1,147 @@
+#import "QuoteSchema.h"
+
+typedef struct {
+    __unsafe_unretained NSString *key;
+    __unsafe_unretained NSString *title;
+    QuoteFieldType type;
+    uint8_t decimals;
+} QuoteFieldInfo;
+
+static const QuoteFieldInfo kQuoteFields[QuoteFieldCount] = {
+    [QuoteFieldAssetType]                   = { @"assetType",                  @"Asset Type",                     QuoteFieldTypeString, 0 },
+    [QuoteFieldSymbol]                      = { @"symbol",                     @"Symbol",                         QuoteFieldTypeString, 0 },
+    [QuoteFieldSymbolName]                  = { @"symbolName",                 @"Name",                           QuoteFieldTypeString, 0 },
+    [QuoteFieldUnderlyingSymbol]            = { @"underlyingSymbol",           @"Underlying Symbol",              QuoteFieldTypeString, 0 },
+    [QuoteFieldLastTrade]                   = { @"lastTrade",                  @"Last Trade",                     QuoteFieldTypeFixed,  QUOTE_PRICE_DECIMALS },
+    [QuoteFieldLastTradeDate]               = { @"lastTradeDate",              @"Last Trade Date",                QuoteFieldTypeString, 0 },
+    [QuoteFieldLastTradeTime]               = { @"lastTradeTime",              @"Last Trade Time",                QuoteFieldTypeString, 0 },
+    [QuoteFieldChangePercentChange]         = { @"changePercentChange",        @"Change & Percent Change",        QuoteFieldTypeDouble, 0 },
+    [QuoteFieldChange]                      = { @"change",                     @"Change",                         QuoteFieldTypeDouble, 0 },
+    [QuoteFieldOpen]                        = { @"open",                       @"Open",                           QuoteFieldTypeFixed,  QUOTE_PRICE_DECIMALS },
+    [QuoteFieldDaysHigh]                    = { @"daysHigh",                   @"Day's High",                     QuoteFieldTypeFixed,  QUOTE_PRICE_DECIMALS },
+    [QuoteFieldDaysLow]                     = { @"daysLow",                    @"Day's Low",                      QuoteFieldTypeFixed,  QUOTE_PRICE_DECIMALS },
+    [QuoteFieldVolume]                      = { @"volume",                     @"Volume",                         QuoteFieldTypeFixed,  0 },
+    [QuoteFieldAsk]                         = { @"ask",                        @"Ask",                            QuoteFieldTypeFixed,  QUOTE_PRICE_DECIMALS },
+    [QuoteFieldAverageDailyVolume]          = { @"averageDailyVolume",         @"Average Daily Volume",           QuoteFieldTypeFixed,  0 },
+    [QuoteFieldAskSize]                     = { @"askSize",                    @"Ask Size",                       QuoteFieldTypeFixed,  0 },
+    [QuoteFieldFiftyTwoWeekHigh]            = { @"FiftyTwoWeekHigh",           @"52-week High",                   QuoteFieldTypeDouble, 0 },
+    [QuoteFieldChangeFrom52weekHigh]        = { @"changeFrom52weekHigh",       @"Change From 52-week High",       QuoteFieldTypeDouble, 0 },
+    [QuoteFieldPercentChangeFrom52weeklow]  = { @"percentChangeFrom52weeklow", @"Percent Change From 52-week Low", QuoteFieldTypeDouble, 0 },
+    [QuoteFieldFiftyTwoWeekRange]           = { @"FiftyTwoWeekRange",          @"52-week Range",                  QuoteFieldTypeString, 0 },
+    [QuoteFieldBid]                         = { @"bid",                        @"Bid",                            QuoteFieldTypeFixed,  QUOTE_PRICE_DECIMALS },
+    [QuoteFieldBidSize]                     = { @"bidSize",                    @"Bid Size",                       QuoteFieldTypeFixed,  0 },
+    [QuoteFieldFiftyDayMovingAverage]       = { @"FiftyDayMovingAverage",      @"50-day Moving Average",          QuoteFieldTypeDouble, 0 },
+    [QuoteFieldEarningsShare]               = { @"earningsShare",              @"Earnings/Share",                 QuoteFieldTypeDouble, 0 },
+};
+
+const QuoteFieldMask QuoteFieldMaskAll = ((QuoteFieldMask)1 << QuoteFieldCount) - 1;
+
+const QuoteFieldMask QuoteFieldMaskIdentity = (1 << QuoteFieldAssetType) | (1 << QuoteFieldSymbol)
+    | (1 << QuoteFieldSymbolName) | (1 << QuoteFieldUnderlyingSymbol);
+
+NSString *QuoteFieldKey(QuoteField field) {
+    return kQuoteFields[field].key;
+}
+
+NSString *QuoteFieldTitle(QuoteField field) {
+    return kQuoteFields[field].title;
+}
+
+QuoteField QuoteFieldForHeader(NSString *header) {
+    static NSDictionary *fields;
+    static NSCharacterSet *padding;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        // a byte order mark shows up stuck to the first title
+        NSMutableCharacterSet *set = [NSMutableCharacterSet whitespaceCharacterSet];
+        [set addCharactersInRange:NSMakeRange(0xFEFF, 1)];
+        padding = [set copy];
+
+        NSMutableDictionary *headerFields = [NSMutableDictionary dictionary];
+        for (QuoteField field = 0; field < QuoteFieldCount; field++) {
+            headerFields[kQuoteFields[field].key.lowercaseString] = @(field);
+            headerFields[kQuoteFields[field].title.lowercaseString] = @(field);
+        }
+        fields = [headerFields copy];
+    });
+    NSString *name = [header stringByTrimmingCharactersInSet:padding].lowercaseString;
+    NSNumber *field = name ? fields[name] : nil;
+    return field ? field.unsignedIntegerValue : QuoteFieldCount;
+}
+
+QuoteFieldType QuoteFieldTypeOf(QuoteField field) {
+    return kQuoteFields[field].type;
+}
+
+unsigned QuoteFieldDecimals(QuoteField field) {
+    return kQuoteFields[field].decimals;
+}
+
+QuoteField QuoteFieldForKey(NSString *key) {
+    static NSDictionary *fields;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        NSMutableDictionary *keyFields = [NSMutableDictionary dictionary];
+        for (QuoteField field = 0; field < QuoteFieldCount; field++) {
+            keyFields[kQuoteFields[field].key] = @(field);
+        }
+        fields = [keyFields copy];
+    });
+    NSNumber *field = key ? fields[key] : nil;
+    return field ? field.unsignedIntegerValue : QuoteFieldCount;
+}
+
+QuoteField QuoteFieldStringTableOwner(QuoteField field) {
+    return field == QuoteFieldUnderlyingSymbol ? QuoteFieldSymbol : field;
+}
+
+QuoteAssetType QuoteAssetTypeFromBytes(const char *bytes, size_t length) {
+    if (length != 1) {
+        return QuoteAssetTypeUnknown;
+    }
+    switch (bytes[0]) {
+        case 'E': return QuoteAssetTypeEquity;
+        case 'O': return QuoteAssetTypeOption;
+        default:  return QuoteAssetTypeUnknown;
+    }
+}
+
+uint64_t QuoteSchemaHash(void) {
+    static uint64_t hash;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        // FNV-1a
+        hash = 14695981039346656037ULL;
+        for (QuoteField field = 0; field < QuoteFieldCount; field++) {
+            const char *key = kQuoteFields[field].key.UTF8String;
+            for (const char *p = key; *p; p++) {
+                hash = (hash ^ (uint8_t)*p) * 1099511628211ULL;
+            }
+            hash = (hash ^ kQuoteFields[field].type) * 1099511628211ULL;
+            hash = (hash ^ kQuoteFields[field].decimals) * 1099511628211ULL;
+            hash = (hash ^ QuoteFieldStringTableOwner(field)) * 1099511628211ULL;
+        }
+    });
+    return hash;
+}
+
+QuoteFieldMask QuoteFieldMaskForKey(NSString *key) {
+    static NSDictionary *masks;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        NSMutableDictionary *keyMasks = [NSMutableDictionary dictionary];
+        for (QuoteField field = 0; field < QuoteFieldCount; field++) {
+            keyMasks[kQuoteFields[field].key] = @(QuoteFieldMaskOf(field));
+        }
+        NSNumber *symbolSort = @(QuoteFieldMaskOf(QuoteFieldAssetType) | QuoteFieldMaskOf(QuoteFieldSymbol)
+                                 | QuoteFieldMaskOf(QuoteFieldUnderlyingSymbol));
+        keyMasks[@"symbolSort"] = symbolSort;
+        keyMasks[@"symbolSortAscending"] = symbolSort;
+        keyMasks[@"symbolSortDescending"] = symbolSort;
+        keyMasks[@"quoteAssetType"] = @(QuoteFieldMaskOf(QuoteFieldAssetType));
+        keyMasks[@"symbolId"] = @(QuoteFieldMaskOf(QuoteFieldSymbol));
+        keyMasks[@"underlyingSymbolId"] = @(QuoteFieldMaskOf(QuoteFieldUnderlyingSymbol));
+        masks = [keyMasks copy];
+    });
+    return key ? (QuoteFieldMask)[masks[key] unsignedIntValue] : 0;
+}
@@ -0,0 +1,56 @@
+//
+//  QuoteSnapshot.h
+//  dgpoc
+//
+//  Versioned binary snapshot of a quote set, laid out column by column so it
+//  can be memory-mapped and used without parsing:
+//
+//      header      magic "QSNP", version, row/column counts, schema hash,
+//                  source stamp
+//      columns     one descriptor per QuoteField, then the column blocks:
+//                  double[rowCount] or int64[rowCount] fixed-point ticks
+//                  for numeric fields; for string fields
+//                  uint32 stringCount, codes[rowCount] and string-heap
+//                  offsets[stringCount + 1], the same dictionary encoding a
+//                  QuoteStore uses; fields sharing a table repeat its
+//                  count and offsets
+//      heap        UTF-8 bytes of every distinct string, back to back
+//
+//  Everything is native endian and 8-byte aligned. Opening one checks the
+//  header and every string table, work in proportion to the distinct strings
+//  rather than the rows; codes are checked where they are read. Loading a
+//  store from it is one copy of each column; no string is parsed or hashed.
+//
+
+#import <Foundation/Foundation.h>
+#import "QuoteSchema.h"
+#import "QuoteStore.h"
+
+@interface QuoteSnapshot : NSObject
+
+/// Maps the snapshot and validates its header. Returns nil when the file is
+/// missing, truncated, from another format version or another schema, or was
+/// written from a different source (see sourceStamp).
++ (instancetype)snapshotWithContentsOfURL:(NSURL *)url sourceStamp:(uint64_t)sourceStamp;
+
++ (BOOL)writeQuoteStore:(QuoteStore *)store sourceStamp:(uint64_t)sourceStamp toURL:(NSURL *)url;
+
+/// A cheap fingerprint (size and modification date) of the file a snapshot
+/// is derived from.
++ (uint64_t)sourceStampForURL:(NSURL *)url;
+
+@property (nonatomic, readonly) NSUInteger rowCount;
+
+- (const double *)doubleColumn:(QuoteField)field;
+- (const int64_t *)fixedColumn:(QuoteField)field;
+/// nil for a missing string, or a code that names none.
+- (NSString *)stringForField:(QuoteField)field row:(NSUInteger)row;
+
+/// A new store holding the snapshot's rows, or nil when a code names no
+/// string or the store cannot take the strings.
+- (QuoteStore *)quoteStore;
+
+/// QuoteItem views over a new quoteStore, or nil.
+- (NSArray *)quoteItems;
+
+@end
@@ -0,0 +1,265 @@
+#import "QuoteSnapshot.h"
+
+static const char kQuoteSnapshotMagic[4] = { 'Q', 'S', 'N', 'P' };
+static const uint16_t kQuoteSnapshotVersion = 3;
+
+typedef struct {
+    char magic[4];
+    uint16_t version;
+    uint16_t columnCount;
+    uint32_t rowCount;
+    uint32_t reserved;
+    uint64_t schemaHash;
+    uint64_t sourceStamp;
+    uint64_t heapOffset;
+    uint64_t heapLength;
+} QuoteSnapshotHeader;
+
+typedef struct {
+    uint32_t type;
+    uint32_t reserved;
+    uint64_t offset;
+} QuoteSnapshotColumn;
+
+typedef struct {
+    uint32_t stringCount;
+    const uint32_t *codes;
+    const uint32_t *offsets;
+} QuoteSnapshotStrings;
+
+static inline QuoteSnapshotStrings QuoteSnapshotStringsAt(const char *block, size_t rowCount) {
+    QuoteSnapshotStrings strings;
+    memcpy(&strings.stringCount, block, sizeof(uint32_t));
+    strings.codes = (const uint32_t *)block + 1;
+    strings.offsets = strings.codes + rowCount;
+    return strings;
+}
+
+// Copies a column's codes and checks, in the same pass, that every one
+// names a string of its table.
+static inline bool QuoteSnapshotCopyCodes(uint32_t *codes, QuoteSnapshotStrings strings, size_t rowCount) {
+    uint32_t largest = 0;
+    for (size_t row = 0; row < rowCount; row++) {
+        uint32_t code = strings.codes[row];
+        codes[row] = code;
+        largest = code > largest ? code : largest;
+    }
+    return largest <= strings.stringCount;
+}
+
+static inline void QuoteSnapshotPad(NSMutableData *data) {
+    static const uint8_t zeros[8] = { 0 };
+    NSUInteger remainder = data.length % 8;
+    if (remainder) {
+        [data appendBytes:zeros length:8 - remainder];
+    }
+}
+
+#pragma mark -
+
+@interface QuoteSnapshot ()
+
+@property (nonatomic, strong) NSData *data;
+
+@end
+
+@implementation QuoteSnapshot {
+    const QuoteSnapshotColumn *_columns;
+    const char *_heap;
+}
+
++ (instancetype)snapshotWithContentsOfURL:(NSURL *)url sourceStamp:(uint64_t)sourceStamp {
+    NSData *data = [NSData dataWithContentsOfURL:url options:NSDataReadingMappedAlways error:NULL];
+    if (data.length < sizeof(QuoteSnapshotHeader) + QuoteFieldCount * sizeof(QuoteSnapshotColumn)) {
+        return nil;
+    }
+
+    const QuoteSnapshotHeader *header = data.bytes;
+    if (memcmp(header->magic, kQuoteSnapshotMagic, sizeof(kQuoteSnapshotMagic)) != 0
+        || header->version != kQuoteSnapshotVersion
+        || header->columnCount != QuoteFieldCount
+        || header->schemaHash != QuoteSchemaHash()
+        || header->sourceStamp != sourceStamp
+        || header->heapOffset > data.length
+        || header->heapLength > data.length - header->heapOffset) {
+        return nil;
+    }
+
+    const QuoteSnapshotColumn *columns = (const QuoteSnapshotColumn *)(header + 1);
+    for (QuoteField field = 0; field < QuoteFieldCount; field++) {
+        if (columns[field].type != QuoteFieldTypeOf(field)
+            || columns[field].offset % 8 != 0
+            || columns[field].offset > data.length) {
+            return nil;
+        }
+        size_t available = data.length - columns[field].offset;
+        const char *block = (const char *)data.bytes + columns[field].offset;
+        if (columns[field].type != QuoteFieldTypeString) {
+            // doubles and fixed-point ticks are both 8 bytes a row
+            if (header->rowCount * sizeof(uint64_t) > available) {
+                return nil;
+            }
+            continue;
+        }
+
+        // every string lies inside the heap
+        if (available < sizeof(uint32_t)) {
+            return nil;
+        }
+        QuoteSnapshotStrings strings = QuoteSnapshotStringsAt(block, header->rowCount);
+        if (((size_t)header->rowCount + strings.stringCount + 2) * sizeof(uint32_t) > available) {
+            return nil;
+        }
+        // a shared table is loaded once, from its owner's block
+        QuoteField owner = QuoteFieldStringTableOwner(field);
+        if (owner != field) {
+            const char *ownerBlock = (const char *)data.bytes + columns[owner].offset;
+            if (strings.stringCount != QuoteSnapshotStringsAt(ownerBlock, header->rowCount).stringCount) {
+                return nil;
+            }
+        }
+        // codes are checked where they are read, so opening stays
+        // proportional to the distinct strings rather than the rows
+        for (uint32_t i = 0; i < strings.stringCount; i++) {
+            if (strings.offsets[i] > strings.offsets[i + 1]) {
+                return nil;
+            }
+        }
+        if (strings.offsets[strings.stringCount] > header->heapLength) {
+            return nil;
+        }
+    }
+
+    QuoteSnapshot *snapshot = [[self alloc] init];
+    snapshot.data = data;
+    snapshot->_rowCount = header->rowCount;
+    snapshot->_columns = columns;
+    snapshot->_heap = (const char *)data.bytes + header->heapOffset;
+    return snapshot;
+}
+
++ (BOOL)writeQuoteStore:(QuoteStore *)store sourceStamp:(uint64_t)sourceStamp toURL:(NSURL *)url {
+    if (store.rowCount > UINT32_MAX) {
+        return NO;
+    }
+    uint32_t rowCount = (uint32_t)store.rowCount;
+    QuoteStoreColumns storeColumns = [store columns];
+
+    QuoteSnapshotHeader header = { { 0 }, kQuoteSnapshotVersion, QuoteFieldCount, rowCount, 0, QuoteSchemaHash(), sourceStamp, 0, 0 };
+    memcpy(header.magic, kQuoteSnapshotMagic, sizeof(header.magic));
+    QuoteSnapshotColumn columns[QuoteFieldCount];
+
+    NSMutableData *out = [NSMutableData dataWithLength:sizeof(header) + sizeof(columns)];
+    NSMutableData *heap = [NSMutableData data];
+    uint32_t bases[QuoteFieldCount];
+
+    for (QuoteField field = 0; field < QuoteFieldCount; field++) {
+        QuoteSnapshotPad(out);
+        columns[field].type = QuoteFieldTypeOf(field);
+        columns[field].reserved = 0;
+        columns[field].offset = out.length;
+
+        if (columns[field].type == QuoteFieldTypeDouble) {
+            [out appendBytes:storeColumns.doubles[field] length:rowCount * sizeof(double)];
+            continue;
+        }
+        if (columns[field].type == QuoteFieldTypeFixed) {
+            [out appendBytes:storeColumns.fixed[field] length:rowCount * sizeof(int64_t)];
+            continue;
+        }
+
+        const QuoteStringTable *table = storeColumns.tables[field];
+        uint32_t stringCount = QuoteStringTableCount(table);
+        QuoteField owner = QuoteFieldStringTableOwner(field);
+        if (owner == field) {
+            if (heap.length + table->heapLength > UINT32_MAX) {
+                return NO;
+            }
+            bases[field] = (uint32_t)heap.length;
+            [heap appendBytes:table->heap length:table->heapLength];
+        }
+        [out appendBytes:&stringCount length:sizeof(stringCount)];
+        [out appendBytes:storeColumns.codes[field] length:rowCount * sizeof(uint32_t)];
+        for (uint32_t i = 0; i <= stringCount; i++) {
+            uint32_t offset = bases[owner] + table->offsets[i];
+            [out appendBytes:&offset length:sizeof(offset)];
+        }
+    }
+
+    QuoteSnapshotPad(out);
+    header.heapOffset = out.length;
+    header.heapLength = heap.length;
+    [out appendData:heap];
+
+    [out replaceBytesInRange:NSMakeRange(0, sizeof(header)) withBytes:&header];
+    [out replaceBytesInRange:NSMakeRange(sizeof(header), sizeof(columns)) withBytes:columns];
+    return [out writeToURL:url atomically:YES];
+}
+
++ (uint64_t)sourceStampForURL:(NSURL *)url {
+    NSDictionary *attributes = [[NSFileManager defaultManager] attributesOfItemAtPath:url.path error:NULL];
+    uint64_t size = [attributes fileSize];
+    uint64_t modified = (uint64_t)([attributes fileModificationDate].timeIntervalSinceReferenceDate * 1e6);
+    return (size * 0x9E3779B97F4A7C15ULL) ^ modified;
+}
+
+- (const double *)doubleColumn:(QuoteField)field {
+    if (QuoteFieldTypeOf(field) != QuoteFieldTypeDouble) {
+        return NULL;
+    }
+    return (const double *)((const char *)self.data.bytes + _columns[field].offset);
+}
+
+- (const int64_t *)fixedColumn:(QuoteField)field {
+    if (QuoteFieldTypeOf(field) != QuoteFieldTypeFixed) {
+        return NULL;
+    }
+    return (const int64_t *)((const char *)self.data.bytes + _columns[field].offset);
+}
+
+- (NSString *)stringForField:(QuoteField)field row:(NSUInteger)row {
+    if (QuoteFieldTypeOf(field) != QuoteFieldTypeString || row >= _rowCount) {
+        return nil;
+    }
+    QuoteSnapshotStrings strings = QuoteSnapshotStringsAt((const char *)self.data.bytes + _columns[field].offset, _rowCount);
+    uint32_t code = strings.codes[row];
+    if (code == 0 || code > strings.stringCount) {
+        return nil;
+    }
+    uint32_t start = strings.offsets[code - 1];
+    return [[NSString alloc] initWithBytes:_heap + start length:strings.offsets[code] - start encoding:NSUTF8StringEncoding];
+}
+
+- (QuoteStore *)quoteStore {
+    QuoteStore *store = [[QuoteStore alloc] init];
+    [store appendRows:_rowCount];
+    QuoteStoreColumns storeColumns = [store columns];
+
+    for (QuoteField field = 0; field < QuoteFieldCount; field++) {
+        const char *block = (const char *)self.data.bytes + _columns[field].offset;
+        if (QuoteFieldTypeOf(field) == QuoteFieldTypeDouble) {
+            memcpy(storeColumns.doubles[field], block, _rowCount * sizeof(double));
+            continue;
+        }
+        if (QuoteFieldTypeOf(field) == QuoteFieldTypeFixed) {
+            memcpy(storeColumns.fixed[field], block, _rowCount * sizeof(int64_t));
+            continue;
+        }
+        QuoteSnapshotStrings strings = QuoteSnapshotStringsAt(block, _rowCount);
+        if (!QuoteSnapshotCopyCodes(storeColumns.codes[field], strings, _rowCount)) {
+            return nil;
+        }
+        if (QuoteFieldStringTableOwner(field) == field
+            && !QuoteStringTableAppendStrings(storeColumns.tables[field], _heap, strings.offsets, strings.stringCount)) {
+            return nil;
+        }
+    }
+    [store optionContracts];
+    return store;
+}
+
+- (NSArray *)quoteItems {
+    return [[self quoteStore] items];
+}
+
+@end
@@ -0,0 +1,62 @@
+//
+//  QuoteSortCache.h
+//  dgpoc
+//
+//  Sorted permutations of every row of a store, kept by sort spec so going
+//  back to a sort already seen costs one pass over the rows instead of a
+//  sort. Each permutation is stamped with the store's version of the fields
+//  its descriptors read (QuoteStore versionOfFields:) and is dropped once any
+//  of them changes; ticks to other fields leave it usable.
+//
+//  A spec whose every key is the reverse of a cached one is served from it
+//  in O(n) (QuoteSortEngine reversePermutation:), so flipping a column's
+//  direction never sorts. Past the byte budget the least recently used
+//  permutations go first, though the newest is kept whatever its size.
+//
+
+#import <Foundation/Foundation.h>
+#import "QuoteSortEngine.h"
+
+@interface QuoteSortCache : NSObject
+
+@property (nonatomic, readonly) QuoteSortEngine *engine;
+@property (nonatomic, readonly) NSUInteger byteBudget;
+/// Bytes of permutations held; after every call at most byteBudget, or the
+/// most recent permutation alone when that one is larger.
+@property (nonatomic, readonly) NSUInteger byteCount;
+@property (nonatomic, readonly) NSUInteger permutationCount;
+
+/// Lookups answered from a permutation as it was, from one reversed, and
+/// by sorting; permutations evicted for the budget.
+@property (nonatomic, readonly) NSUInteger hitCount;
+@property (nonatomic, readonly) NSUInteger reversalCount;
+@property (nonatomic, readonly) NSUInteger missCount;
+@property (nonatomic, readonly) NSUInteger evictionCount;
+
+- (instancetype)initWithEngine:(QuoteSortEngine *)engine byteBudget:(NSUInteger)byteBudget NS_DESIGNATED_INITIALIZER;
+- (instancetype)init NS_UNAVAILABLE;
+
+/// Every row id of the store sorted by descriptors, which the engine must be
+/// able to sort by; cached, reversed or sorted and cached, in that order of
+/// preference.
+- (NSData *)permutationForDescriptors:(NSArray *)descriptors;
+
+/// The same without sorting: nil when neither descriptors nor their reverse
+/// is cached. Only a sort counts as a miss.
+- (NSData *)cachedPermutationForDescriptors:(NSArray *)descriptors;
+
+/// YES when descriptors or their reverse is cached, without reversing it or
+/// counting a lookup.
+- (BOOL)hasPermutationForDescriptors:(NSArray *)descriptors;
+
+/// Counts a miss for a sort of every row done elsewhere because nothing
+/// was cached, such as one on a background queue.
+- (void)countMiss;
+
+/// Keeps a permutation sorted elsewhere, such as a QuoteSortOrder of every
+/// row that updates kept current. It must be in order as the store is now.
+- (void)storePermutation:(NSData *)permutation forDescriptors:(NSArray *)descriptors;
+
+- (void)removeAllPermutations;
+
+@end
@@ -0,0 +1,134 @@
+#import "QuoteSortCache.h"
+
+@interface QuoteSortCacheEntry : NSObject
+
+@property (nonatomic, copy) NSArray *descriptors;
+@property (nonatomic, strong) NSData *permutation;
+@property (nonatomic) QuoteFieldMask fields;
+@property (nonatomic) uint64_t version;
+
+@end
+
+@implementation QuoteSortCacheEntry
+
+@end
+
+@implementation QuoteSortCache {
+    NSMutableArray *_entries;   // least recently used first
+}
+
+- (instancetype)initWithEngine:(QuoteSortEngine *)engine byteBudget:(NSUInteger)byteBudget {
+    NSParameterAssert(engine);
+    self = [super init];
+    if (self) {
+        _engine = engine;
+        _byteBudget = byteBudget;
+        _entries = [NSMutableArray array];
+    }
+    return self;
+}
+
+- (NSUInteger)permutationCount {
+    return _entries.count;
+}
+
+- (NSData *)permutationForDescriptors:(NSArray *)descriptors {
+    NSData *permutation = [self cachedPermutationForDescriptors:descriptors];
+    if (!permutation) {
+        _missCount++;
+        permutation = [_engine permutationForDescriptors:descriptors];
+        [self storePermutation:permutation forDescriptors:descriptors];
+    }
+    return permutation;
+}
+
+- (NSData *)cachedPermutationForDescriptors:(NSArray *)descriptors {
+    [self removeStaleEntries];
+
+    QuoteSortCacheEntry *entry = [self entryForDescriptors:descriptors];
+    if (entry) {
+        _hitCount++;
+        [_entries removeObjectIdenticalTo:entry];
+        [_entries addObject:entry];
+        return entry.permutation;
+    }
+
+    QuoteSortCacheEntry *reversed = [self entryForDescriptors:[descriptors valueForKey:@"reversedSortDescriptor"]];
+    if (!reversed) {
+        return nil;
+    }
+    _reversalCount++;
+    NSData *permutation = [_engine reversePermutation:reversed.permutation toDescriptors:descriptors];
+    [self storePermutation:permutation forDescriptors:descriptors];
+    return permutation;
+}
+
+- (BOOL)hasPermutationForDescriptors:(NSArray *)descriptors {
+    [self removeStaleEntries];
+    return [self entryForDescriptors:descriptors]
+        || [self entryForDescriptors:[descriptors valueForKey:@"reversedSortDescriptor"]];
+}
+
+- (void)countMiss {
+    _missCount++;
+}
+
+- (void)storePermutation:(NSData *)permutation forDescriptors:(NSArray *)descriptors {
+    NSParameterAssert(permutation.length == _engine.store.rowCount * sizeof(uint32_t));
+    QuoteSortCacheEntry *existing = [self entryForDescriptors:descriptors];
+    if (existing) {
+        [self removeEntry:existing];
+    }
+
+    QuoteSortCacheEntry *entry = [[QuoteSortCacheEntry alloc] init];
+    entry.descriptors = descriptors;
+    entry.permutation = permutation;
+    for (NSSortDescriptor *descriptor in descriptors) {
+        entry.fields |= QuoteFieldMaskForKey(descriptor.key);
+    }
+    entry.version = [_engine.store versionOfFields:entry.fields];
+    [_entries addObject:entry];
+    _byteCount += permutation.length;
+
+    // the permutation just stored stays even past the budget; a store too
+    // big for any would otherwise miss on every sort
+    while (_byteCount > _byteBudget && _entries.count > 1) {
+        _evictionCount++;
+        [self removeEntry:_entries.firstObject];
+    }
+}
+
+- (void)removeAllPermutations {
+    [_entries removeAllObjects];
+    _byteCount = 0;
+}
+
+#pragma mark - Private
+
+- (QuoteSortCacheEntry *)entryForDescriptors:(NSArray *)descriptors {
+    for (QuoteSortCacheEntry *entry in _entries) {
+        if ([entry.descriptors isEqualToArray:descriptors]) {
+            return entry;
+        }
+    }
+    return nil;
+}
+
+- (void)removeEntry:(QuoteSortCacheEntry *)entry {
+    _byteCount -= entry.permutation.length;
+    [_entries removeObjectIdenticalTo:entry];
+}
+
+// Appending rows changes every field's version; the length check covers
+// the empty spec, which reads no field.
+- (void)removeStaleEntries {
+    QuoteStore *store = _engine.store;
+    for (QuoteSortCacheEntry *entry in [_entries copy]) {
+        if (entry.version != [store versionOfFields:entry.fields]
+            || entry.permutation.length != store.rowCount * sizeof(uint32_t)) {
+            [self removeEntry:entry];
+        }
+    }
+}
+
+@end
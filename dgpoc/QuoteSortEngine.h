@@ -0,0 +1,111 @@
+//
+//  QuoteSortEngine.h
+//  dgpoc
+//
+//  Sorts the rows of a QuoteStore by NSSortDescriptors without KVC. Each
+//  descriptor's key is resolved once per sort to the column behind it and
+//  every row's value is turned into an unsigned 128-bit key that orders the
+//  way compare: would:
+//
+//      fixed       int64 ticks, sign bit flipped; missing first
+//      double      IEEE bits made monotonic; NaN (missing) first
+//      string      the code's rank in the table (QuoteStore stringRanks)
+//      symbolSort  the packed QuoteSortKey of symbolSortAscending/Descending
+//
+//  Descending keys are complemented. The descriptors compile to a chain of
+//  typed columns, one per key plus the row id as the last tiebreaker, so
+//  every sort of the same rows gives the same order whatever order they came
+//  in. Rows are ordered by the first key, then each run of equal rows by the
+//  next key, so later keys only cost anything where earlier keys tie. Each
+//  of those sorts is a radix sort over the key bytes once it is long enough
+//  to pay for one, else a merge sort, and from a few hundred thousand rows
+//  it is spread over workerCount threads (QuoteKeySort.h). The result is
+//  the same whichever sort runs.
+//
+
+#import <Foundation/Foundation.h>
+#import "QuoteStore.h"
+
+@interface QuoteSortEngine : NSObject
+
+@property (nonatomic, readonly) QuoteStore *store;
+/// Threads a large sort may use; the active processor count unless set.
+/// 1 keeps every sort on the calling thread.
+@property (nonatomic) NSUInteger workerCount;
+
+- (instancetype)initWithStore:(QuoteStore *)store NS_DESIGNATED_INITIALIZER;
+- (instancetype)init NS_UNAVAILABLE;
+
+/// YES when every descriptor names a store field or a symbol sort key and
+/// compares with compare:, or with caseInsensitiveCompare: on a string field.
+- (BOOL)canSortUsingDescriptors:(NSArray *)descriptors;
+
+/// Reorders count row ids of the store in place. With no descriptors the
+/// rows are put in id order.
+- (void)sortRows:(uint32_t *)rows count:(NSUInteger)count usingDescriptors:(NSArray *)descriptors;
+
+/// Grows the sorted head of rows, whose first sortedCount rows are each in
+/// their sorted place, to at least targetCount rows and returns its new
+/// length. The rows past it are left in no order. Costs about a pass over
+/// the unsorted rows plus a sort of the ones taken.
+- (NSUInteger)sortRows:(uint32_t *)rows count:(NSUInteger)count sortedCount:(NSUInteger)sortedCount
+               toCount:(NSUInteger)targetCount usingDescriptors:(NSArray *)descriptors;
+
+/// Keeps the sorted head of rows, as sortRows:...toCount: leaves it, after
+/// changedRows changed and returns its new length. Changed rows in the head
+/// are put back in place, or moved past it when they now sort after every
+/// row left in it; a changed row past the head that now sorts before its
+/// last row cuts the head off where it would go. Each changed row must be
+/// one of the count rows. Costs a lookup among the changed rows per head
+/// row and a few compares per changed row.
+- (NSUInteger)updateSortedRows:(uint32_t *)rows count:(NSUInteger)count sortedCount:(NSUInteger)sortedCount
+                   changedRows:(const uint32_t *)changedRows count:(NSUInteger)changedCount
+              usingDescriptors:(NSArray *)descriptors;
+
+/// items, which must be QuoteItems of the store, in sorted order.
+- (NSArray *)sortedItems:(NSArray *)items usingDescriptors:(NSArray *)descriptors;
+
+/// Every row id of the store, sorted, as uint32s.
+- (NSData *)permutationForDescriptors:(NSArray *)descriptors;
+/// The same, or nil once isCancelled returns YES; it is asked between the
+/// sort's passes, so a sort no longer wanted stops after the one under way.
+- (NSData *)permutationForDescriptors:(NSArray *)descriptors cancelled:(BOOL (^)(void))isCancelled;
+
+/// A permutation sorted by the reverse of descriptors turned into one sorted
+/// by descriptors in O(n): reversed, with each run of tied rows put back in
+/// row id order.
+- (NSData *)reversePermutation:(NSData *)permutation toDescriptors:(NSArray *)descriptors;
+
+@end
+
+/// Rows of a store held in the order of a fixed list of descriptors. Sorted
+/// in full once; after that only rows whose sort values changed are moved, so
+/// a tick touching k of n rows costs about k log n compares instead of a
+/// sort. A new sort spec is a new order.
+@interface QuoteSortOrder : NSObject
+
+/// Sorts items, which must be QuoteItems of the engine's store.
+- (instancetype)initWithEngine:(QuoteSortEngine *)engine items:(NSArray *)items descriptors:(NSArray *)descriptors;
+/// Orders items as they appear in permutation, the store's every row already
+/// sorted by descriptors, in one pass instead of a sort.
+- (instancetype)initWithEngine:(QuoteSortEngine *)engine items:(NSArray *)items descriptors:(NSArray *)descriptors
+                   permutation:(NSData *)permutation NS_DESIGNATED_INITIALIZER;
+- (instancetype)init NS_UNAVAILABLE;
+
+@property (nonatomic, readonly) NSArray *descriptors;
+@property (nonatomic, readonly) NSUInteger count;
+/// Row ids in sorted order; valid until the next update.
+@property (nonatomic, readonly) const uint32_t *rows;
+/// The items in sorted order, as a view that follows later updates.
+@property (nonatomic, readonly) NSArray *items;
+/// YES while no field the descriptors read has changed since the order was
+/// last put right, by sorting or by updateRows:.
+@property (nonatomic, readonly, getter=isCurrent) BOOL current;
+
+/// Puts rows whose fields changed back in order. Nothing moves unless fields
+/// include one the descriptors read; rows not in the order are ignored, and
+/// past an eighth of the rows it sorts again in full. Every row changed since
+/// the last update must be passed.
+- (void)updateRows:(const uint32_t *)rows count:(NSUInteger)count changedFields:(QuoteFieldMask)fields;
+
+@end
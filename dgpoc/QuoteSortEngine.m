@@ -0,0 +1,744 @@
+#import "QuoteSortEngine.h"
+#import "QuoteItem.h"
+#import "QuoteKeySort.h"
+
+static NSString * const kQuoteSortSymbolAscendingKey = @"symbolSortAscending";
+static NSString * const kQuoteSortSymbolDescendingKey = @"symbolSortDescending";
+
+typedef enum {
+    QuoteSortColumnTypeFixed,
+    QuoteSortColumnTypeDouble,
+    QuoteSortColumnTypeRank,
+    QuoteSortColumnTypeSymbolKey,
+    QuoteSortColumnTypeRow,
+} QuoteSortColumnType;
+
+// A descriptor resolved to the raw column its key reads; a sort compiles
+// its descriptors to a chain of these ending in the row id.
+typedef struct {
+    QuoteSortColumnType type;
+    const int64_t *fixed;
+    const double *doubles;
+    const uint32_t *codes;
+    const uint32_t *ranks;          // by code
+    const QuoteSortKey *symbolKeys;
+    bool descending;
+} QuoteSortColumn;
+
+static inline void QuoteSortEntryLoad(const QuoteSortColumn *column, uint32_t row, QuoteSortEntry *entry) {
+    uint64_t hi = 0, lo = 0;
+    switch (column->type) {
+        case QuoteSortColumnTypeFixed:
+            hi = QuoteSortBitsOfFixed(column->fixed[row]);
+            break;
+        case QuoteSortColumnTypeDouble:
+            hi = QuoteSortBitsOfDouble(column->doubles[row]);
+            break;
+        case QuoteSortColumnTypeRank:
+            hi = column->ranks[column->codes[row]];
+            break;
+        case QuoteSortColumnTypeSymbolKey:
+            hi = column->symbolKeys[row].hi;
+            lo = column->symbolKeys[row].lo;
+            break;
+        case QuoteSortColumnTypeRow:
+            hi = row;
+            break;
+    }
+    if (column->descending) {
+        hi = ~hi;
+        lo = ~lo;
+    }
+    entry->hi = hi;
+    entry->lo = lo;
+}
+
+// Packed symbol keys use both words; every other column only hi.
+static inline size_t QuoteSortColumnKeyBytes(const QuoteSortColumn *column) {
+    return column->type == QuoteSortColumnTypeSymbolKey ? 16 : 8;
+}
+
+// Orders entries, one per row, by every column: the first over all rows,
+// each later one only within runs the columns before it left tied. Returns
+// false, the entries in no order, once isCancelled (which may be nil) says
+// so between passes.
+static bool QuoteSortEntriesByColumns(const QuoteSortColumn *columns, size_t columnCount, const uint32_t *rows,
+                                      QuoteSortEntry *entries, QuoteSortEntry *scratch, uint8_t *runStarts,
+                                      size_t count, size_t workerCount, BOOL (^isCancelled)(void)) {
+    for (size_t i = 0; i < count; i++) {
+        entries[i].index = (uint32_t)i;
+        QuoteSortEntryLoad(&columns[0], rows[i], &entries[i]);
+    }
+    if (isCancelled && isCancelled()) {
+        return false;
+    }
+    QuoteSortEntries(entries, scratch, count, QuoteSortColumnKeyBytes(&columns[0]), workerCount);
+    if (columnCount == 1 || count < 2) {
+        return true;
+    }
+
+    bool tied = false;
+    runStarts[0] = 1;
+    for (size_t i = 1; i < count; i++) {
+        runStarts[i] = !QuoteSortEntryEqual(&entries[i - 1], &entries[i]);
+        tied |= !runStarts[i];
+    }
+    for (size_t c = 1; c < columnCount && tied; c++) {
+        if (isCancelled && isCancelled()) {
+            return false;
+        }
+        tied = false;
+        for (size_t begin = 0; begin < count; ) {
+            size_t end = begin + 1;
+            while (end < count && !runStarts[end]) {
+                end++;
+            }
+            if (end - begin > 1) {
+                for (size_t i = begin; i < end; i++) {
+                    QuoteSortEntryLoad(&columns[c], rows[entries[i].index], &entries[i]);
+                }
+                QuoteSortEntries(entries + begin, scratch, end - begin, QuoteSortColumnKeyBytes(&columns[c]),
+                                 workerCount);
+                for (size_t i = begin + 1; i < end; i++) {
+                    runStarts[i] = !QuoteSortEntryEqual(&entries[i - 1], &entries[i]);
+                    tied |= !runStarts[i];
+                }
+            }
+            begin = end;
+        }
+    }
+}
+
+// -1 or 1 as row a sorts before or after row b; 0 only for the same row.
+static int QuoteSortChainCompare(const QuoteSortColumn *chain, size_t length, uint32_t a, uint32_t b) {
+    for (size_t c = 0; c < length; c++) {
+        QuoteSortEntry entryA, entryB;
+        QuoteSortEntryLoad(&chain[c], a, &entryA);
+        QuoteSortEntryLoad(&chain[c], b, &entryB);
+        if (!QuoteSortEntryEqual(&entryA, &entryB)) {
+            return QuoteSortEntryLess(&entryA, &entryB) ? -1 : 1;
+        }
+    }
+    return 0;
+}
+
+static int QuoteSortCompareRowIds(const void *a, const void *b) {
+    uint32_t rowA = *(const uint32_t *)a, rowB = *(const uint32_t *)b;
+    return rowA < rowB ? -1 : rowA > rowB;
+}
+
+#pragma mark -
+
+@interface QuoteSortEngine ()
+
+- (QuoteSortColumn *)compileDescriptors:(NSArray *)descriptors length:(size_t *)length;
+
+@end
+
+@implementation QuoteSortEngine
+
+- (instancetype)initWithStore:(QuoteStore *)store {
+    NSParameterAssert(store);
+    self = [super init];
+    if (self) {
+        _store = store;
+        _workerCount = [NSProcessInfo processInfo].activeProcessorCount;
+    }
+    return self;
+}
+
+// Resolves a descriptor, or with column NULL only checks that it can be.
+- (BOOL)resolveDescriptor:(NSSortDescriptor *)descriptor column:(QuoteSortColumn *)column {
+    SEL selector = descriptor.selector;
+    BOOL caseInsensitive = selector == @selector(caseInsensitiveCompare:);
+    if (!caseInsensitive && selector != @selector(compare:)) {
+        return NO;
+    }
+    NSString *key = descriptor.key;
+    BOOL symbolAscending = [key isEqualToString:kQuoteSortSymbolAscendingKey];
+    if (symbolAscending || [key isEqualToString:kQuoteSortSymbolDescendingKey]) {
+        // lowercase hex, so case never matters
+        if (column) {
+            column->type = QuoteSortColumnTypeSymbolKey;
+            column->symbolKeys = [_store symbolSortKeysAscending:symbolAscending];
+        }
+    } else {
+        QuoteField field = QuoteFieldForKey(key);
+        if (field == QuoteFieldCount) {
+            return NO;
+        }
+        QuoteFieldType type = QuoteFieldTypeOf(field);
+        if (caseInsensitive && type != QuoteFieldTypeString) {
+            return NO;
+        }
+        if (column) {
+            switch (type) {
+                case QuoteFieldTypeFixed:
+                    column->type = QuoteSortColumnTypeFixed;
+                    column->fixed = [_store fixedColumn:field];
+                    break;
+                case QuoteFieldTypeDouble:
+                    column->type = QuoteSortColumnTypeDouble;
+                    column->doubles = [_store doubleColumn:field];
+                    break;
+                case QuoteFieldTypeString:
+                    column->type = QuoteSortColumnTypeRank;
+                    column->codes = [_store codeColumn:field];
+                    column->ranks = [_store stringRanksForField:field caseInsensitive:caseInsensitive];
+                    break;
+            }
+        }
+    }
+    if (column) {
+        column->descending = !descriptor.ascending;
+    }
+    return YES;
+}
+
+- (BOOL)canSortUsingDescriptors:(NSArray *)descriptors {
+    for (NSSortDescriptor *descriptor in descriptors) {
+        if (![self resolveDescriptor:descriptor column:NULL]) {
+            return NO;
+        }
+    }
+    return YES;
+}
+
+// The descriptors as a chain of columns ending in the row id, written to
+// *length. Valid until the store changes shape; the caller frees it.
+- (QuoteSortColumn *)compileDescriptors:(NSArray *)descriptors length:(size_t *)length {
+    NSUInteger columnCount = descriptors.count;
+    QuoteSortColumn *columns = calloc(columnCount + 1, sizeof(QuoteSortColumn));
+    if (!columns) {
+        [NSException raise:NSMallocException format:@"QuoteSortEngine cannot compile %@", descriptors];
+    }
+    for (NSUInteger c = 0; c < columnCount; c++) {
+        if (![self resolveDescriptor:descriptors[c] column:&columns[c]]) {
+            free(columns);
+            [NSException raise:NSInvalidArgumentException format:@"QuoteSortEngine cannot sort by %@", descriptors[c]];
+        }
+    }
+    columns[columnCount].type = QuoteSortColumnTypeRow;
+    *length = columnCount + 1;
+    return columns;
+}
+
+// Sorted entries for count rows, or NULL when there is nothing to order or
+// isCancelled, which may be nil, stopped the sort. Rows equal on every
+// descriptor are ordered by row id. The caller frees the result.
+- (QuoteSortEntry *)sortedEntriesForRows:(const uint32_t *)rows count:(NSUInteger)count
+                             descriptors:(NSArray *)descriptors cancelled:(BOOL (^)(void))isCancelled {
+    if (count < 2) {
+        return NULL;
+    }
+    if (count > UINT32_MAX) {
+        [NSException raise:NSInvalidArgumentException format:@"QuoteSortEngine cannot sort %lu rows",
+         (unsigned long)count];
+    }
+    size_t length;
+    QuoteSortColumn *columns = [self compileDescriptors:descriptors length:&length];
+    QuoteSortEntry *entries = malloc(2 * count * sizeof(QuoteSortEntry));
+    uint8_t *runStarts = malloc(count);
+    if (!entries || !runStarts) {
+        free(columns);
+        free(entries);
+        free(runStarts);
+        [NSException raise:NSMallocException format:@"QuoteSortEngine cannot sort %lu rows", (unsigned long)count];
+    }
+    bool sorted = QuoteSortEntriesByColumns(columns, length, rows, entries, entries + count, runStarts, count,
+                                            _workerCount, isCancelled);
+    free(columns);
+    free(runStarts);
+    if (!sorted) {
+        free(entries);
+        return NULL;
+    }
+    return entries;
+}
+
+- (void)sortRows:(uint32_t *)rows count:(NSUInteger)count usingDescriptors:(NSArray *)descriptors {
+    [self sortRows:rows count:count usingDescriptors:descriptors cancelled:nil];
+}
+
+// NO, the rows left as they were, when isCancelled stopped the sort.
+- (BOOL)sortRows:(uint32_t *)rows count:(NSUInteger)count usingDescriptors:(NSArray *)descriptors
+       cancelled:(BOOL (^)(void))isCancelled {
+    QuoteSortEntry *entries = [self sortedEntriesForRows:rows count:count descriptors:descriptors
+                                               cancelled:isCancelled];
+    if (!entries) {
+        return !(isCancelled && isCancelled());
+    }
+    // the scratch half is free again
+    uint32_t *sorted = (uint32_t *)(entries + count);
+    for (NSUInteger i = 0; i < count; i++) {
+        sorted[i] = rows[entries[i].index];
+    }
+    memcpy(rows, sorted, count * sizeof(uint32_t));
+    free(entries);
+    return YES;
+}
+
+- (NSUInteger)sortRows:(uint32_t *)rows count:(NSUInteger)count sortedCount:(NSUInteger)sortedCount
+               toCount:(NSUInteger)targetCount usingDescriptors:(NSArray *)descriptors {
+    if (sortedCount >= targetCount || sortedCount >= count) {
+        return sortedCount;
+    }
+    uint32_t *rest = rows + sortedCount;
+    NSUInteger restCount = count - sortedCount;
+    NSUInteger wanted = targetCount - sortedCount;
+    // past half the rest, selecting first saves little
+    if (wanted >= restCount / 2) {
+        [self sortRows:rest count:restCount usingDescriptors:descriptors];
+        return count;
+    }
+
+    size_t length;
+    QuoteSortColumn *chain = [self compileDescriptors:descriptors length:&length];
+    QuoteSortEntry *entries = malloc(restCount * sizeof(QuoteSortEntry));
+    uint32_t *selected = malloc(restCount * sizeof(uint32_t));
+    if (!entries || !selected) {
+        free(chain);
+        free(entries);
+        free(selected);
+        [NSException raise:NSMallocException format:@"QuoteSortEngine cannot select from %lu rows",
+         (unsigned long)restCount];
+    }
+    for (NSUInteger i = 0; i < restCount; i++) {
+        entries[i].index = rest[i];
+        QuoteSortEntryLoad(&chain[0], rest[i], &entries[i]);
+    }
+    free(chain);
+
+    // rows tied with the last one wanted on the first key are taken too;
+    // the later keys decide between them
+    size_t equalStart, equalEnd;
+    QuoteSortEntriesSelect(entries, restCount, wanted - 1, &equalStart, &equalEnd);
+    for (NSUInteger i = 0; i < restCount; i++) {
+        selected[i] = entries[i].index;
+    }
+    free(entries);
+    [self sortRows:selected count:equalEnd usingDescriptors:descriptors];
+    memcpy(rest, selected, restCount * sizeof(uint32_t));
+    free(selected);
+    return sortedCount + equalEnd;
+}
+
+- (NSUInteger)updateSortedRows:(uint32_t *)rows count:(NSUInteger)count sortedCount:(NSUInteger)sortedCount
+                   changedRows:(const uint32_t *)changedRows count:(NSUInteger)changedCount
+              usingDescriptors:(NSArray *)descriptors {
+    sortedCount = MIN(sortedCount, count);
+    if (sortedCount == 0 || changedCount == 0) {
+        return sortedCount;
+    }
+    uint32_t *changed = malloc(changedCount * sizeof(uint32_t));
+    uint32_t *moving = malloc(MIN(changedCount, sortedCount) * sizeof(uint32_t));
+    uint8_t *inHead = calloc(changedCount, 1);
+    if (!changed || !moving || !inHead) {
+        free(changed);
+        free(moving);
+        free(inHead);
+        [NSException raise:NSMallocException format:@"QuoteSortEngine cannot update %lu rows",
+         (unsigned long)changedCount];
+    }
+    memcpy(changed, changedRows, changedCount * sizeof(uint32_t));
+    qsort(changed, changedCount, sizeof(uint32_t), QuoteSortCompareRowIds);
+    NSUInteger unique = 1;
+    for (NSUInteger i = 1; i < changedCount; i++) {
+        if (changed[i] != changed[unique - 1]) {
+            changed[unique++] = changed[i];
+        }
+    }
+    changedCount = unique;
+
+    // the changed rows come out of the head; the last row left in it is the
+    // boundary every row past the head still sorts after
+    NSUInteger kept = 0, movingCount = 0;
+    for (NSUInteger i = 0; i < sortedCount; i++) {
+        uint32_t row = rows[i];
+        uint32_t *found = bsearch(&row, changed, changedCount, sizeof(uint32_t), QuoteSortCompareRowIds);
+        if (found) {
+            inHead[found - changed] = 1;
+            moving[movingCount++] = row;
+        } else {
+            rows[kept++] = row;
+        }
+    }
+    memcpy(rows + kept, moving, movingCount * sizeof(uint32_t));
+    if (kept == 0) {
+        free(changed);
+        free(moving);
+        free(inHead);
+        return 0;
+    }
+    size_t length;
+    QuoteSortColumn *chain = [self compileDescriptors:descriptors length:&length];
+    uint32_t boundary = rows[kept - 1];
+
+    // a changed row still before the boundary is merged back in from the end;
+    // one now after it joins the rows past the head, which it sorts before
+    // none of
+    qsort_b(moving, movingCount, sizeof(uint32_t), ^int(const void *a, const void *b) {
+        return QuoteSortChainCompare(chain, length, *(const uint32_t *)a, *(const uint32_t *)b);
+    });
+    NSUInteger staying = 0;
+    while (staying < movingCount && QuoteSortChainCompare(chain, length, moving[staying], boundary) < 0) {
+        staying++;
+    }
+    memcpy(rows + kept + staying, moving + staying, (movingCount - staying) * sizeof(uint32_t));
+    NSUInteger end = kept + staying;
+    for (NSUInteger m = staying; m-- > 0; ) {
+        uint32_t row = moving[m];
+        while (kept > 0 && QuoteSortChainCompare(chain, length, rows[kept - 1], row) > 0) {
+            rows[--end] = rows[--kept];
+        }
+        rows[--end] = row;
+    }
+    NSUInteger headCount = sortedCount - movingCount + staying;
+
+    // a row past the head that now sorts before the boundary belongs in it;
+    // the head ends where the first of them would go
+    for (NSUInteger i = 0; i < changedCount; i++) {
+        if (inHead[i]) {
+            continue;
+        }
+        uint32_t row = changed[i];
+        if (headCount > 0 && QuoteSortChainCompare(chain, length, row, rows[headCount - 1]) < 0) {
+            NSUInteger low = 0, high = headCount;
+            while (low < high) {
+                NSUInteger middle = low + (high - low) / 2;
+                if (QuoteSortChainCompare(chain, length, rows[middle], row) < 0) {
+                    low = middle + 1;
+                } else {
+                    high = middle;
+                }
+            }
+            headCount = low;
+        }
+    }
+    free(chain);
+    free(changed);
+    free(moving);
+    free(inHead);
+    return headCount;
+}
+
+- (NSArray *)sortedItems:(NSArray *)items usingDescriptors:(NSArray *)descriptors {
+    NSUInteger count = items.count;
+    if (count < 2) {
+        return [items copy];
+    }
+    uint32_t *rows = malloc(count * sizeof(uint32_t));
+    __unsafe_unretained id *objects = (__unsafe_unretained id *)malloc(2 * count * sizeof(id));
+    if (!rows || !objects) {
+        free(rows);
+        free(objects);
+        [NSException raise:NSMallocException format:@"QuoteSortEngine cannot sort %lu items", (unsigned long)count];
+    }
+    [items getObjects:objects range:NSMakeRange(0, count)];
+    for (NSUInteger i = 0; i < count; i++) {
+        QuoteItem *item = objects[i];
+        if (item.store != _store) {
+            free(rows);
+            free(objects);
+            [NSException raise:NSInvalidArgumentException format:@"%@ is not a row of the sorted store", item];
+        }
+        rows[i] = (uint32_t)item.row;
+    }
+
+    QuoteSortEntry *entries = [self sortedEntriesForRows:rows count:count descriptors:descriptors cancelled:nil];
+    __unsafe_unretained id *sorted = objects + count;
+    for (NSUInteger i = 0; i < count; i++) {
+        sorted[i] = objects[entries[i].index];
+    }
+    NSArray *result = [NSArray arrayWithObjects:sorted count:count];
+    free(entries);
+    free(rows);
+    free(objects);
+    return result;
+}
+
+- (NSData *)permutationForDescriptors:(NSArray *)descriptors {
+    return [self permutationForDescriptors:descriptors cancelled:nil];
+}
+
+- (NSData *)permutationForDescriptors:(NSArray *)descriptors cancelled:(BOOL (^)(void))isCancelled {
+    NSUInteger count = _store.rowCount;
+    NSMutableData *permutation = [NSMutableData dataWithLength:count * sizeof(uint32_t)];
+    uint32_t *rows = permutation.mutableBytes;
+    for (NSUInteger row = 0; row < count; row++) {
+        rows[row] = (uint32_t)row;
+    }
+    return [self sortRows:rows count:count usingDescriptors:descriptors cancelled:isCancelled] ? permutation : nil;
+}
+
+- (NSData *)reversePermutation:(NSData *)permutation toDescriptors:(NSArray *)descriptors {
+    NSUInteger count = permutation.length / sizeof(uint32_t);
+    NSMutableData *reversed = [NSMutableData dataWithLength:permutation.length];
+    const uint32_t *rows = permutation.bytes;
+    uint32_t *reversedRows = reversed.mutableBytes;
+    for (NSUInteger i = 0; i < count; i++) {
+        reversedRows[i] = rows[count - 1 - i];
+    }
+
+    // reversing turned each run of tied rows into descending row ids
+    size_t length;
+    QuoteSortColumn *chain = [self compileDescriptors:descriptors length:&length];
+    for (NSUInteger begin = 0; begin < count; ) {
+        NSUInteger end = begin + 1;
+        while (end < count && QuoteSortChainCompare(chain, length - 1, reversedRows[begin], reversedRows[end]) == 0) {
+            end++;
+        }
+        for (NSUInteger i = begin, j = end - 1; i < j; i++, j--) {
+            uint32_t row = reversedRows[i];
+            reversedRows[i] = reversedRows[j];
+            reversedRows[j] = row;
+        }
+        begin = end;
+    }
+    free(chain);
+    return reversed;
+}
+
+@end
+
+#pragma mark -
+
+// Past this share of the rows changing at once, one full sort is cheaper.
+static const NSUInteger kQuoteSortOrderResortDivisor = 8;
+
+static const uint32_t kQuoteSortOrderAbsent = UINT32_MAX;
+static const uint32_t kQuoteSortOrderMoving = UINT32_MAX - 1;
+
+@interface QuoteSortOrderItemArray : NSArray
+
+- (instancetype)initWithOrder:(QuoteSortOrder *)order;
+
+@end
+
+@implementation QuoteSortOrder {
+    QuoteSortEngine *_engine;
+    NSArray *_sourceItems;
+    __unsafe_unretained id *_itemsByRow;    // kept alive by _sourceItems
+    uint32_t *_rows;
+    uint32_t *_positions;                   // by row, or kQuoteSortOrderAbsent; NULL until a tick
+    NSUInteger _rowCapacity;                // store rows _positions covers
+    QuoteFieldMask _fields;
+    uint64_t _version;                      // of _fields, when last in order
+}
+
+- (instancetype)initWithEngine:(QuoteSortEngine *)engine items:(NSArray *)items descriptors:(NSArray *)descriptors {
+    return [self initWithEngine:engine items:items descriptors:descriptors permutation:nil];
+}
+
+- (instancetype)initWithEngine:(QuoteSortEngine *)engine items:(NSArray *)items descriptors:(NSArray *)descriptors
+                   permutation:(NSData *)permutation {
+    NSParameterAssert(engine && [engine canSortUsingDescriptors:descriptors]);
+    NSParameterAssert(!permutation || permutation.length == engine.store.rowCount * sizeof(uint32_t));
+    self = [super init];
+    if (self) {
+        _engine = engine;
+        _sourceItems = [items copy];
+        _descriptors = [descriptors copy];
+        _count = _sourceItems.count;
+        _rowCapacity = engine.store.rowCount;
+        for (NSSortDescriptor *descriptor in _descriptors) {
+            _fields |= QuoteFieldMaskForKey(descriptor.key);
+        }
+
+        _rows = malloc(MAX(_count, 1) * sizeof(uint32_t));
+        _itemsByRow = (__unsafe_unretained id *)calloc(MAX(_rowCapacity, 1), sizeof(id));
+        if (!_rows || !_itemsByRow) {
+            [NSException raise:NSMallocException format:@"QuoteSortOrder cannot hold %lu rows", (unsigned long)_count];
+        }
+        NSUInteger i = 0;
+        for (QuoteItem *item in _sourceItems) {
+            if (item.store != engine.store || item.row >= _rowCapacity) {
+                [NSException raise:NSInvalidArgumentException format:@"%@ is not a row of the sorted store", item];
+            }
+            _rows[i++] = (uint32_t)item.row;
+            _itemsByRow[item.row] = item;
+        }
+        if (permutation) {
+            // the permutation's order, less the rows not among the items
+            const uint32_t *sorted = permutation.bytes;
+            NSUInteger kept = 0;
+            for (NSUInteger j = 0; j < _rowCapacity; j++) {
+                if (_itemsByRow[sorted[j]]) {
+                    _rows[kept++] = sorted[j];
+                }
+            }
+            NSAssert(kept == _count, @"items repeat a row");
+        } else {
+            [self sortAllRows];
+        }
+        _version = [engine.store versionOfFields:_fields];
+    }
+    return self;
+}
+
+- (void)dealloc {
+    free(_rows);
+    free(_positions);
+    free(_itemsByRow);
+}
+
+- (const uint32_t *)rows {
+    return _rows;
+}
+
+- (NSArray *)items {
+    return [[QuoteSortOrderItemArray alloc] initWithOrder:self];
+}
+
+- (BOOL)isCurrent {
+    return _version == [_engine.store versionOfFields:_fields];
+}
+
+- (QuoteItem *)itemAtIndex:(NSUInteger)index {
+    return _itemsByRow[_rows[index]];
+}
+
+- (void)sortAllRows {
+    [_engine sortRows:_rows count:_count usingDescriptors:_descriptors];
+    [self updatePositionsFromIndex:0];
+}
+
+// Positions cost a pass over every row of the store, which an order of a
+// few filtered rows should not pay for unless they tick.
+- (void)preparePositions {
+    if (_positions) {
+        return;
+    }
+    _positions = malloc(MAX(_rowCapacity, 1) * sizeof(uint32_t));
+    if (!_positions) {
+        [NSException raise:NSMallocException format:@"QuoteSortOrder cannot hold %lu rows", (unsigned long)_count];
+    }
+    memset(_positions, 0xFF, _rowCapacity * sizeof(uint32_t));
+    [self updatePositionsFromIndex:0];
+}
+
+- (void)updatePositionsFromIndex:(NSUInteger)index {
+    if (!_positions) {
+        return;
+    }
+    for (NSUInteger i = index; i < _count; i++) {
+        _positions[_rows[i]] = (uint32_t)i;
+    }
+}
+
+- (void)updateRows:(const uint32_t *)rows count:(NSUInteger)count changedFields:(QuoteFieldMask)fields {
+    if (!(fields & _fields) || count == 0) {
+        return;
+    }
+    _version = [_engine.store versionOfFields:_fields];
+    if (count > _count / kQuoteSortOrderResortDivisor) {
+        [self sortAllRows];
+        return;
+    }
+    [self preparePositions];
+    size_t length;
+    QuoteSortColumn *chain = [_engine compileDescriptors:_descriptors length:&length];
+
+    // the order is sorted again if every changed row is still between its
+    // neighbours; a tick rarely carries a row past one
+    BOOL ordered = YES;
+    for (NSUInteger i = 0; i < count && ordered; i++) {
+        uint32_t row = rows[i];
+        uint32_t position = row < _rowCapacity ? _positions[row] : kQuoteSortOrderAbsent;
+        if (position == kQuoteSortOrderAbsent) {
+            continue;
+        }
+        ordered = (position == 0 || QuoteSortChainCompare(chain, length, _rows[position - 1], row) < 0)
+            && (position + 1 == _count || QuoteSortChainCompare(chain, length, row, _rows[position + 1]) < 0);
+    }
+    if (!ordered) {
+        [self moveRows:rows count:count chain:chain length:length];
+    }
+    free(chain);
+}
+
+// Takes the changed rows out, sorts them, and merges them back in from the
+// end: a binary search per row finds its place among the rest, and the rows
+// in between shift once.
+- (void)moveRows:(const uint32_t *)rows count:(NSUInteger)count
+           chain:(const QuoteSortColumn *)chain length:(size_t)length {
+    uint32_t *moving = malloc(count * sizeof(uint32_t));
+    if (!moving) {
+        [NSException raise:NSMallocException format:@"QuoteSortOrder cannot move %lu rows", (unsigned long)count];
+    }
+    NSUInteger movingCount = 0;
+    NSUInteger first = _count;
+    for (NSUInteger i = 0; i < count; i++) {
+        uint32_t row = rows[i];
+        if (row >= _rowCapacity || _positions[row] >= kQuoteSortOrderMoving) {
+            continue;
+        }
+        first = MIN(first, _positions[row]);
+        _positions[row] = kQuoteSortOrderMoving;
+        moving[movingCount++] = row;
+    }
+
+    NSUInteger kept = first;
+    for (NSUInteger i = first; i < _count; i++) {
+        uint32_t row = _rows[i];
+        if (_positions[row] != kQuoteSortOrderMoving) {
+            _rows[kept++] = row;
+        }
+    }
+    qsort_b(moving, movingCount, sizeof(uint32_t), ^int(const void *a, const void *b) {
+        return QuoteSortChainCompare(chain, length, *(const uint32_t *)a, *(const uint32_t *)b);
+    });
+
+    NSUInteger end = _count;
+    NSUInteger lowest = first;
+    for (NSUInteger m = movingCount; m-- > 0; ) {
+        uint32_t row = moving[m];
+        NSUInteger low = 0, high = kept;
+        while (low < high) {
+            NSUInteger middle = low + (high - low) / 2;
+            if (QuoteSortChainCompare(chain, length, _rows[middle], row) < 0) {
+                low = middle + 1;
+            } else {
+                high = middle;
+            }
+        }
+        NSUInteger tail = kept - low;
+        memmove(_rows + end - tail, _rows + low, tail * sizeof(uint32_t));
+        end -= tail;
+        _rows[--end] = row;
+        kept = low;
+        lowest = MIN(lowest, low);
+    }
+    free(moving);
+    [self updatePositionsFromIndex:lowest];
+}
+
+@end
+
+#pragma mark -
+
+@implementation QuoteSortOrderItemArray {
+    QuoteSortOrder *_order;
+}
+
+- (instancetype)initWithOrder:(QuoteSortOrder *)order {
+    self = [super init];
+    if (self) {
+        _order = order;
+    }
+    return self;
+}
+
+- (NSUInteger)count {
+    return _order.count;
+}
+
+- (id)objectAtIndex:(NSUInteger)index {
+    if (index >= _order.count) {
+        [NSException raise:NSRangeException format:@"index %lu beyond bounds [0 .. %lu]",
+         (unsigned long)index, (unsigned long)_order.count];
+    }
+    return [_order itemAtIndex:index];
+}
+
+@end
@@ -0,0 +1,81 @@
+//
+//  QuoteSortKey.h
+//  dgpoc
+//
+//  The symbol column's sort key packed into 128 bits, most significant field
+//  first, so ordering rows is one unsigned compare of (hi, lo) and a radix
+//  sort can walk the key a byte at a time:
+//
+//      hi  underlying rank:32  account:16  kind:8  reserved:7  built:1
+//      lo  expiry yyyymmdd:25  strike ticks:37  right:2
+//
+//  The rank is the underlying's position in alphabetical order, so keys from
+//  one store compare alphabetically by underlying. Options carry their
+//  expiry, strike (QUOTE_PRICE_DECIMALS ticks, so 95 sorts before 100) and
+//  call/put; equities leave them 0.
+//
+
+#ifndef QuoteSortKey_h
+#define QuoteSortKey_h
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "QuoteOptionSymbol.h"
+
+typedef struct {
+    uint64_t hi;
+    uint64_t lo;
+} QuoteSortKey;
+
+/// Where a row sits inside its underlying's group. An equity leads its
+/// options in both directions: its ascending key sorts first and its
+/// descending key sorts last, which a descending sort turns into first.
+typedef enum {
+    QuoteSortKindEquityAscending = 0,
+    QuoteSortKindOption = 1,
+    QuoteSortKindEquityDescending = 2,
+} QuoteSortKind;
+
+#define QUOTE_SORT_KEY_STRIKE_MAX (((uint64_t)1 << 37) - 1)
+
+/// Packs a key. Expiry is yyyymmdd; a strike outside 0...QUOTE_SORT_KEY_STRIKE_MAX
+/// is clamped. Every packed key is non-zero, so a zeroed key means "not built".
+static inline QuoteSortKey QuoteSortKeyMake(uint32_t underlyingRank, uint16_t account, QuoteSortKind kind,
+                                            uint32_t expiry, int64_t strike, QuoteOptionRight right) {
+    uint64_t strikeBits = strike < 0 ? 0 : (uint64_t)strike > QUOTE_SORT_KEY_STRIKE_MAX
+        ? QUOTE_SORT_KEY_STRIKE_MAX : (uint64_t)strike;
+    QuoteSortKey key;
+    key.hi = (uint64_t)underlyingRank << 32 | (uint64_t)account << 16 | (uint64_t)(kind & 0xFF) << 8 | 1;
+    key.lo = (uint64_t)(expiry & 0x1FFFFFF) << 39 | strikeBits << 2 | (uint64_t)(right & 3);
+    return key;
+}
+
+static inline bool QuoteSortKeyIsBuilt(QuoteSortKey key) {
+    return key.hi != 0;
+}
+
+/// -1, 0 or 1 as a orders before, with or after b.
+static inline int QuoteSortKeyCompare(QuoteSortKey a, QuoteSortKey b) {
+    if (a.hi != b.hi) {
+        return a.hi < b.hi ? -1 : 1;
+    }
+    if (a.lo != b.lo) {
+        return a.lo < b.lo ? -1 : 1;
+    }
+    return 0;
+}
+
+/// Writes the key as 32 lowercase hex digits plus a NUL into hex, so the
+/// strings of two keys compare the way the keys do.
+static inline void QuoteSortKeyFormatHex(QuoteSortKey key, char hex[33]) {
+    static const char digits[] = "0123456789abcdef";
+    for (int i = 0; i < 16; i++) {
+        hex[15 - i] = digits[(key.hi >> (4 * i)) & 0xF];
+        hex[31 - i] = digits[(key.lo >> (4 * i)) & 0xF];
+    }
+    hex[32] = '\0';
+}
+
+#endif /* QuoteSortKey_h */
@@ -0,0 +1,44 @@
+//
+//  QuoteSortScheduler.h
+//  dgpoc
+//
+//  Runs sorts off the calling thread, newest request wins. Requests run one
+//  at a time on a private serial queue; submitting a request cancels every
+//  earlier one, so a request still queued never runs, one running can stop
+//  early by polling isCancelled, and one that finishes anyway is dropped.
+//  A request that is not cancelled publishes its result with an atomic swap
+//  of result, then its completion runs on the completion queue.
+//
+//  Knows nothing of grids or stores, so it can be driven from tests with
+//  plain blocks and a queue of their own.
+//
+
+#import <Foundation/Foundation.h>
+
+typedef id (^QuoteSortSchedulerWork)(BOOL (^isCancelled)(void));
+
+@interface QuoteSortScheduler : NSObject
+
+/// Completions run on the main queue.
+- (instancetype)init;
+- (instancetype)initWithCompletionQueue:(dispatch_queue_t)completionQueue NS_DESIGNATED_INITIALIZER;
+
+/// Of the newest request, 0 before the first.
+@property (nonatomic, readonly) uint64_t generation;
+/// YES from a submit until its request publishes or is cancelled.
+@property (nonatomic, readonly, getter=isPending) BOOL pending;
+/// The newest published result and its request's generation; safe to read
+/// from any thread, though the two are read separately.
+@property (atomic, strong, readonly) id result;
+@property (atomic, readonly) uint64_t resultGeneration;
+/// Requests cancelled before they could publish.
+@property (atomic, readonly) NSUInteger cancelledCount;
+
+/// Queues work and returns its generation. completion, which may be nil,
+/// gets the work's result unless a newer request came in first.
+- (uint64_t)submitWork:(QuoteSortSchedulerWork)work completion:(void (^)(id result, uint64_t generation))completion;
+
+/// Cancels every request submitted so far.
+- (void)cancel;
+
+@end
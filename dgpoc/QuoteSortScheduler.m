@@ -0,0 +1,98 @@
+#import "QuoteSortScheduler.h"
+
+@interface QuoteSortScheduler ()
+
+@property (atomic, strong, readwrite) id result;
+@property (atomic, readwrite) uint64_t resultGeneration;
+@property (atomic, readwrite) NSUInteger cancelledCount;
+
+@end
+
+@implementation QuoteSortScheduler {
+    dispatch_queue_t _workQueue;
+    dispatch_queue_t _completionQueue;
+    uint64_t _generation;           // guarded by self
+    uint64_t _settledGeneration;    // guarded by self; published or cancelled
+}
+
+- (instancetype)init {
+    return [self initWithCompletionQueue:dispatch_get_main_queue()];
+}
+
+- (instancetype)initWithCompletionQueue:(dispatch_queue_t)completionQueue {
+    NSParameterAssert(completionQueue);
+    self = [super init];
+    if (self) {
+        _workQueue = dispatch_queue_create("dgpoc.QuoteSortScheduler", DISPATCH_QUEUE_SERIAL);
+        dispatch_set_target_queue(_workQueue, dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_HIGH, 0));
+        _completionQueue = completionQueue;
+    }
+    return self;
+}
+
+- (uint64_t)generation {
+    @synchronized (self) {
+        return _generation;
+    }
+}
+
+- (BOOL)isPending {
+    @synchronized (self) {
+        return _generation != _settledGeneration;
+    }
+}
+
+- (uint64_t)submitWork:(QuoteSortSchedulerWork)work completion:(void (^)(id result, uint64_t generation))completion {
+    NSParameterAssert(work);
+    uint64_t generation;
+    @synchronized (self) {
+        generation = ++_generation;
+    }
+    __weak QuoteSortScheduler *weakSelf = self;
+    BOOL (^isCancelled)(void) = ^BOOL {
+        QuoteSortScheduler *scheduler = weakSelf;
+        return !scheduler || scheduler.generation != generation;
+    };
+
+    dispatch_async(_workQueue, ^{
+        if (isCancelled()) {
+            weakSelf.cancelledCount++;
+            return;
+        }
+        id result = work(isCancelled);
+        QuoteSortScheduler *scheduler = weakSelf;
+        if (![scheduler publishResult:result generation:generation]) {
+            scheduler.cancelledCount++;
+            return;
+        }
+        if (completion) {
+            dispatch_async(scheduler->_completionQueue, ^{
+                if (!isCancelled()) {
+                    completion(result, generation);
+                }
+            });
+        }
+    });
+    return generation;
+}
+
+// Publishes unless a newer request came in, all under the lock cancel takes.
+- (BOOL)publishResult:(id)result generation:(uint64_t)generation {
+    @synchronized (self) {
+        if (_generation != generation) {
+            return NO;
+        }
+        self.result = result;
+        self.resultGeneration = generation;
+        _settledGeneration = generation;
+        return YES;
+    }
+}
+
+- (void)cancel {
+    @synchronized (self) {
+        _settledGeneration = ++_generation;
+    }
+}
+
+@end
@@ -0,0 +1,132 @@
+//
+//  QuoteStore.h
+//  dgpoc
+//
+//  Column-oriented storage for a quote set. Every numeric field is one
+//  contiguous double or int64 fixed-point array and every string field is a
+//  uint32 code array into a QuoteStringTable, so scans, sorts and tick updates
+//  walk flat memory instead of one object and a dozen boxed values per row.
+//
+//  Symbol and underlying symbol codes index one shared table, so a ticker
+//  has one dense id whichever column it is in, and grouping an option with
+//  its underlying is an integer compare.
+//
+//  A row's id is its index in the store. Rows are only ever appended, so ids
+//  are stable for the life of the store. Missing values read as NaN,
+//  QUOTE_FIXED_MISSING or code 0, which the object accessors surface as nil.
+//
+
+#import <Foundation/Foundation.h>
+#import "QuoteSchema.h"
+#import "QuoteOptionSymbol.h"
+#import "QuoteSortKey.h"
+#import "QuoteStringTable.h"
+
+@class QuoteItem;
+
+/// An option symbol's expiry, strike and right, parsed once per distinct
+/// symbol. right is QuoteOptionRightNone for equities and for option symbols
+/// that do not parse.
+typedef struct {
+    int64_t strike;             // QUOTE_PRICE_DECIMALS ticks
+    uint32_t expiry;            // yyyymmdd
+    QuoteOptionRight right;
+} QuoteOptionContract;
+
+/// Raw column pointers, valid until rows are appended past the capacity.
+typedef struct {
+    double *doubles[QuoteFieldCount];           // QuoteFieldTypeDouble only
+    int64_t *fixed[QuoteFieldCount];            // QuoteFieldTypeFixed only
+    uint32_t *codes[QuoteFieldCount];           // QuoteFieldTypeString only
+    QuoteStringTable *tables[QuoteFieldCount];  // QuoteFieldTypeString only
+} QuoteStoreColumns;
+
+@interface QuoteStore : NSObject
+
+@property (nonatomic, readonly) NSUInteger rowCount;
+@property (nonatomic, readonly) NSUInteger capacity;
+
+/// Grows the columns so rowCount can reach capacity without reallocating.
+- (void)reserveCapacity:(NSUInteger)capacity;
+
+/// Appends count rows with every field missing and returns the first new id.
+- (NSUInteger)appendRows:(NSUInteger)count;
+
+/// Appends every row of store, translating its string codes into this store.
+- (void)appendStore:(QuoteStore *)store;
+
+/// Copies fields of every row of store over this store's rows starting at row.
+- (void)copyFields:(QuoteFieldMask)fields fromStore:(QuoteStore *)store toRow:(NSUInteger)row;
+
+- (QuoteStoreColumns)columns;
+- (double *)doubleColumn:(QuoteField)field;
+- (int64_t *)fixedColumn:(QuoteField)field;
+/// Writing symbol codes through codeColumn: bypasses the sort key cache;
+/// use setString: for rows whose keys may have been read.
+- (uint32_t *)codeColumn:(QuoteField)field;
+- (QuoteStringTable *)stringTableForField:(QuoteField)field;
+
+/// Changes as any of the fields' values change: through the setters,
+/// appendRows: and copyFields:, or a write through a column pointer that is
+/// reported with didChangeFields:. Anything derived from the fields is
+/// current while their version is the one it was derived at.
+- (uint64_t)versionOfFields:(QuoteFieldMask)fields;
+- (void)didChangeFields:(QuoteFieldMask)fields;
+
+- (double)doubleForField:(QuoteField)field row:(NSUInteger)row;
+- (void)setDouble:(double)value forField:(QuoteField)field row:(NSUInteger)row;
+
+/// Fixed-point value with QuoteFieldDecimals(field) places.
+- (int64_t)fixedForField:(QuoteField)field row:(NSUInteger)row;
+- (void)setFixed:(int64_t)value forField:(QuoteField)field row:(NSUInteger)row;
+
+/// The string for a code of a string field. Each distinct string is created
+/// once and shared by every row holding it.
+- (NSString *)stringForCode:(uint32_t)code field:(QuoteField)field;
+- (NSString *)stringForField:(QuoteField)field row:(NSUInteger)row;
+- (void)setString:(NSString *)value forField:(QuoteField)field row:(NSUInteger)row;
+
+/// The id of a ticker in the symbol and underlying symbol columns, or 0 if
+/// no row holds it.
+- (uint32_t)symbolIdForString:(NSString *)symbol;
+- (NSString *)symbolForId:(uint32_t)symbolId;
+
+- (QuoteAssetType)assetTypeForRow:(NSUInteger)row;
+
+/// Every code of a string field's table ranked in byte order, by code, so
+/// comparing ranks compares strings. Code 0 ranks first; strings equal under
+/// case-insensitive folding (ASCII only) share a rank. Computed once per
+/// table size and valid until the next string is interned.
+- (const uint32_t *)stringRanksForField:(QuoteField)field caseInsensitive:(BOOL)caseInsensitive;
+
+/// Contracts by symbol id, covering every symbol interned so far. Loaders
+/// call it once so parsing happens at load; setString: parses new tickers.
+/// Valid until the next symbol is interned.
+- (const QuoteOptionContract *)optionContracts;
+- (QuoteOptionContract)optionContractForRow:(NSUInteger)row;
+
+/// The symbol column's packed sort key (see QuoteSortKey.h) for every row,
+/// or one row. Built on first use and kept until setString: or copyFields:
+/// changes the row's asset type, symbol or underlying, or a new ticker
+/// shifts the alphabetical ranks. The array is valid until the next change.
+- (const QuoteSortKey *)symbolSortKeysAscending:(BOOL)ascending;
+- (QuoteSortKey)symbolSortKeyForRow:(NSUInteger)row ascending:(BOOL)ascending;
+
+/// The packed key as a hex string, for KVC sorting: the strings order with
+/// compare: exactly as the keys do. Cached like the keys.
+- (NSString *)symbolSortStringForRow:(NSUInteger)row ascending:(BOOL)ascending;
+
+/// Boxed access by field type, for KVC style callers: NSNumber, NSString, or
+/// for fixed fields an exact NSDecimalNumber. Setting a fixed field takes an
+/// NSDecimalNumber exactly and rounds any other NSNumber to the field's places.
+- (id)valueForField:(QuoteField)field row:(NSUInteger)row;
+- (void)setValue:(id)value forField:(QuoteField)field row:(NSUInteger)row;
+
+/// QuoteItem views over the rows, created on first access and kept by the
+/// returned array. The array does not follow rows appended later.
+- (NSArray *)items;
+
+/// YES when items is an array returned by items, whose item i is row i.
+- (BOOL)isItemArray:(NSArray *)items;
+
+@end
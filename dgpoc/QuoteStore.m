@@ -0,0 +1,595 @@
+#import "QuoteStore.h"
+#import "QuoteItem.h"
+
+static const NSUInteger kQuoteStoreMinimumCapacity = 64;
+
+// Fields the symbol sort keys are built from.
+static const QuoteFieldMask kQuoteSymbolSortFields = (1 << QuoteFieldAssetType) | (1 << QuoteFieldSymbol)
+    | (1 << QuoteFieldUnderlyingSymbol);
+
+#pragma mark -
+
+@interface QuoteStoreItemArray : NSArray
+
+- (instancetype)initWithStore:(QuoteStore *)store;
+
+@property (nonatomic, readonly) QuoteStore *store;
+
+@end
+
+static int64_t QuoteFixedFromNumber(NSNumber *value, unsigned decimals) {
+    if (!value) {
+        return QUOTE_FIXED_MISSING;
+    }
+    if (![value isKindOfClass:[NSDecimalNumber class]]) {
+        return QuoteFixedFromDouble(value.doubleValue, decimals);
+    }
+    NSDecimalNumberHandler *behavior = [NSDecimalNumberHandler decimalNumberHandlerWithRoundingMode:NSRoundPlain
+                                                                                              scale:(short)decimals
+                                                                                   raiseOnExactness:NO
+                                                                                    raiseOnOverflow:NO
+                                                                                   raiseOnUnderflow:NO
+                                                                                raiseOnDivideByZero:NO];
+    NSDecimalNumber *ticks = [(NSDecimalNumber *)value decimalNumberByMultiplyingByPowerOf10:(short)decimals
+                                                                               withBehavior:behavior];
+    if ([ticks isEqualToNumber:[NSDecimalNumber notANumber]]) {
+        return QUOTE_FIXED_MISSING;
+    }
+    return ticks.longLongValue;
+}
+
+static NSString *QuoteCachedString(QuoteStringTable *table, NSPointerArray *cache, uint32_t code) {
+    if (code == 0) {
+        return nil;
+    }
+    if (cache.count <= code) {
+        cache.count = QuoteStringTableCount(table) + 1;
+    }
+    NSString *string = (__bridge NSString *)[cache pointerAtIndex:code];
+    if (!string) {
+        size_t length;
+        const char *bytes = QuoteStringTableBytes(table, code, &length);
+        string = [[NSString alloc] initWithBytes:bytes length:length encoding:NSUTF8StringEncoding];
+        [cache replacePointerAtIndex:code withPointer:(__bridge void *)string];
+    }
+    return string;
+}
+
+static QuoteSortKey QuoteSymbolSortKeyBuild(QuoteAssetType assetType, BOOL ascending, QuoteOptionContract contract,
+                                            uint32_t symbolRank, uint32_t underlyingRank) {
+    if (assetType != QuoteAssetTypeOption) {
+        QuoteSortKind kind = ascending ? QuoteSortKindEquityAscending : QuoteSortKindEquityDescending;
+        return QuoteSortKeyMake(symbolRank, 0, kind, 0, 0, QuoteOptionRightNone);
+    }
+    // an option whose symbol did not parse sorts ahead of its group's others
+    return QuoteSortKeyMake(underlyingRank, 0, QuoteSortKindOption, contract.expiry, contract.strike, contract.right);
+}
+
+#pragma mark -
+
+@implementation QuoteStore {
+    QuoteStoreColumns _columns;
+    NSArray *_stringCaches;
+    QuoteAssetType *_assetTypes;    // by asset type code
+    uint32_t _assetTypeCount;
+    // symbol sort keys per row, ascending and descending, zero until built,
+    // and their hex strings interned, code 0 until asked for
+    QuoteSortKey *_symbolSortKeys[2];
+    uint32_t *_symbolSortCodes[2];
+    QuoteStringTable _symbolSortTable;
+    NSPointerArray *_symbolSortStrings;
+    uint32_t _symbolRankCount;      // symbol ids the keys' ranks cover, plus 1
+    // by string table owner, case-sensitive and case-insensitive
+    uint32_t *_stringRanks[QuoteFieldCount][2];
+    uint32_t _stringRankCounts[QuoteFieldCount][2];
+    QuoteOptionContract *_optionContracts;  // by symbol id
+    uint32_t _optionContractCount;
+    uint64_t _version;
+    uint64_t _fieldVersions[QuoteFieldCount];   // _version at each field's last change
+}
+
+- (instancetype)init {
+    self = [super init];
+    if (self) {
+        NSMutableArray *stringCaches = [NSMutableArray arrayWithCapacity:QuoteFieldCount];
+        for (QuoteField field = 0; field < QuoteFieldCount; field++) {
+            QuoteField owner = QuoteFieldStringTableOwner(field);
+            if (QuoteFieldTypeOf(field) != QuoteFieldTypeString) {
+                [stringCaches addObject:[NSNull null]];
+            } else if (owner != field) {
+                // owners come first in the schema
+                _columns.tables[field] = _columns.tables[owner];
+                [stringCaches addObject:stringCaches[owner]];
+            } else {
+                _columns.tables[field] = malloc(sizeof(QuoteStringTable));
+                QuoteStringTableInit(_columns.tables[field]);
+                [stringCaches addObject:[NSPointerArray strongObjectsPointerArray]];
+            }
+        }
+        _stringCaches = stringCaches;
+        QuoteStringTableInit(&_symbolSortTable);
+        _symbolSortStrings = [NSPointerArray strongObjectsPointerArray];
+    }
+    return self;
+}
+
+- (void)dealloc {
+    for (QuoteField field = 0; field < QuoteFieldCount; field++) {
+        free(_columns.doubles[field]);
+        free(_columns.fixed[field]);
+        free(_columns.codes[field]);
+        if (_columns.tables[field] && QuoteFieldStringTableOwner(field) == field) {
+            QuoteStringTableFree(_columns.tables[field]);
+            free(_columns.tables[field]);
+        }
+        free(_stringRanks[field][0]);
+        free(_stringRanks[field][1]);
+    }
+    free(_assetTypes);
+    QuoteStringTableFree(&_symbolSortTable);
+    for (int i = 0; i < 2; i++) {
+        free(_symbolSortKeys[i]);
+        free(_symbolSortCodes[i]);
+    }
+    free(_optionContracts);
+}
+
+- (void)reserveCapacity:(NSUInteger)capacity {
+    if (capacity <= _capacity) {
+        return;
+    }
+    for (QuoteField field = 0; field < QuoteFieldCount; field++) {
+        void **column;
+        size_t width;
+        switch (QuoteFieldTypeOf(field)) {
+            case QuoteFieldTypeDouble:
+                column = (void **)&_columns.doubles[field];
+                width = sizeof(double);
+                break;
+            case QuoteFieldTypeFixed:
+                column = (void **)&_columns.fixed[field];
+                width = sizeof(int64_t);
+                break;
+            case QuoteFieldTypeString:
+                column = (void **)&_columns.codes[field];
+                width = sizeof(uint32_t);
+                break;
+        }
+        void *grown = realloc(*column, capacity * width);
+        if (!grown) {
+            [NSException raise:NSMallocException format:@"QuoteStore cannot grow to %lu rows", (unsigned long)capacity];
+        }
+        *column = grown;
+    }
+    for (int i = 0; i < 2; i++) {
+        QuoteSortKey *keys = realloc(_symbolSortKeys[i], capacity * sizeof(QuoteSortKey));
+        if (keys) {
+            _symbolSortKeys[i] = keys;
+        }
+        uint32_t *codes = realloc(_symbolSortCodes[i], capacity * sizeof(uint32_t));
+        if (codes) {
+            _symbolSortCodes[i] = codes;
+        }
+        if (!keys || !codes) {
+            [NSException raise:NSMallocException format:@"QuoteStore cannot grow to %lu rows", (unsigned long)capacity];
+        }
+    }
+    _capacity = capacity;
+}
+
+- (NSUInteger)appendRows:(NSUInteger)count {
+    NSUInteger first = _rowCount;
+    if (first + count > _capacity) {
+        NSUInteger capacity = MAX(_capacity, kQuoteStoreMinimumCapacity);
+        while (capacity < first + count) {
+            capacity *= 2;
+        }
+        [self reserveCapacity:capacity];
+    }
+    for (QuoteField field = 0; field < QuoteFieldCount; field++) {
+        if (_columns.doubles[field]) {
+            double *column = _columns.doubles[field];
+            for (NSUInteger row = first; row < first + count; row++) {
+                column[row] = NAN;
+            }
+        } else if (_columns.fixed[field]) {
+            int64_t *column = _columns.fixed[field];
+            for (NSUInteger row = first; row < first + count; row++) {
+                column[row] = QUOTE_FIXED_MISSING;
+            }
+        } else {
+            memset(_columns.codes[field] + first, 0, count * sizeof(uint32_t));
+        }
+    }
+    _rowCount = first + count;
+    [self clearSymbolSortKeysFromRow:first count:count];
+    [self didChangeFields:QuoteFieldMaskAll];
+    return first;
+}
+
+- (void)appendStore:(QuoteStore *)store {
+    NSUInteger first = [self appendRows:store.rowCount];
+    [self copyFields:QuoteFieldMaskAll fromStore:store toRow:first];
+}
+
+- (void)copyFields:(QuoteFieldMask)fields fromStore:(QuoteStore *)store toRow:(NSUInteger)row {
+    NSUInteger count = store.rowCount;
+    if (row + count > _rowCount) {
+        [NSException raise:NSRangeException format:@"rows %lu..%lu beyond %lu",
+         (unsigned long)row, (unsigned long)(row + count), (unsigned long)_rowCount];
+    }
+    QuoteStoreColumns source = [store columns];
+    if (fields & kQuoteSymbolSortFields) {
+        [self clearSymbolSortKeysFromRow:row count:count];
+    }
+    [self didChangeFields:fields];
+
+    for (QuoteField field = 0; field < QuoteFieldCount; field++) {
+        if (!(fields & QuoteFieldMaskOf(field))) {
+            continue;
+        }
+        if (QuoteFieldTypeOf(field) == QuoteFieldTypeDouble) {
+            memcpy(_columns.doubles[field] + row, source.doubles[field], count * sizeof(double));
+            continue;
+        }
+        if (QuoteFieldTypeOf(field) == QuoteFieldTypeFixed) {
+            memcpy(_columns.fixed[field] + row, source.fixed[field], count * sizeof(int64_t));
+            continue;
+        }
+
+        // translate each distinct source string once
+        QuoteStringTable *sourceTable = source.tables[field];
+        QuoteStringTable *table = _columns.tables[field];
+        uint32_t *translated = calloc((size_t)QuoteStringTableCount(sourceTable) + 1, sizeof(uint32_t));
+        const uint32_t *codes = source.codes[field];
+        uint32_t *target = _columns.codes[field] + row;
+        for (NSUInteger i = 0; i < count; i++) {
+            uint32_t code = codes[i];
+            if (code && !translated[code]) {
+                size_t length;
+                const char *bytes = QuoteStringTableBytes(sourceTable, code, &length);
+                translated[code] = QuoteStringTableIntern(table, bytes, length);
+            }
+            target[i] = translated[code];
+        }
+        free(translated);
+    }
+}
+
+- (QuoteStoreColumns)columns {
+    return _columns;
+}
+
+- (double *)doubleColumn:(QuoteField)field {
+    return _columns.doubles[field];
+}
+
+- (int64_t *)fixedColumn:(QuoteField)field {
+    return _columns.fixed[field];
+}
+
+- (uint32_t *)codeColumn:(QuoteField)field {
+    return _columns.codes[field];
+}
+
+- (QuoteStringTable *)stringTableForField:(QuoteField)field {
+    return _columns.tables[field];
+}
+
+- (double)doubleForField:(QuoteField)field row:(NSUInteger)row {
+    NSParameterAssert(row < _rowCount);
+    return _columns.doubles[field][row];
+}
+
+- (void)setDouble:(double)value forField:(QuoteField)field row:(NSUInteger)row {
+    NSParameterAssert(row < _rowCount);
+    _columns.doubles[field][row] = value;
+    [self didChangeFields:QuoteFieldMaskOf(field)];
+}
+
+- (int64_t)fixedForField:(QuoteField)field row:(NSUInteger)row {
+    NSParameterAssert(row < _rowCount);
+    return _columns.fixed[field][row];
+}
+
+- (void)setFixed:(int64_t)value forField:(QuoteField)field row:(NSUInteger)row {
+    NSParameterAssert(row < _rowCount);
+    _columns.fixed[field][row] = value;
+    [self didChangeFields:QuoteFieldMaskOf(field)];
+}
+
+- (NSString *)stringForCode:(uint32_t)code field:(QuoteField)field {
+    return QuoteCachedString(_columns.tables[field], _stringCaches[field], code);
+}
+
+- (NSString *)stringForField:(QuoteField)field row:(NSUInteger)row {
+    NSParameterAssert(row < _rowCount);
+    return [self stringForCode:_columns.codes[field][row] field:field];
+}
+
+- (void)setString:(NSString *)value forField:(QuoteField)field row:(NSUInteger)row {
+    NSParameterAssert(row < _rowCount);
+    uint32_t code = 0;
+    if (value) {
+        const char *utf8 = value.UTF8String;
+        code = QuoteStringTableIntern(_columns.tables[field], utf8, strlen(utf8));
+    }
+    _columns.codes[field][row] = code;
+    if (QuoteFieldStringTableOwner(field) == QuoteFieldSymbol && code >= _optionContractCount) {
+        // a new ticker off a tick; parse it now rather than mid-sort
+        [self optionContracts];
+    }
+    if (kQuoteSymbolSortFields & QuoteFieldMaskOf(field)) {
+        [self clearSymbolSortKeysFromRow:row count:1];
+    }
+    [self didChangeFields:QuoteFieldMaskOf(field)];
+}
+
+- (void)didChangeFields:(QuoteFieldMask)fields {
+    _version++;
+    for (QuoteField field = 0; field < QuoteFieldCount; field++) {
+        if (fields & QuoteFieldMaskOf(field)) {
+            _fieldVersions[field] = _version;
+        }
+    }
+}
+
+- (uint64_t)versionOfFields:(QuoteFieldMask)fields {
+    uint64_t version = 0;
+    for (QuoteField field = 0; field < QuoteFieldCount; field++) {
+        if (fields & QuoteFieldMaskOf(field)) {
+            version = MAX(version, _fieldVersions[field]);
+        }
+    }
+    return version;
+}
+
+- (uint32_t)symbolIdForString:(NSString *)symbol {
+    const char *utf8 = symbol.UTF8String;
+    return utf8 ? QuoteStringTableFind(_columns.tables[QuoteFieldSymbol], utf8, strlen(utf8)) : 0;
+}
+
+- (NSString *)symbolForId:(uint32_t)symbolId {
+    return [self stringForCode:symbolId field:QuoteFieldSymbol];
+}
+
+#pragma mark String ranks
+
+- (const uint32_t *)stringRanksForField:(QuoteField)field caseInsensitive:(BOOL)caseInsensitive {
+    NSParameterAssert(QuoteFieldTypeOf(field) == QuoteFieldTypeString);
+    QuoteField owner = QuoteFieldStringTableOwner(field);
+    const QuoteStringTable *table = _columns.tables[owner];
+    int fold = caseInsensitive ? 1 : 0;
+    uint32_t count = QuoteStringTableCount(table) + 1;
+    if (count == _stringRankCounts[owner][fold]) {
+        return _stringRanks[owner][fold];
+    }
+    uint32_t *codes = malloc(count * sizeof(uint32_t));
+    uint32_t *ranks = realloc(_stringRanks[owner][fold], count * sizeof(uint32_t));
+    if (!codes || !ranks) {
+        free(codes);
+        if (ranks) {
+            _stringRanks[owner][fold] = ranks;
+        }
+        _stringRankCounts[owner][fold] = 0;
+        [NSException raise:NSMallocException format:@"QuoteStore cannot rank %u strings", count];
+    }
+    _stringRanks[owner][fold] = ranks;
+
+    for (uint32_t code = 0; code < count; code++) {
+        codes[code] = code;
+    }
+    // code 0, no string, stays first
+    qsort_b(codes + 1, count - 1, sizeof(uint32_t), ^int(const void *a, const void *b) {
+        return QuoteStringTableCompare(table, *(const uint32_t *)a, *(const uint32_t *)b, caseInsensitive);
+    });
+    ranks[0] = 0;
+    uint32_t rank = 0;
+    for (uint32_t i = 1; i < count; i++) {
+        if (i == 1 || QuoteStringTableCompare(table, codes[i - 1], codes[i], caseInsensitive) != 0) {
+            rank++;
+        }
+        ranks[codes[i]] = rank;
+    }
+    free(codes);
+
+    _stringRankCounts[owner][fold] = count;
+    return ranks;
+}
+
+#pragma mark Symbol sort keys
+
+- (void)clearSymbolSortKeysFromRow:(NSUInteger)row count:(NSUInteger)count {
+    if (count == 0) {
+        return;
+    }
+    for (int i = 0; i < 2; i++) {
+        memset(_symbolSortKeys[i] + row, 0, count * sizeof(QuoteSortKey));
+        memset(_symbolSortCodes[i] + row, 0, count * sizeof(uint32_t));
+    }
+}
+
+// A new ticker shifts the ranks after it, so every built key is dropped
+// along with the old ranks.
+- (void)updateSymbolRanks {
+    uint32_t count = QuoteStringTableCount(_columns.tables[QuoteFieldSymbol]) + 1;
+    if (count == _symbolRankCount) {
+        return;
+    }
+    [self stringRanksForField:QuoteFieldSymbol caseInsensitive:NO];
+    _symbolRankCount = count;
+    [self clearSymbolSortKeysFromRow:0 count:_rowCount];
+}
+
+- (QuoteSortKey)buildSymbolSortKeyForRow:(NSUInteger)row ascending:(BOOL)ascending {
+    uint32_t symbolCode = _columns.codes[QuoteFieldSymbol][row];
+    const uint32_t *ranks = _stringRanks[QuoteFieldSymbol][0];
+    return QuoteSymbolSortKeyBuild([self assetTypeForRow:row], ascending, [self optionContracts][symbolCode],
+                                   ranks[symbolCode], ranks[_columns.codes[QuoteFieldUnderlyingSymbol][row]]);
+}
+
+- (const QuoteSortKey *)symbolSortKeysAscending:(BOOL)ascending {
+    [self updateSymbolRanks];
+    QuoteSortKey *keys = _symbolSortKeys[ascending ? 0 : 1];
+    for (NSUInteger row = 0; row < _rowCount; row++) {
+        if (!QuoteSortKeyIsBuilt(keys[row])) {
+            keys[row] = [self buildSymbolSortKeyForRow:row ascending:ascending];
+        }
+    }
+    return keys;
+}
+
+- (QuoteSortKey)symbolSortKeyForRow:(NSUInteger)row ascending:(BOOL)ascending {
+    NSParameterAssert(row < _rowCount);
+    [self updateSymbolRanks];
+    QuoteSortKey *key = &_symbolSortKeys[ascending ? 0 : 1][row];
+    if (!QuoteSortKeyIsBuilt(*key)) {
+        *key = [self buildSymbolSortKeyForRow:row ascending:ascending];
+    }
+    return *key;
+}
+
+- (NSString *)symbolSortStringForRow:(NSUInteger)row ascending:(BOOL)ascending {
+    QuoteSortKey key = [self symbolSortKeyForRow:row ascending:ascending];
+    uint32_t *code = &_symbolSortCodes[ascending ? 0 : 1][row];
+    if (*code == 0) {
+        char hex[33];
+        QuoteSortKeyFormatHex(key, hex);
+        *code = QuoteStringTableIntern(&_symbolSortTable, hex, 32);
+    }
+    return QuoteCachedString(&_symbolSortTable, _symbolSortStrings, *code);
+}
+
+#pragma mark -
+
+- (const QuoteOptionContract *)optionContracts {
+    const QuoteStringTable *symbols = _columns.tables[QuoteFieldSymbol];
+    uint32_t count = QuoteStringTableCount(symbols) + 1;
+    if (count > _optionContractCount) {
+        QuoteOptionContract *contracts = realloc(_optionContracts, count * sizeof(QuoteOptionContract));
+        if (!contracts) {
+            [NSException raise:NSMallocException format:@"QuoteStore cannot parse %u symbols", count];
+        }
+        contracts[0] = (QuoteOptionContract){ 0 };
+        for (uint32_t id = MAX(_optionContractCount, 1u); id < count; id++) {
+            size_t length;
+            const char *bytes = QuoteStringTableBytes(symbols, id, &length);
+            QuoteOptionSymbol option;
+            QuoteOptionSymbolParse(bytes, length, &option);
+            contracts[id] = (QuoteOptionContract){ option.strike, option.expiry, option.right };
+        }
+        _optionContracts = contracts;
+        _optionContractCount = count;
+    }
+    return _optionContracts;
+}
+
+- (QuoteOptionContract)optionContractForRow:(NSUInteger)row {
+    NSParameterAssert(row < _rowCount);
+    return [self optionContracts][_columns.codes[QuoteFieldSymbol][row]];
+}
+
+- (QuoteAssetType)assetTypeForRow:(NSUInteger)row {
+    NSParameterAssert(row < _rowCount);
+    uint32_t code = _columns.codes[QuoteFieldAssetType][row];
+    if (code >= _assetTypeCount) {
+        // a handful of codes at most; classify each once
+        const QuoteStringTable *table = _columns.tables[QuoteFieldAssetType];
+        uint32_t count = QuoteStringTableCount(table) + 1;
+        QuoteAssetType *assetTypes = realloc(_assetTypes, count * sizeof(QuoteAssetType));
+        if (!assetTypes) {
+            [NSException raise:NSMallocException format:@"QuoteStore cannot classify %u asset types", count];
+        }
+        assetTypes[0] = QuoteAssetTypeUnknown;
+        for (uint32_t id = MAX(_assetTypeCount, 1u); id < count; id++) {
+            size_t length;
+            const char *bytes = QuoteStringTableBytes(table, id, &length);
+            assetTypes[id] = QuoteAssetTypeFromBytes(bytes, length);
+        }
+        _assetTypes = assetTypes;
+        _assetTypeCount = count;
+    }
+    return _assetTypes[code];
+}
+
+- (id)valueForField:(QuoteField)field row:(NSUInteger)row {
+    switch (QuoteFieldTypeOf(field)) {
+        case QuoteFieldTypeString:
+            return [self stringForField:field row:row];
+        case QuoteFieldTypeFixed: {
+            int64_t value = [self fixedForField:field row:row];
+            if (value == QUOTE_FIXED_MISSING) {
+                return nil;
+            }
+            // INT64_MIN is the missing marker, so negating value cannot overflow
+            return [NSDecimalNumber decimalNumberWithMantissa:(unsigned long long)(value < 0 ? -value : value)
+                                                     exponent:-(short)QuoteFieldDecimals(field)
+                                                   isNegative:value < 0];
+        }
+        case QuoteFieldTypeDouble: {
+            double value = [self doubleForField:field row:row];
+            return isnan(value) ? nil : [NSNumber numberWithDouble:value];
+        }
+    }
+}
+
+- (void)setValue:(id)value forField:(QuoteField)field row:(NSUInteger)row {
+    switch (QuoteFieldTypeOf(field)) {
+        case QuoteFieldTypeString:
+            [self setString:value forField:field row:row];
+            break;
+        case QuoteFieldTypeFixed:
+            [self setFixed:QuoteFixedFromNumber(value, QuoteFieldDecimals(field)) forField:field row:row];
+            break;
+        case QuoteFieldTypeDouble:
+            [self setDouble:value ? [value doubleValue] : NAN forField:field row:row];
+            break;
+    }
+}
+
+- (NSArray *)items {
+    return [[QuoteStoreItemArray alloc] initWithStore:self];
+}
+
+- (BOOL)isItemArray:(NSArray *)items {
+    return [items isKindOfClass:[QuoteStoreItemArray class]] && ((QuoteStoreItemArray *)items).store == self;
+}
+
+@end
+
+#pragma mark -
+
+@implementation QuoteStoreItemArray {
+    NSUInteger _count;
+    NSPointerArray *_items;
+}
+
+- (instancetype)initWithStore:(QuoteStore *)store {
+    self = [super init];
+    if (self) {
+        _store = store;
+        _count = store.rowCount;
+        _items = [NSPointerArray strongObjectsPointerArray];
+        _items.count = _count;
+    }
+    return self;
+}
+
+- (NSUInteger)count {
+    return _count;
+}
+
+- (id)objectAtIndex:(NSUInteger)index {
+    if (index >= _count) {
+        [NSException raise:NSRangeException format:@"index %lu beyond bounds [0 .. %lu]",
+         (unsigned long)index, (unsigned long)_count];
+    }
+    QuoteItem *item = (__bridge QuoteItem *)[_items pointerAtIndex:index];
+    if (!item) {
+        item = [[QuoteItem alloc] initWithStore:_store row:index];
+        [_items replacePointerAtIndex:index withPointer:(__bridge void *)item];
+    }
+    return item;
+}
+
+@end
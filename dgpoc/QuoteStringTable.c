@@ -0,0 +1,238 @@
+#include "QuoteStringTable.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#define QUOTE_STRING_TABLE_MIN_CAPACITY 16
+
+// FNV-1a; the strings are short symbols and names.
+static inline uint32_t QuoteStringHash(const char *bytes, size_t length) {
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < length; i++) {
+        hash = (hash ^ (uint8_t)bytes[i]) * 16777619u;
+    }
+    return hash;
+}
+
+static inline bool QuoteStringEquals(const QuoteStringTable *table, uint32_t id, const char *bytes, size_t length) {
+    size_t candidateLength;
+    const char *candidate = QuoteStringTableBytes(table, id, &candidateLength);
+    return candidateLength == length && memcmp(candidate, bytes, length) == 0;
+}
+
+static void QuoteStringTableInsertSlot(QuoteStringTable *table, uint32_t id) {
+    uint32_t i = table->hashes[id - 1] & table->slotMask;
+    while (table->slots[i]) {
+        i = (i + 1) & table->slotMask;
+    }
+    table->slots[i] = id;
+}
+
+// Sizes the slots for at least `count` strings at no more than half full and
+// re-inserts every string.
+static bool QuoteStringTableReindex(QuoteStringTable *table, uint32_t count) {
+    uint32_t slotCount = QUOTE_STRING_TABLE_MIN_CAPACITY * 2;
+    while (slotCount / 2 < count) {
+        if (slotCount > UINT32_MAX / 2) {
+            return false;
+        }
+        slotCount *= 2;
+    }
+    if (!table->slots || slotCount != table->slotMask + 1) {
+        uint32_t *slots = realloc(table->slots, slotCount * sizeof(uint32_t));
+        if (!slots) {
+            return false;
+        }
+        table->slots = slots;
+        table->slotMask = slotCount - 1;
+    }
+    memset(table->slots, 0, slotCount * sizeof(uint32_t));
+    for (uint32_t id = 1; id <= table->count; id++) {
+        if (id > table->hashed) {
+            size_t length;
+            const char *bytes = QuoteStringTableBytes(table, id, &length);
+            table->hashes[id - 1] = QuoteStringHash(bytes, length);
+        }
+        QuoteStringTableInsertSlot(table, id);
+    }
+    table->hashed = table->count;
+    table->indexed = true;
+    return true;
+}
+
+static bool QuoteStringTableReserve(QuoteStringTable *table, uint32_t count, size_t heapLength) {
+    if (count > table->capacity) {
+        uint32_t capacity = table->capacity ? table->capacity : QUOTE_STRING_TABLE_MIN_CAPACITY;
+        while (capacity < count) {
+            if (capacity > UINT32_MAX / 2 - 1) {
+                return false;
+            }
+            capacity *= 2;
+        }
+        uint32_t *offsets = realloc(table->offsets, ((size_t)capacity + 1) * sizeof(uint32_t));
+        if (!offsets) {
+            return false;
+        }
+        table->offsets = offsets;
+        uint32_t *hashes = realloc(table->hashes, (size_t)capacity * sizeof(uint32_t));
+        if (!hashes) {
+            return false;
+        }
+        table->hashes = hashes;
+        table->capacity = capacity;
+    }
+    if (heapLength > table->heapCapacity) {
+        if (heapLength > UINT32_MAX) {
+            return false;
+        }
+        size_t heapCapacity = table->heapCapacity ? table->heapCapacity : 256;
+        while (heapCapacity < heapLength) {
+            heapCapacity *= 2;
+        }
+        heapCapacity = heapCapacity > UINT32_MAX ? UINT32_MAX : heapCapacity;
+        char *heap = realloc(table->heap, heapCapacity);
+        if (!heap) {
+            return false;
+        }
+        table->heap = heap;
+        table->heapCapacity = (uint32_t)heapCapacity;
+    }
+    return true;
+}
+
+void QuoteStringTableInit(QuoteStringTable *table) {
+    memset(table, 0, sizeof(*table));
+    table->offsets = calloc(1, sizeof(uint32_t));
+    table->indexed = true;
+}
+
+void QuoteStringTableFree(QuoteStringTable *table) {
+    free(table->heap);
+    free(table->offsets);
+    free(table->hashes);
+    free(table->slots);
+    memset(table, 0, sizeof(*table));
+}
+
+static uint32_t QuoteStringTableLookup(QuoteStringTable *table, const char *bytes, size_t length, uint32_t hash) {
+    if (!table->indexed && !QuoteStringTableReindex(table, table->count)) {
+        return 0;
+    }
+    if (!table->slots) {
+        return 0;
+    }
+    for (uint32_t i = hash & table->slotMask; table->slots[i]; i = (i + 1) & table->slotMask) {
+        uint32_t id = table->slots[i];
+        if (table->hashes[id - 1] == hash && QuoteStringEquals(table, id, bytes, length)) {
+            return id;
+        }
+    }
+    return 0;
+}
+
+uint32_t QuoteStringTableFind(QuoteStringTable *table, const char *bytes, size_t length) {
+    return QuoteStringTableLookup(table, bytes, length, QuoteStringHash(bytes, length));
+}
+
+uint32_t QuoteStringTableIntern(QuoteStringTable *table, const char *bytes, size_t length) {
+    uint32_t hash = QuoteStringHash(bytes, length);
+    uint32_t id = QuoteStringTableLookup(table, bytes, length, hash);
+    if (id) {
+        return id;
+    }
+    if (table->count == UINT32_MAX - 1
+        || !QuoteStringTableReserve(table, table->count + 1, (size_t)table->heapLength + length)) {
+        return 0;
+    }
+    if ((size_t)(table->count + 1) * 2 > (size_t)table->slotMask + 1 || !table->slots) {
+        if (!QuoteStringTableReindex(table, table->count + 1)) {
+            return 0;
+        }
+    }
+
+    if (length) {
+        memcpy(table->heap + table->heapLength, bytes, length);
+    }
+    table->heapLength += (uint32_t)length;
+    id = ++table->count;
+    table->offsets[id] = table->heapLength;
+    table->hashes[id - 1] = hash;
+    table->hashed = id;
+    QuoteStringTableInsertSlot(table, id);
+    return id;
+}
+
+bool QuoteStringTableAppendStrings(QuoteStringTable *table, const char *heap,
+                                   const uint32_t *offsets, uint32_t count) {
+    if (count == 0) {
+        return true;
+    }
+    uint32_t length = offsets[count] - offsets[0];
+    if (count > UINT32_MAX - 1 - table->count
+        || !QuoteStringTableReserve(table, table->count + count, (size_t)table->heapLength + length)) {
+        return false;
+    }
+
+    if (length) {
+        memcpy(table->heap + table->heapLength, heap + offsets[0], length);
+    }
+    uint32_t base = table->heapLength - offsets[0];
+    for (uint32_t i = 0; i < count; i++) {
+        table->offsets[table->count + i + 1] = offsets[i + 1] + base;
+    }
+    table->count += count;
+    table->heapLength += length;
+    table->indexed = false;
+    return true;
+}
+
+static inline unsigned char QuoteFoldASCII(unsigned char c) {
+    return (c >= 'A' && c <= 'Z') ? (unsigned char)(c + ('a' - 'A')) : c;
+}
+
+int QuoteStringTableCompare(const QuoteStringTable *table, uint32_t a, uint32_t b, bool caseInsensitive) {
+    if (a == b) {
+        return 0;
+    }
+    if (a == 0 || b == 0) {
+        return a == 0 ? -1 : 1;
+    }
+    size_t lengthA, lengthB;
+    const unsigned char *bytesA = (const unsigned char *)QuoteStringTableBytes(table, a, &lengthA);
+    const unsigned char *bytesB = (const unsigned char *)QuoteStringTableBytes(table, b, &lengthB);
+    size_t common = lengthA < lengthB ? lengthA : lengthB;
+    if (!caseInsensitive) {
+        int order = memcmp(bytesA, bytesB, common);
+        if (order) {
+            return order < 0 ? -1 : 1;
+        }
+    } else {
+        for (size_t i = 0; i < common; i++) {
+            unsigned char foldedA = QuoteFoldASCII(bytesA[i]);
+            unsigned char foldedB = QuoteFoldASCII(bytesB[i]);
+            if (foldedA != foldedB) {
+                return foldedA < foldedB ? -1 : 1;
+            }
+        }
+    }
+    return (lengthA > lengthB) - (lengthA < lengthB);
+}
+
+int QuoteStringTableComparePrefix(const QuoteStringTable *table, uint32_t id, const char *prefix, size_t length,
+                                  bool caseInsensitive) {
+    if (id == 0) {
+        return -1;
+    }
+    size_t stringLength;
+    const unsigned char *bytes = (const unsigned char *)QuoteStringTableBytes(table, id, &stringLength);
+    const unsigned char *prefixBytes = (const unsigned char *)prefix;
+    size_t common = stringLength < length ? stringLength : length;
+    for (size_t i = 0; i < common; i++) {
+        unsigned char a = caseInsensitive ? QuoteFoldASCII(bytes[i]) : bytes[i];
+        unsigned char b = caseInsensitive ? QuoteFoldASCII(prefixBytes[i]) : prefixBytes[i];
+        if (a != b) {
+            return a < b ? -1 : 1;
+        }
+    }
+    return stringLength < length ? -1 : 0;
+}
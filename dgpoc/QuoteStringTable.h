@@ -0,0 +1,70 @@
+//
+//  QuoteStringTable.h
+//  dgpoc
+//
+//  Interns byte strings to dense ids so string columns can be stored as
+//  uint32 codes. Ids start at 1; 0 is never handed out and stands for "no
+//  string". Every distinct string is stored once, back to back in one heap,
+//  so id -> bytes is an array lookup.
+//
+//  Not thread safe; a table has one writer at a time.
+//
+
+#ifndef QuoteStringTable_h
+#define QuoteStringTable_h
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+typedef struct {
+    char *heap;
+    uint32_t heapLength;
+    uint32_t heapCapacity;
+    uint32_t *offsets;      // string id is heap[offsets[id - 1], offsets[id])
+    uint32_t *hashes;       // hashes[id - 1], filled for ids up to hashed
+    uint32_t hashed;
+    uint32_t count;
+    uint32_t capacity;
+    uint32_t *slots;        // open addressing over ids, 0 = empty
+    uint32_t slotMask;
+    bool indexed;           // slots are up to date with every string
+} QuoteStringTable;
+
+void QuoteStringTableInit(QuoteStringTable *table);
+void QuoteStringTableFree(QuoteStringTable *table);
+
+/// The id of bytes, adding them if they are new. Returns 0 only when the
+/// table cannot grow.
+uint32_t QuoteStringTableIntern(QuoteStringTable *table, const char *bytes, size_t length);
+
+/// The id of bytes, or 0 if the table does not hold them.
+uint32_t QuoteStringTableFind(QuoteStringTable *table, const char *bytes, size_t length);
+
+/// Appends count strings laid out like the table's own heap: string i is
+/// heap[offsets[i], offsets[i + 1]). They take the next ids in order. The
+/// strings must be distinct and not already in the table; the lookup index is
+/// rebuilt on the next Intern or Find rather than per string.
+bool QuoteStringTableAppendStrings(QuoteStringTable *table, const char *heap,
+                                   const uint32_t *offsets, uint32_t count);
+
+/// Orders two ids by their bytes, shorter first on a common prefix, as
+/// -1, 0 or 1. Case-insensitive folds ASCII letters only. Id 0 orders first.
+int QuoteStringTableCompare(const QuoteStringTable *table, uint32_t a, uint32_t b, bool caseInsensitive);
+
+/// Orders an id's string against a prefix the same way, as -1, 0 or 1,
+/// with 0 for a string that begins with it; in that order the strings with
+/// a prefix are one run. Id 0 orders first.
+int QuoteStringTableComparePrefix(const QuoteStringTable *table, uint32_t id, const char *prefix, size_t length,
+                                  bool caseInsensitive);
+
+static inline uint32_t QuoteStringTableCount(const QuoteStringTable *table) {
+    return table->count;
+}
+
+static inline const char *QuoteStringTableBytes(const QuoteStringTable *table, uint32_t id, size_t *length) {
+    *length = table->offsets[id] - table->offsets[id - 1];
+    return table->heap + table->offsets[id - 1];
+}
+
+#endif /* QuoteStringTable_h */
@@ -0,0 +1,43 @@
+//
+//  QuoteSymbolIndex.h
+//  dgpoc
+//
+//  The rows whose symbol or underlying symbol begins with a prefix, found
+//  without looking at any other row, for search as you type. Tickers are
+//  kept in case-insensitive order (QuoteStore stringRanks), so the tickers
+//  with a prefix are one run found by binary search, and each ticker keeps
+//  a list of the rows holding it in each column. A lookup costs about
+//  prefix length x log(tickers) compares plus a step per row returned.
+//
+//  Rows appended to the store are indexed on the next lookup, a few words
+//  each. A change to the symbol or underlying of a row already indexed must
+//  be reported with updateRows:, which moves it to its new ticker's list.
+//  Case is folded for ASCII letters only, as in the sort; tickers are ASCII.
+//
+
+#import <Foundation/Foundation.h>
+#import "QuoteStore.h"
+
+@interface QuoteSymbolIndex : NSObject
+
+@property (nonatomic, readonly) QuoteStore *store;
+/// Rows indexed so far.
+@property (nonatomic, readonly) NSUInteger rowCount;
+
+- (instancetype)initWithStore:(QuoteStore *)store NS_DESIGNATED_INITIALIZER;
+- (instancetype)init NS_UNAVAILABLE;
+
+/// Ids, as ascending uint32s, of every row whose symbol or underlying
+/// symbol begins with prefix, so "AAPL" finds the equity and all its
+/// options. An empty prefix finds every row with a ticker.
+- (NSData *)rowsWithPrefix:(NSString *)prefix;
+
+/// The same over the columns in fields: QuoteFieldSymbol, or
+/// QuoteFieldUnderlyingSymbol, or both.
+- (NSData *)rowsWithPrefix:(NSString *)prefix fields:(QuoteFieldMask)fields;
+
+/// Re-lists rows whose symbol or underlying symbol changed. Each move walks
+/// the old ticker's list.
+- (void)updateRows:(const uint32_t *)rows count:(NSUInteger)count;
+
+@end
@@ -0,0 +1,261 @@
+#import "QuoteSymbolIndex.h"
+#import "QuoteKeySort.h"
+
+// Ends a list, and marks a ticker with no rows.
+static const uint32_t kQuoteSymbolIndexEnd = UINT32_MAX;
+
+// The indexed columns, in list order.
+static const QuoteField kQuoteSymbolIndexFields[2] = {QuoteFieldSymbol, QuoteFieldUnderlyingSymbol};
+
+@implementation QuoteSymbolIndex {
+    // per column: by row, the next row on the same ticker's list and the
+    // ticker the row is listed under; by ticker code, its first and last row
+    uint32_t *_next[2];
+    uint32_t *_codes[2];
+    uint32_t *_heads[2];
+    uint32_t *_tails[2];
+    NSUInteger _rowCapacity;
+    uint32_t _codeCount;        // codes the heads cover, 0 included
+    uint32_t *_tickers;         // codes 1... in case-insensitive order
+    uint32_t _tickerCount;
+}
+
+- (instancetype)initWithStore:(QuoteStore *)store {
+    NSParameterAssert(store);
+    self = [super init];
+    if (self) {
+        _store = store;
+    }
+    return self;
+}
+
+- (void)dealloc {
+    for (int column = 0; column < 2; column++) {
+        free(_next[column]);
+        free(_codes[column]);
+        free(_heads[column]);
+        free(_tails[column]);
+    }
+    free(_tickers);
+}
+
+- (NSData *)rowsWithPrefix:(NSString *)prefix {
+    return [self rowsWithPrefix:prefix fields:QuoteFieldMaskOf(QuoteFieldSymbol)
+            | QuoteFieldMaskOf(QuoteFieldUnderlyingSymbol)];
+}
+
+- (NSData *)rowsWithPrefix:(NSString *)prefix fields:(QuoteFieldMask)fields {
+    [self indexAppendedRows];
+    const char *bytes = prefix.UTF8String ?: "";
+    size_t length = strlen(bytes);
+    QuoteStringTable *table = [_store stringTableForField:QuoteFieldSymbol];
+
+    // the run of tickers beginning with prefix
+    uint32_t low = 0, high = _tickerCount;
+    while (low < high) {
+        uint32_t middle = low + (high - low) / 2;
+        if (QuoteStringTableComparePrefix(table, _tickers[middle], bytes, length, true) < 0) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+    uint32_t first = low;
+    high = _tickerCount;
+    while (low < high) {
+        uint32_t middle = low + (high - low) / 2;
+        if (QuoteStringTableComparePrefix(table, _tickers[middle], bytes, length, true) <= 0) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+    uint32_t end = low;
+    if (first == end) {
+        return [NSData data];
+    }
+
+    BOOL symbols = (fields & QuoteFieldMaskOf(QuoteFieldSymbol)) != 0;
+    BOOL underlyings = (fields & QuoteFieldMaskOf(QuoteFieldUnderlyingSymbol)) != 0;
+    const uint32_t *ranks = [_store stringRanksForField:QuoteFieldSymbol caseInsensitive:YES];
+    uint32_t rankLow = ranks[_tickers[first]];
+    uint32_t rankWidth = ranks[_tickers[end - 1]] - rankLow;
+    NSMutableData *found = [NSMutableData dataWithLength:64 * sizeof(QuoteSortEntry)];
+    NSUInteger count = 0;
+    for (uint32_t i = first; i < end; i++) {
+        uint32_t code = _tickers[i];
+        for (int column = 0; column < 2; column++) {
+            if (!(column == 0 ? symbols : underlyings)) {
+                continue;
+            }
+            for (uint32_t row = _heads[column][code]; row != kQuoteSymbolIndexEnd; row = _next[column][row]) {
+                // an option of a matching underlying whose own symbol matches
+                // too is already on the symbol lists
+                if (column == 1 && symbols && ranks[_codes[0][row]] - rankLow <= rankWidth) {
+                    continue;
+                }
+                if (count == found.length / sizeof(QuoteSortEntry)) {
+                    found.length *= 2;
+                }
+                QuoteSortEntry *entry = (QuoteSortEntry *)found.mutableBytes + count;
+                entry->hi = row;
+                entry->lo = 0;
+                entry->index = (uint32_t)count++;
+            }
+        }
+    }
+
+    // lists are in the order rows were listed; hand them back in id order
+    QuoteSortEntry *entries = found.mutableBytes;
+    QuoteSortEntry *scratch = malloc(MAX(count, 1) * sizeof(QuoteSortEntry));
+    if (!scratch) {
+        [NSException raise:NSMallocException format:@"QuoteSymbolIndex cannot sort %lu rows", (unsigned long)count];
+    }
+    QuoteSortEntries(entries, scratch, count, 8, 1);
+    free(scratch);
+    NSMutableData *rows = [NSMutableData dataWithLength:count * sizeof(uint32_t)];
+    uint32_t *rowIds = rows.mutableBytes;
+    for (NSUInteger i = 0; i < count; i++) {
+        rowIds[i] = (uint32_t)entries[i].hi;
+    }
+    return rows;
+}
+
+- (void)updateRows:(const uint32_t *)rows count:(NSUInteger)count {
+    [self indexAppendedRows];
+    for (int column = 0; column < 2; column++) {
+        const uint32_t *codes = [_store codeColumn:kQuoteSymbolIndexFields[column]];
+        for (NSUInteger i = 0; i < count; i++) {
+            uint32_t row = rows[i];
+            if (row < _rowCount && _codes[column][row] != codes[row]) {
+                [self unlistRow:row column:column];
+                [self listRow:row code:codes[row] column:column];
+            }
+        }
+    }
+}
+
+#pragma mark -
+
+// Lists rows appended since the last call, first growing the heads for new
+// tickers and putting the tickers back in order.
+- (void)indexAppendedRows {
+    QuoteStringTable *table = [_store stringTableForField:QuoteFieldSymbol];
+    uint32_t codeCount = QuoteStringTableCount(table) + 1;
+    if (codeCount != _codeCount) {
+        [self growCodesTo:codeCount];
+        [self sortTickers];
+    }
+    NSUInteger rowCount = _store.rowCount;
+    if (rowCount == _rowCount) {
+        return;
+    }
+    if (rowCount > _rowCapacity) {
+        NSUInteger capacity = MAX(_rowCapacity * 2, rowCount);
+        for (int column = 0; column < 2; column++) {
+            uint32_t *next = realloc(_next[column], capacity * sizeof(uint32_t));
+            if (next) {
+                _next[column] = next;
+            }
+            uint32_t *codes = realloc(_codes[column], capacity * sizeof(uint32_t));
+            if (codes) {
+                _codes[column] = codes;
+            }
+            if (!next || !codes) {
+                [NSException raise:NSMallocException format:@"QuoteSymbolIndex cannot hold %lu rows",
+                 (unsigned long)capacity];
+            }
+        }
+        _rowCapacity = capacity;
+    }
+    for (int column = 0; column < 2; column++) {
+        const uint32_t *codes = [_store codeColumn:kQuoteSymbolIndexFields[column]];
+        for (NSUInteger row = _rowCount; row < rowCount; row++) {
+            [self listRow:(uint32_t)row code:codes[row] column:column];
+        }
+    }
+    _rowCount = rowCount;
+}
+
+- (void)growCodesTo:(uint32_t)codeCount {
+    for (int column = 0; column < 2; column++) {
+        uint32_t *heads = realloc(_heads[column], codeCount * sizeof(uint32_t));
+        if (heads) {
+            _heads[column] = heads;
+        }
+        uint32_t *tails = realloc(_tails[column], codeCount * sizeof(uint32_t));
+        if (tails) {
+            _tails[column] = tails;
+        }
+        if (!heads || !tails) {
+            [NSException raise:NSMallocException format:@"QuoteSymbolIndex cannot hold %u tickers", codeCount];
+        }
+        memset(heads + _codeCount, 0xFF, (codeCount - _codeCount) * sizeof(uint32_t));
+        memset(tails + _codeCount, 0xFF, (codeCount - _codeCount) * sizeof(uint32_t));
+    }
+    _codeCount = codeCount;
+}
+
+// Counting sort of the codes by case-insensitive rank; equal ranks keep
+// code order.
+- (void)sortTickers {
+    const uint32_t *ranks = [_store stringRanksForField:QuoteFieldSymbol caseInsensitive:YES];
+    uint32_t tickerCount = _codeCount - 1;
+    uint32_t *tickers = realloc(_tickers, MAX(tickerCount, 1) * sizeof(uint32_t));
+    uint32_t *starts = calloc((size_t)_codeCount + 1, sizeof(uint32_t));
+    if (tickers) {
+        _tickers = tickers;
+    }
+    if (!tickers || !starts) {
+        free(starts);
+        _tickerCount = 0;
+        [NSException raise:NSMallocException format:@"QuoteSymbolIndex cannot order %u tickers", tickerCount];
+    }
+    for (uint32_t code = 1; code < _codeCount; code++) {
+        starts[ranks[code] + 1]++;
+    }
+    for (uint32_t rank = 1; rank <= _codeCount; rank++) {
+        starts[rank] += starts[rank - 1];
+    }
+    for (uint32_t code = 1; code < _codeCount; code++) {
+        tickers[starts[ranks[code]]++] = code;
+    }
+    free(starts);
+    _tickerCount = tickerCount;
+}
+
+- (void)listRow:(uint32_t)row code:(uint32_t)code column:(int)column {
+    _codes[column][row] = code;
+    _next[column][row] = kQuoteSymbolIndexEnd;
+    if (code == 0) {
+        return;
+    }
+    uint32_t tail = _tails[column][code];
+    if (tail == kQuoteSymbolIndexEnd) {
+        _heads[column][code] = row;
+    } else {
+        _next[column][tail] = row;
+    }
+    _tails[column][code] = row;
+}
+
+- (void)unlistRow:(uint32_t)row column:(int)column {
+    uint32_t code = _codes[column][row];
+    if (code == 0) {
+        return;
+    }
+    uint32_t previous = kQuoteSymbolIndexEnd;
+    for (uint32_t current = _heads[column][code]; current != row; current = _next[column][current]) {
+        previous = current;
+    }
+    if (previous == kQuoteSymbolIndexEnd) {
+        _heads[column][code] = _next[column][row];
+    } else {
+        _next[column][previous] = _next[column][row];
+    }
+    if (_tails[column][code] == row) {
+        _tails[column][code] = previous;
+    }
+}
+
+@end
@@ -0,0 +1,94 @@
+//
+//  QuoteBenchmark.h
+//  dgpocTests
+//
+//  Fixtures and measurement helpers shared by the loader/sort benchmarks.
+//
+
+#import <Foundation/Foundation.h>
+#import "QuoteStore.h"
+
+/// The row model from before QuoteStore: one object per row, every value
+/// boxed. Kept as the baseline the columnar store is measured against.
+@interface QuoteObject : NSObject
+
+@property (nonatomic, strong)  NSString *assetType;
+@property (nonatomic, strong)  NSString *symbol;
+@property (nonatomic, strong)  NSString *symbolName;
+@property (nonatomic, strong)  NSString *underlyingSymbol;
+@property (nonatomic, strong)  NSNumber *lastTrade;
+@property (nonatomic, strong)  NSString *lastTradeDate;
+@property (nonatomic, strong)  NSString *lastTradeTime;
+@property (nonatomic, strong)  NSNumber *changePercentChange;
+@property (nonatomic, strong)  NSNumber *change;
+@property (nonatomic, strong)  NSNumber *open;
+@property (nonatomic, strong)  NSNumber *daysHigh;
+@property (nonatomic, strong)  NSNumber *daysLow;
+@property (nonatomic, strong)  NSNumber *volume;
+@property (nonatomic, strong)  NSNumber *ask;
+@property (nonatomic, strong)  NSNumber *averageDailyVolume;
+@property (nonatomic, strong)  NSNumber *askSize;
+@property (nonatomic, strong)  NSNumber *FiftyTwoWeekHigh;
+@property (nonatomic, strong)  NSNumber *changeFrom52weekHigh;
+@property (nonatomic, strong)  NSNumber *percentChangeFrom52weeklow;
+@property (nonatomic, strong)  NSString *FiftyTwoWeekRange;
+@property (nonatomic, strong)  NSNumber *bid;
+@property (nonatomic, strong)  NSNumber *bidSize;
+@property (nonatomic, strong)  NSNumber *FiftyDayMovingAverage;
+@property (nonatomic, strong)  NSNumber *earningsShare;
+
+/// Symbol sort keys built from scratch on every access, as QuoteItem did
+/// before the store cached them.
+@property (nonatomic, readonly) NSString *symbolSortAscending;
+@property (nonatomic, readonly) NSString *symbolSortDescending;
+
+@end
+
+@interface QuoteBenchmark : NSObject
+
+/// YES when the environment sets QUOTE_BENCHMARKS, as a scheme's test
+/// action can (or TEST_RUNNER_QUOTE_BENCHMARKS=1 on the xcodebuild command
+/// line). The large benchmarks, mostly of a million rows or more, return
+/// early without it, so a plain test run stays a quick check of correctness.
++ (BOOL)runsLargeBenchmarks;
+
+/// A CSV with the canned header and rowCount rows, built by cycling the rows of
+/// quotes.csv. Generated once per row count and cached in the temp directory.
++ (NSURL *)csvURLWithRowCount:(NSUInteger)rowCount;
+
+/// Every field of csvURLWithRowCount: decoded into a store.
++ (QuoteStore *)storeWithRowCount:(NSUInteger)rowCount;
+
+/// The same with the fixed and double fields in spread offset row by row
+/// (up to 9999 ticks, or 9.999), so that most rows differ in them: the
+/// fixture cycles a hundred quotes, which would leave every sort by them
+/// long runs of ties. Missing values stay missing.
++ (QuoteStore *)storeWithRowCount:(NSUInteger)rowCount spreadingFields:(QuoteFieldMask)spread;
+
+/// A file of contractCount OCC option symbols, one per line, across a few
+/// dozen underlyings, a year of expiries and both rights. Generated once per
+/// count and cached in the temp directory.
++ (NSURL *)optionChainURLWithContractCount:(NSUInteger)contractCount;
+
+/// QuoteObjects loaded the way the app did before the mapped scanner:
+/// whole-file string, row strings, field strings.
++ (NSArray *)quoteObjectsFromCSVAtURL:(NSURL *)url;
+
+/// Physical footprint of this process, in bytes: the dirty memory it is
+/// charged for. Free pages malloc holds are released first, so the reading
+/// falls again as memory is freed and two readings give what was kept
+/// between them.
++ (uint64_t)footprintBytes;
+
+/// Current resident set size of this process, in bytes.
++ (uint64_t)residentBytes;
+
+/// The net change in live heap blocks across the block, read before its
+/// autorelease pool drains. Blocks it both allocated and freed do not show,
+/// so this is what it left allocated, not how often it allocated.
++ (NSInteger)liveBlocksAddedDuring:(void (^)(void))block;
+
+/// Wall time of the block in seconds, best of the given number of runs.
++ (NSTimeInterval)bestTimeOfRuns:(NSUInteger)runs block:(void (^)(void))block;
+
+@end
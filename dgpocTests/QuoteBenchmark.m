@@ -0,0 +1,224 @@
+#import "QuoteBenchmark.h"
+#import "QuoteItemDataMaker.h"
+#import "QuotePrice.h"
+
+#import <malloc/malloc.h>
+#import <mach/mach.h>
+#import <mach/mach_time.h>
+
+@implementation QuoteObject
+
+- (NSString *)symbolSortAscending {
+    if ([self.assetType isEqualToString:@"E"]) {
+        return [NSString stringWithFormat:@"%@_0", self.symbol];
+    } else if ([self.assetType isEqualToString:@"O"]) {
+        return [self createOptionSortKey];
+    }
+    return self.symbol;
+}
+
+- (NSString *)symbolSortDescending {
+    if ([self.assetType isEqualToString:@"E"]) {
+        return [NSString stringWithFormat:@"%@_9", self.symbol];
+    } else if ([self.assetType isEqualToString:@"O"]) {
+        return [self createOptionSortKey];
+    }
+    return self.symbol;
+}
+
+- (NSString *)createOptionSortKey {
+    NSRange offset = [self.symbol rangeOfString:@"_"];
+    offset.location++;
+    offset.length = 2;
+    NSString *month = [self.symbol substringWithRange:offset];
+    offset.location += offset.length;
+    NSString *day = [self.symbol substringWithRange:offset];
+    offset.location += offset.length;
+    NSString *year = [self.symbol substringWithRange:offset];
+    offset.location += offset.length;
+    offset.length = 1;
+    NSString *type = [self.symbol substringWithRange:offset];
+    offset.location += offset.length;
+    offset.length = self.symbol.length - offset.location;
+    NSString *strike = [self.symbol substringWithRange:offset];
+    return [NSString stringWithFormat:@"%@_%@_%@_%@_%@_%@", self.underlyingSymbol, year, month, day, strike, type];
+}
+
+@end
+
+@implementation QuoteBenchmark
+
++ (BOOL)runsLargeBenchmarks {
+    return [NSProcessInfo processInfo].environment[@"QUOTE_BENCHMARKS"].length > 0;
+}
+
++ (NSURL *)csvURLWithRowCount:(NSUInteger)rowCount {
+    NSString *name = [NSString stringWithFormat:@"quotes-%lu.csv", (unsigned long)rowCount];
+    NSURL *url = [NSURL fileURLWithPath:[NSTemporaryDirectory() stringByAppendingPathComponent:name]];
+    if ([[NSFileManager defaultManager] fileExistsAtPath:url.path]) {
+        return url;
+    }
+
+    NSURL *cannedURL = [[NSBundle mainBundle] URLForResource:@"quotes" withExtension:@"csv"];
+    NSString *canned = [NSString stringWithContentsOfURL:cannedURL encoding:NSUTF8StringEncoding error:NULL];
+    NSArray *lines = [canned componentsSeparatedByCharactersInSet:[NSCharacterSet newlineCharacterSet]];
+    NSString *header = lines[0];
+    NSArray *rows = [[lines subarrayWithRange:NSMakeRange(1, lines.count - 1)]
+                     filteredArrayUsingPredicate:[NSPredicate predicateWithFormat:@"length > 0"]];
+
+    NSMutableData *out = [NSMutableData data];
+    [out appendData:[[header stringByAppendingString:@"\n"] dataUsingEncoding:NSUTF8StringEncoding]];
+    for (NSUInteger i = 0; i < rowCount; i++) {
+        @autoreleasepool {
+            NSString *row = [rows[i % rows.count] stringByAppendingString:@"\n"];
+            [out appendData:[row dataUsingEncoding:NSUTF8StringEncoding]];
+        }
+    }
+    [out writeToURL:url atomically:YES];
+    return url;
+}
+
++ (QuoteStore *)storeWithRowCount:(NSUInteger)rowCount {
+    return [self storeWithRowCount:rowCount spreadingFields:0];
+}
+
++ (QuoteStore *)storeWithRowCount:(NSUInteger)rowCount spreadingFields:(QuoteFieldMask)spread {
+    NSURL *url = [self csvURLWithRowCount:rowCount];
+    QuoteStore *store = [QuoteItemDataMaker projectionOfCSVAtURL:url fields:QuoteFieldMaskAll].store;
+    for (QuoteField field = 0; field < QuoteFieldCount; field++) {
+        if (!(spread & QuoteFieldMaskOf(field))) {
+            continue;
+        }
+        if (QuoteFieldTypeOf(field) == QuoteFieldTypeFixed) {
+            int64_t *values = [store fixedColumn:field];
+            for (NSUInteger row = 0; row < store.rowCount; row++) {
+                if (values[row] != QUOTE_FIXED_MISSING) {
+                    values[row] += (int64_t)((row * 7919) % 10000);
+                }
+            }
+        } else if (QuoteFieldTypeOf(field) == QuoteFieldTypeDouble) {
+            double *values = [store doubleColumn:field];
+            for (NSUInteger row = 0; row < store.rowCount; row++) {
+                values[row] += (double)((row * 7919) % 10000) / 1000;
+            }
+        }
+    }
+    return store;
+}
+
++ (NSURL *)optionChainURLWithContractCount:(NSUInteger)contractCount {
+    NSString *name = [NSString stringWithFormat:@"chain-%lu.txt", (unsigned long)contractCount];
+    NSURL *url = [NSURL fileURLWithPath:[NSTemporaryDirectory() stringByAppendingPathComponent:name]];
+    if ([[NSFileManager defaultManager] fileExistsAtPath:url.path]) {
+        return url;
+    }
+
+    static const char *roots[] = { "AAPL", "FSLR", "SPXW", "MSFT", "GOOGL", "AMZN", "BRKB", "X", "GE", "F",
+                                   "SWHC", "LPTH", "MBTF", "NFLX", "TSLA", "QQQ", "SPY", "IWM", "EEM", "XLF" };
+    const size_t rootCount = sizeof(roots) / sizeof(roots[0]);
+    NSMutableData *out = [NSMutableData dataWithCapacity:contractCount * 22];
+    char line[32];
+    for (NSUInteger i = 0; i < contractCount; i++) {
+        unsigned month = (unsigned)(i / rootCount % 12) + 1;
+        unsigned day = (unsigned)(i / rootCount / 12 % 28) + 1;
+        unsigned strike = (unsigned)(i / rootCount / 12 / 28 % 4000) * 500 + 1000;
+        int length = snprintf(line, sizeof(line), "%-6s%02u%02u%02u%c%08u\n", roots[i % rootCount],
+                              16 + (unsigned)(i % 3), month, day, (i & 1) ? 'P' : 'C', strike);
+        [out appendBytes:line length:(NSUInteger)length];
+    }
+    [out writeToURL:url atomically:YES];
+    return url;
+}
+
++ (NSArray *)quoteObjectsFromCSVAtURL:(NSURL *)url {
+    NSMutableArray *dataList = [[NSMutableArray alloc] init];
+    NSData *data = [NSData dataWithContentsOfURL:url];
+    NSString *fileContents = [[NSString alloc] initWithData:data encoding:NSUTF8StringEncoding];
+
+    NSMutableArray *rows = [[fileContents componentsSeparatedByString:@"\n"] mutableCopy];
+    [rows removeObjectAtIndex:0];
+
+    for (NSString *row in rows) {
+        NSArray *c = [row componentsSeparatedByString:@","];
+        if (c.count < 24) {
+            continue;
+        }
+        QuoteObject *q = [[QuoteObject alloc] init];
+        int i = 0;
+        q.assetType = c[i++];
+        q.symbol = c[i++];
+        q.symbolName = c[i++];
+        q.underlyingSymbol = c[i++];
+        q.lastTrade = [NSNumber numberWithDouble:[c[i++] doubleValue]];
+        q.lastTradeDate = c[i++];
+        q.lastTradeTime = c[i++];
+        q.changePercentChange = [NSNumber numberWithDouble:[c[i++] doubleValue]];
+        q.change = [NSNumber numberWithDouble:[c[i++] doubleValue]];
+        q.open = [NSNumber numberWithDouble:[c[i++] doubleValue]];
+        q.daysHigh = [NSNumber numberWithDouble:[c[i++] doubleValue]];
+        q.daysLow = [NSNumber numberWithDouble:[c[i++] doubleValue]];
+        q.volume = [NSNumber numberWithDouble:[c[i++] doubleValue]];
+        q.ask = [NSNumber numberWithDouble:[c[i++] doubleValue]];
+        q.averageDailyVolume = [NSNumber numberWithDouble:[c[i++] doubleValue]];
+        q.askSize = [NSNumber numberWithDouble:[c[i++] doubleValue]];
+        q.FiftyTwoWeekHigh = [NSNumber numberWithDouble:[c[i++] doubleValue]];
+        q.changeFrom52weekHigh = [NSNumber numberWithDouble:[c[i++] doubleValue]];
+        q.percentChangeFrom52weeklow = [NSNumber numberWithDouble:[c[i++] doubleValue]];
+        q.FiftyTwoWeekRange = c[i++];
+        q.bid = [NSNumber numberWithDouble:[c[i++] doubleValue]];
+        q.bidSize = [NSNumber numberWithDouble:[c[i++] doubleValue]];
+        q.FiftyDayMovingAverage = [NSNumber numberWithDouble:[c[i++] doubleValue]];
+        q.earningsShare = [NSNumber numberWithDouble:[c[i++] doubleValue]];
+        [dataList addObject:q];
+    }
+    return dataList;
+}
+
++ (uint64_t)footprintBytes {
+    // hand free pages malloc still holds back to the system first
+    malloc_zone_pressure_relief(NULL, 0);
+    task_vm_info_data_t info;
+    mach_msg_type_number_t count = TASK_VM_INFO_COUNT;
+    if (task_info(mach_task_self(), TASK_VM_INFO, (task_info_t)&info, &count) != KERN_SUCCESS) {
+        return 0;
+    }
+    return info.phys_footprint;
+}
+
++ (uint64_t)residentBytes {
+    struct mach_task_basic_info info;
+    mach_msg_type_number_t count = MACH_TASK_BASIC_INFO_COUNT;
+    if (task_info(mach_task_self(), MACH_TASK_BASIC_INFO, (task_info_t)&info, &count) != KERN_SUCCESS) {
+        return 0;
+    }
+    return info.resident_size;
+}
+
++ (NSInteger)liveBlocksAddedDuring:(void (^)(void))block {
+    malloc_statistics_t before, after;
+    @autoreleasepool {
+        malloc_zone_statistics(NULL, &before);
+        block();
+        malloc_zone_statistics(NULL, &after);
+    }
+    return (NSInteger)after.blocks_in_use - (NSInteger)before.blocks_in_use;
+}
+
++ (NSTimeInterval)bestTimeOfRuns:(NSUInteger)runs block:(void (^)(void))block {
+    static mach_timebase_info_data_t timebase;
+    if (timebase.denom == 0) {
+        mach_timebase_info(&timebase);
+    }
+    uint64_t best = UINT64_MAX;
+    for (NSUInteger i = 0; i < runs; i++) {
+        @autoreleasepool {
+            uint64_t start = mach_absolute_time();
+            block();
+            uint64_t elapsed = mach_absolute_time() - start;
+            best = MIN(best, elapsed);
+        }
+    }
+    return (NSTimeInterval)best * timebase.numer / timebase.denom / 1e9;
+}
+
+@end
@@ -0,0 +1,282 @@
+//
+//  QuoteFilterEngineTests.m
+//  dgpocTests
+//
+
+#import <XCTest/XCTest.h>
+#import <IG/IG.h>
+
+#import "IGGridViewSortingDataSourceHelper.h"
+#import "QuoteBenchmark.h"
+#import "QuoteFilterEngine.h"
+#import "QuoteStore.h"
+
+static const NSUInteger kFilterBenchmarkRowCount = 1000000;
+
+@interface QuoteFilterEngineTests : XCTestCase
+
+@end
+
+@implementation QuoteFilterEngineTests
+
+- (NSPredicate *)predicateWithKey:(NSString *)key condition:(QuoteFilterCondition)condition value:(NSString *)value {
+    NSArray *formats = @[@"%K CONTAINS[cd] %@", @"%K BEGINSWITH[cd] %@", @"%K ENDSWITH[cd] %@", @"%K LIKE[cd] %@",
+                         @"%K MATCHES[cd] %@", @"%K == %@", @"%K != %@", @"%K > %@", @"%K >= %@", @"%K < %@",
+                         @"%K <= %@"];
+    id argument = condition < QuoteFilterConditionEqual ? value : [NSDecimalNumber decimalNumberWithString:value];
+    return [NSPredicate predicateWithFormat:formats[condition], key, argument];
+}
+
+- (void)testMatchesPredicates {
+    QuoteStore *store = [QuoteBenchmark storeWithRowCount:5000];
+    [store setFixed:QUOTE_FIXED_MISSING forField:QuoteFieldLastTrade row:7];
+    [store setDouble:NAN forField:QuoteFieldChangePercentChange row:8];
+    [store setString:nil forField:QuoteFieldSymbolName row:9];
+    QuoteFilterEngine *engine = [[QuoteFilterEngine alloc] initWithStore:store];
+    NSArray *items = [store items];
+    QuoteFilterOptions folding = QuoteFilterCaseInsensitive | QuoteFilterDiacriticInsensitive;
+
+    NSArray *cases = @[@[@"symbolName", @(QuoteFilterConditionContains), @"sOLAR"],
+                       @[@"symbolName", @(QuoteFilterConditionBeginsWith), @"fslr feb"],
+                       @[@"symbolName", @(QuoteFilterConditionEndsWith), @"CALL"],
+                       @[@"symbolName", @(QuoteFilterConditionLike), @"*jan ?? 2016*"],
+                       @[@"symbol", @(QuoteFilterConditionMatches), @"fslr_0[12].*"],
+                       @[@"underlyingSymbol", @(QuoteFilterConditionContains), @"sl"],
+                       @[@"lastTrade", @(QuoteFilterConditionEqual), @"11.77"],
+                       @[@"lastTrade", @(QuoteFilterConditionEqual), @"11.770001"],
+                       @[@"lastTrade", @(QuoteFilterConditionNotEqual), @"11.77"],
+                       @[@"lastTrade", @(QuoteFilterConditionGreater), @"11.77"],
+                       @[@"lastTrade", @(QuoteFilterConditionGreaterOrEqual), @"11.769999"],
+                       @[@"lastTrade", @(QuoteFilterConditionLess), @"-0.00001"],
+                       @[@"lastTrade", @(QuoteFilterConditionLessOrEqual), @"3.15"],
+                       @[@"volume", @(QuoteFilterConditionGreater), @"2444586.5"],
+                       @[@"changePercentChange", @(QuoteFilterConditionGreater), @"1"],
+                       @[@"changePercentChange", @(QuoteFilterConditionNotEqual), @"0.0204"],
+                       @[@"changePercentChange", @(QuoteFilterConditionLessOrEqual), @"-2.5"]];
+    for (NSArray *filter in cases) {
+        NSString *key = filter[0];
+        QuoteFilterCondition condition = [filter[1] unsignedIntegerValue];
+        XCTAssertTrue([engine canFilterKey:key condition:condition]);
+        QuoteFilterPredicate *predicate = [engine predicateWithKey:key condition:condition value:filter[2]
+                                                           options:folding];
+        NSArray *expected = [items filteredArrayUsingPredicate:[self predicateWithKey:key condition:condition
+                                                                                 value:filter[2]]];
+        NSArray *filtered = [engine filteredItems:items usingPredicate:predicate];
+        XCTAssertEqualObjects(filtered, expected, @"%@", filter);
+    }
+
+    XCTAssertFalse([engine canFilterKey:@"symbolName" condition:QuoteFilterConditionGreater]);
+    XCTAssertFalse([engine canFilterKey:@"lastTrade" condition:QuoteFilterConditionContains]);
+    XCTAssertFalse([engine canFilterKey:@"symbolSortAscending" condition:QuoteFilterConditionContains]);
+    QuoteFilterPredicate *garbage = [engine predicateWithKey:@"bid" condition:QuoteFilterConditionGreater value:@"abc"
+                                                     options:folding];
+    XCTAssertEqual([engine filteredItems:items usingPredicate:garbage].count, 0u);
+}
+
+- (void)testFoldsStringsInternedLater {
+    QuoteStore *store = [QuoteBenchmark storeWithRowCount:100];
+    QuoteFilterEngine *engine = [[QuoteFilterEngine alloc] initWithStore:store];
+    QuoteFilterPredicate *folded = [engine predicateWithKey:@"symbolName" condition:QuoteFilterConditionContains
+                                                      value:@"societe"
+                                                    options:QuoteFilterCaseInsensitive | QuoteFilterDiacriticInsensitive];
+    QuoteFilterPredicate *exact = [engine predicateWithKey:@"symbolName" condition:QuoteFilterConditionContains
+                                                     value:@"societe" options:0];
+    XCTAssertEqual([engine filteredItems:[store items] usingPredicate:folded].count, 0u);
+
+    NSUInteger row = [store appendRows:1];
+    [store setString:@"Société Générale SA" forField:QuoteFieldSymbolName row:row];
+    NSArray *items = [store items];
+    XCTAssertEqualObjects([engine filteredItems:items usingPredicate:folded], @[items[row]]);
+    XCTAssertEqual([engine filteredItems:items usingPredicate:exact].count, 0u);
+}
+
+- (void)testHelperFiltersLikeIG {
+    NSArray *items = [[QuoteBenchmark storeWithRowCount:2000] items];
+    IGGridViewDataSourceHelper *ig = [[IGGridViewDataSourceHelper alloc] init];
+    IGGridViewSortingDataSourceHelper *helper = [[IGGridViewSortingDataSourceHelper alloc] init];
+    NSArray *filters = @[@[@"symbolName", @(IGGridViewFilterConditionTypeStringContains), @"wesson"],
+                         @[@"bid", @(IGGridViewFilterConditionTypeNumberGreaterThan), @"25"]];
+    for (NSArray *filter in filters) {
+        for (IGGridViewDataSourceHelper *source in @[ig, helper]) {
+            source.filteringKey = filter[0];
+            source.filterType = [filter[1] integerValue];
+        }
+        NSArray *filtered = [helper applyFilterForValue:filter[2] toData:items];
+        XCTAssertEqualObjects(filtered, [ig applyFilterForValue:filter[2] toData:items], @"%@", filter);
+        XCTAssertNotNil(helper.filterEngine);
+    }
+}
+
+- (void)testRefinesAsQueryGrows {
+    QuoteStore *store = [QuoteBenchmark storeWithRowCount:5000];
+    QuoteFilterEngine *engine = [[QuoteFilterEngine alloc] initWithStore:store];
+    NSArray *items = [store items];
+    QuoteFilterOptions folding = QuoteFilterCaseInsensitive | QuoteFilterDiacriticInsensitive;
+    NSArray *keystrokes = @[@"s", @"so", @"sol", @"solar", @"sola", @"so", @"s", @"ola", @"olar", @"x", @"s"];
+    for (NSNumber *condition in @[@(QuoteFilterConditionContains), @(QuoteFilterConditionBeginsWith),
+                                  @(QuoteFilterConditionEndsWith)]) {
+        NSMutableDictionary *results = [NSMutableDictionary dictionary];
+        for (NSString *value in keystrokes) {
+            QuoteFilterPredicate *predicate = [engine predicateWithKey:@"symbolName"
+                                                             condition:condition.unsignedIntegerValue
+                                                                 value:value options:folding];
+            NSArray *refined = [engine refinedItems:items usingPredicate:predicate];
+            XCTAssertEqualObjects(refined, [engine filteredItems:items usingPredicate:predicate], @"%@ %@",
+                                  condition, value);
+            // a backspace to a query still kept hands its result back; "so"
+            // does not end with "s", so ends-with keeps one result at a time
+            if (results[value] && ![value isEqualToString:@"s"]
+                && condition.unsignedIntegerValue != QuoteFilterConditionEndsWith) {
+                XCTAssertTrue(refined == results[value], @"%@ %@", condition, value);
+            }
+            results[value] = refined;
+        }
+    }
+
+    for (NSString *query in @[@"f", @"fi", @"first", @"first s", @"first so", @"first sol", @"first so", @"wes",
+                              @"wesson", @"wesson sm", @"wes"]) {
+        XCTAssertEqualObjects([engine refinedItemsMatchingName:query inItems:items],
+                              [engine itemsMatchingName:query inItems:items], @"%@", query);
+    }
+
+    // a change to the field drops what was kept
+    QuoteFilterPredicate *solar = [engine predicateWithKey:@"symbolName" condition:QuoteFilterConditionContains
+                                                     value:@"solar" options:folding];
+    NSUInteger count = [engine refinedItems:items usingPredicate:solar].count;
+    [store setString:@"Solar Two" forField:QuoteFieldSymbolName row:0];
+    XCTAssertEqual([engine refinedItems:items usingPredicate:solar].count, count + 1);
+}
+
+- (void)testTypingLatency {
+    if (![QuoteBenchmark runsLargeBenchmarks]) {
+        return;
+    }
+    QuoteStore *store = [QuoteBenchmark storeWithRowCount:kFilterBenchmarkRowCount];
+    NSArray *items = [store items];
+    QuoteFilterEngine *engine = [[QuoteFilterEngine alloc] initWithStore:store];
+    QuoteFilterOptions folding = QuoteFilterCaseInsensitive | QuoteFilterDiacriticInsensitive;
+    NSTimeInterval fullTotal = 0, refinedTotal = 0;
+    // typed, then backspaced
+    NSArray *keystrokes = @[@"s", @"so", @"sol", @"sola", @"solar", @"sola", @"sol", @"so", @"s"];
+    for (NSUInteger keystroke = 0; keystroke < keystrokes.count; keystroke++) {
+        NSString *value = keystrokes[keystroke];
+        __block NSArray *full = nil, *refined = nil;
+        NSTimeInterval fullTime = [QuoteBenchmark bestTimeOfRuns:1 block:^{
+            QuoteFilterPredicate *predicate = [engine predicateWithKey:@"symbolName"
+                                                             condition:QuoteFilterConditionContains
+                                                                 value:value options:folding];
+            full = [engine filteredItems:items usingPredicate:predicate];
+        }];
+        NSTimeInterval refinedTime = [QuoteBenchmark bestTimeOfRuns:1 block:^{
+            QuoteFilterPredicate *predicate = [engine predicateWithKey:@"symbolName"
+                                                             condition:QuoteFilterConditionContains
+                                                                 value:value options:folding];
+            refined = [engine refinedItems:items usingPredicate:predicate];
+        }];
+        NSLog(@"keystroke %@ of %lu rows: refined %.2f ms, full %.2f ms, %lu matches", value,
+              (unsigned long)kFilterBenchmarkRowCount, refinedTime * 1000, fullTime * 1000,
+              (unsigned long)refined.count);
+        XCTAssertEqual(refined.count, full.count, @"%@", value);
+        if (keystroke > keystrokes.count / 2) {
+            XCTAssertLessThan(refinedTime * 10, fullTime, @"backspace to %@", value);
+        }
+        fullTotal += fullTime;
+        refinedTotal += refinedTime;
+    }
+    XCTAssertLessThan(refinedTotal, fullTotal);
+}
+
+- (void)testFilterLatencyAgainstIG {
+    if (![QuoteBenchmark runsLargeBenchmarks]) {
+        return;
+    }
+    QuoteStore *store = [QuoteBenchmark storeWithRowCount:kFilterBenchmarkRowCount];
+    NSArray *items = [store items];
+    IGGridViewDataSourceHelper *ig = [[IGGridViewDataSourceHelper alloc] init];
+    QuoteFilterEngine *engine = [[QuoteFilterEngine alloc] initWithStore:store];
+    NSArray *filters = @[@[@"symbolName", @(IGGridViewFilterConditionTypeStringContains), @"solar"],
+                         @[@"lastTrade", @(IGGridViewFilterConditionTypeNumberGreaterThan), @"10"],
+                         @[@"changePercentChange", @(IGGridViewFilterConditionTypeNumberLessThan), @"0"]];
+
+    for (NSArray *filter in filters) {
+        ig.filteringKey = filter[0];
+        ig.filterType = [filter[1] integerValue];
+        __block NSArray *expected = nil;
+        __block NSArray *filtered = nil;
+        NSTimeInterval igTime = [QuoteBenchmark bestTimeOfRuns:1 block:^{
+            expected = [ig applyFilterForValue:filter[2] toData:items];
+        }];
+        QuoteFilterCondition condition = [filter[1] unsignedIntegerValue];
+        QuoteFilterOptions folding = QuoteFilterCaseInsensitive | QuoteFilterDiacriticInsensitive;
+        NSTimeInterval engineTime = [QuoteBenchmark bestTimeOfRuns:3 block:^{
+            // compiling is part of every keystroke, so it is timed too
+            QuoteFilterPredicate *predicate = [engine predicateWithKey:filter[0] condition:condition value:filter[2]
+                                                               options:folding];
+            filtered = [engine filteredItems:items usingPredicate:predicate];
+        }];
+
+        NSLog(@"filter %@ of %lu rows: engine %.1f ms, IG %.1f ms, %lu matches", filter,
+              (unsigned long)kFilterBenchmarkRowCount, engineTime * 1000, igTime * 1000, (unsigned long)filtered.count);
+        XCTAssertEqual(filtered.count, expected.count, @"%@", filter);
+        XCTAssertLessThan(engineTime * 10, igTime, @"%@", filter);
+    }
+}
+
+// The rows planted per store are spaced more than a page of row pointers
+// apart at every size, so each size touches as many pages as it has
+// matches.
+- (void)testSortedTypingLatencyAcrossStoreSizes {
+    if (![QuoteBenchmark runsLargeBenchmarks]) {
+        return;
+    }
+    const NSUInteger plantedCount = 250;
+    NSArray *rowCounts = @[@200000, @600000, @2000000];
+    // typed, then backspaced; only the planted symbols start with Z
+    NSArray *keystrokes = @[@"z", @"zq", @"zqx", @"zqx0", @"zqx01", @"zqx0", @"zqx", @"zq", @"z"];
+    NSMutableArray *keystrokeTimes = [NSMutableArray array];
+    for (NSNumber *rowCount in rowCounts) {
+        NSUInteger rows = rowCount.unsignedIntegerValue;
+        QuoteStore *store = [QuoteBenchmark storeWithRowCount:rows];
+        for (NSUInteger planted = 0; planted < plantedCount; planted++) {
+            NSString *symbol = [NSString stringWithFormat:@"ZQX%03lu", (unsigned long)planted];
+            [store setString:symbol forField:QuoteFieldSymbol row:planted * (rows / plantedCount)];
+        }
+        NSArray *items = [store items];
+        IGGridViewSortingDataSourceHelper *helper = [[IGGridViewSortingDataSourceHelper alloc] init];
+        helper.data = items;
+        helper.filteringKey = @"symbol";
+        helper.filterType = IGGridViewFilterConditionTypeStringBeginsWith;
+        helper.filteringCaseInsensitivity = YES;
+        [helper.sortedColumns addObject:[[IGGridViewSortedColumn alloc] initWithField:@"lastTrade"
+                                                                         forDirection:IGGridViewSortedColumnDirectionDescending]];
+        // builds the symbol index outside the timing
+        [helper applyFilterForValue:keystrokes.firstObject toData:items];
+
+        __block NSArray *sorted = nil;
+        NSTimeInterval typingTime = [QuoteBenchmark bestTimeOfRuns:3 block:^{
+            [helper.filterEngine forgetRefinements];
+            for (NSString *value in keystrokes) {
+                NSArray *filtered = [helper applyFilterForValue:value toData:items];
+                sorted = [helper applySort:@"lastTrade" toData:filtered ascending:NO caseInsensitive:NO];
+                [sorted subarrayWithRange:NSMakeRange(0, MIN(sorted.count, (NSUInteger)30))];
+            }
+        }];
+        NSTimeInterval keystrokeTime = typingTime / keystrokes.count;
+        NSLog(@"sorted typing over %lu rows: %.3f ms a keystroke", (unsigned long)rows, keystrokeTime * 1000);
+        XCTAssertEqual(sorted.count, plantedCount);
+        for (NSUInteger index = 1; index < sorted.count; index++) {
+            NSNumber *previous = [sorted[index - 1] lastTrade], *trade = [sorted[index] lastTrade];
+            // missing trades sort last when descending
+            XCTAssertTrue(!trade || (previous && previous.doubleValue >= trade.doubleValue), @"row %lu",
+                          (unsigned long)index);
+        }
+        [keystrokeTimes addObject:@(keystrokeTime)];
+    }
+    // ten times the rows, the same matches: a keystroke should cost about
+    // the same, give or take a fixed allowance for timer and allocator noise
+    NSTimeInterval smallest = [keystrokeTimes.firstObject doubleValue];
+    NSTimeInterval largest = [keystrokeTimes.lastObject doubleValue];
+    XCTAssertLessThan(largest, smallest * 2 + 0.0005);
+}
+
+@end
@@ -0,0 +1,293 @@
+//
+//  QuoteItemDataMakerTests.m
+//  dgpocTests
+//
+
+#import <XCTest/XCTest.h>
+
+#import "QuoteBenchmark.h"
+#import "QuoteCSVScanner.h"
+#import "QuoteItem.h"
+#import "QuoteItemDataMaker.h"
+#import "QuoteNumberParser.h"
+
+static const NSUInteger kBenchmarkRowCount = 200000;
+static const NSUInteger kScalingRowCount = 1000000;
+
+static NSString *PositionalString(QuoteCSVField field) {
+    return [[NSString alloc] initWithBytes:field.bytes length:field.length encoding:NSUTF8StringEncoding];
+}
+
+static NSNumber *PositionalNumber(QuoteCSVField field) {
+    double value;
+    QuoteParseDouble(field.bytes, field.length, &value);
+    return [NSNumber numberWithDouble:value];
+}
+
+// The mapped scanner with every field at a hard-coded position, as the
+// loader decoded rows before the header-driven plan. Benchmark baseline.
+static NSArray *QuoteItemsFromCSVByPosition(NSURL *url) {
+    NSMutableArray *dataList = [[NSMutableArray alloc] init];
+    NSData *data = [NSData dataWithContentsOfURL:url options:NSDataReadingMappedAlways error:NULL];
+    QuoteCSVScanner scanner;
+    QuoteCSVScannerInit(&scanner, data.bytes, data.length);
+    QuoteCSVScannerSkipRow(&scanner);
+
+    QuoteCSVField c[QuoteFieldCount];
+    size_t count;
+    while ((count = QuoteCSVScannerNextRow(&scanner, c, QuoteFieldCount))) {
+        if (count < QuoteFieldCount) {
+            continue;
+        }
+        @autoreleasepool {
+            QuoteObject *q = [[QuoteObject alloc] init];
+            q.assetType = PositionalString(c[QuoteFieldAssetType]);
+            q.symbol = PositionalString(c[QuoteFieldSymbol]);
+            q.symbolName = PositionalString(c[QuoteFieldSymbolName]);
+            q.underlyingSymbol = PositionalString(c[QuoteFieldUnderlyingSymbol]);
+            q.lastTrade = PositionalNumber(c[QuoteFieldLastTrade]);
+            q.lastTradeDate = PositionalString(c[QuoteFieldLastTradeDate]);
+            q.lastTradeTime = PositionalString(c[QuoteFieldLastTradeTime]);
+            q.changePercentChange = PositionalNumber(c[QuoteFieldChangePercentChange]);
+            q.change = PositionalNumber(c[QuoteFieldChange]);
+            q.open = PositionalNumber(c[QuoteFieldOpen]);
+            q.daysHigh = PositionalNumber(c[QuoteFieldDaysHigh]);
+            q.daysLow = PositionalNumber(c[QuoteFieldDaysLow]);
+            q.volume = PositionalNumber(c[QuoteFieldVolume]);
+            q.ask = PositionalNumber(c[QuoteFieldAsk]);
+            q.averageDailyVolume = PositionalNumber(c[QuoteFieldAverageDailyVolume]);
+            q.askSize = PositionalNumber(c[QuoteFieldAskSize]);
+            q.FiftyTwoWeekHigh = PositionalNumber(c[QuoteFieldFiftyTwoWeekHigh]);
+            q.changeFrom52weekHigh = PositionalNumber(c[QuoteFieldChangeFrom52weekHigh]);
+            q.percentChangeFrom52weeklow = PositionalNumber(c[QuoteFieldPercentChangeFrom52weeklow]);
+            q.FiftyTwoWeekRange = PositionalString(c[QuoteFieldFiftyTwoWeekRange]);
+            q.bid = PositionalNumber(c[QuoteFieldBid]);
+            q.bidSize = PositionalNumber(c[QuoteFieldBidSize]);
+            q.FiftyDayMovingAverage = PositionalNumber(c[QuoteFieldFiftyDayMovingAverage]);
+            q.earningsShare = PositionalNumber(c[QuoteFieldEarningsShare]);
+            [dataList addObject:q];
+        }
+    }
+    return dataList;
+}
+
+@interface QuoteItemDataMakerTests : XCTestCase
+
+@end
+
+@implementation QuoteItemDataMakerTests
+
+- (void)testCannedDataLoadsEveryRow {
+    NSArray *items = [QuoteItemDataMaker quoteItemsFromCannedData];
+    XCTAssertEqual(items.count, 101u);
+
+    QuoteItem *first = items.firstObject;
+    XCTAssertEqualObjects(first.assetType, @"E");
+    XCTAssertEqualObjects(first.symbol, @"SWHC");
+    XCTAssertEqualObjects(first.symbolName, @"Smith & Wesson Holding Corporat");
+    XCTAssertEqualWithAccuracy(first.lastTrade.doubleValue, -25.9, 1e-9);
+    XCTAssertEqualWithAccuracy(first.earningsShare.doubleValue, 1.03, 1e-9);
+}
+
+- (void)testQuotedFieldsKeepTheirCommas {
+    NSString *csv = @"Asset Type,Symbol,Name,Underlying Symbol,Last Trade,Last Trade Date,Last Trade Time,Change & Percent Change,Change,Open,Day's High,Day's Low,Volume,Ask,Average Daily Volume,Ask Size,52-week High,Change From 52-week High,Percent Change From 52-week Low,52-week Range,Bid,Bid Size,50-day Moving Average,Earnings/Share\r\n"
+        @"E,SWHC,\"Smith, Wesson \"\"SW\"\" Holding\",SWHC,25.9,1/5/16,3:36pm,2.5075,2.62,25.59,26.54,25.01,13893855,25.9,1509530,200,26.54,-0.64,175.83,\"9.39 - 26.54\",25.89,100,20.44,1.03\r\n"
+        @"\r\n";
+    NSURL *url = [NSURL fileURLWithPath:[NSTemporaryDirectory() stringByAppendingPathComponent:@"quoted.csv"]];
+    [csv writeToURL:url atomically:YES encoding:NSUTF8StringEncoding error:NULL];
+
+    NSArray *items = [QuoteItemDataMaker quoteItemsFromCSVAtURL:url];
+    XCTAssertEqual(items.count, 1u);
+
+    QuoteItem *item = items.firstObject;
+    XCTAssertEqualObjects(item.symbolName, @"Smith, Wesson \"SW\" Holding");
+    XCTAssertEqualObjects(item.underlyingSymbol, @"SWHC");
+    XCTAssertEqualObjects(item.FiftyTwoWeekRange, @"9.39 - 26.54");
+    XCTAssertEqualWithAccuracy(item.earningsShare.doubleValue, 1.03, 1e-9);
+}
+
+- (void)testMatchesStringSplittingLoader {
+    NSURL *url = [QuoteBenchmark csvURLWithRowCount:1000];
+    NSArray *expected = [QuoteBenchmark quoteObjectsFromCSVAtURL:url];
+    NSArray *actual = [QuoteItemDataMaker quoteItemsFromCSVAtURL:url];
+
+    XCTAssertEqual(actual.count, expected.count);
+    for (NSUInteger i = 0; i < actual.count; i++) {
+        QuoteItem *a = actual[i];
+        QuoteObject *e = expected[i];
+        XCTAssertEqualObjects(a.symbol, e.symbol);
+        XCTAssertEqualObjects(a.FiftyTwoWeekRange, e.FiftyTwoWeekRange);
+        XCTAssertEqualWithAccuracy(a.bid.doubleValue, e.bid.doubleValue, 1e-9);
+        XCTAssertEqualObjects(a.earningsShare, e.earningsShare);
+    }
+}
+
+- (void)testMappedLoaderThroughput {
+    NSURL *url = [QuoteBenchmark csvURLWithRowCount:kBenchmarkRowCount];
+
+    // what each loader's rows keep, measured ahead of the timed runs so
+    // that neither reuses memory those freed
+    NSArray *loaded = nil;
+    uint64_t before = [QuoteBenchmark footprintBytes];
+    @autoreleasepool {
+        loaded = [QuoteItemDataMaker quoteItemsFromCSVAtURL:url];
+    }
+    int64_t mappedBytes = (int64_t)([QuoteBenchmark footprintBytes] - before);
+    loaded = nil;
+
+    before = [QuoteBenchmark footprintBytes];
+    @autoreleasepool {
+        loaded = [QuoteBenchmark quoteObjectsFromCSVAtURL:url];
+    }
+    int64_t splitBytes = (int64_t)([QuoteBenchmark footprintBytes] - before);
+    loaded = nil;
+
+    __block NSUInteger rows = 0;
+    NSTimeInterval mapped = [QuoteBenchmark bestTimeOfRuns:3 block:^{
+        rows = [QuoteItemDataMaker quoteItemsFromCSVAtURL:url].count;
+    }];
+    NSTimeInterval split = [QuoteBenchmark bestTimeOfRuns:3 block:^{
+        [QuoteBenchmark quoteObjectsFromCSVAtURL:url];
+    }];
+
+    NSLog(@"mapped: %.0f rows/s, footprint +%.1f MB", rows / mapped, mappedBytes / 1048576.0);
+    NSLog(@"split:  %.0f rows/s, footprint +%.1f MB", rows / split, splitBytes / 1048576.0);
+    XCTAssertEqual(rows, kBenchmarkRowCount);
+    XCTAssertLessThan(mappedBytes, splitBytes);
+}
+
+- (void)testParallelLoadKeepsFileOrder {
+    NSURL *url = [QuoteBenchmark csvURLWithRowCount:10007];
+    NSArray *serial = [QuoteItemDataMaker quoteItemsFromCSVAtURL:url concurrency:1];
+    for (NSNumber *concurrency in @[@2, @3, @8, @64]) {
+        NSArray *parallel = [QuoteItemDataMaker quoteItemsFromCSVAtURL:url concurrency:concurrency.unsignedIntegerValue];
+        XCTAssertEqualObjects([parallel valueForKey:@"symbol"], [serial valueForKey:@"symbol"], @"concurrency %@", concurrency);
+        XCTAssertEqualObjects([parallel valueForKey:@"lastTrade"], [serial valueForKey:@"lastTrade"], @"concurrency %@", concurrency);
+    }
+}
+
+- (void)testParallelLoadScaling {
+    if (![QuoteBenchmark runsLargeBenchmarks]) {
+        return;
+    }
+    NSURL *url = [QuoteBenchmark csvURLWithRowCount:kScalingRowCount];
+    NSTimeInterval baseline = 0;
+    for (NSNumber *threads in @[@1, @2, @4, @8]) {
+        __block NSUInteger rows = 0;
+        NSTimeInterval elapsed = [QuoteBenchmark bestTimeOfRuns:3 block:^{
+            rows = [QuoteItemDataMaker quoteItemsFromCSVAtURL:url concurrency:threads.unsignedIntegerValue].count;
+        }];
+        if (baseline == 0) {
+            baseline = elapsed;
+        }
+        NSLog(@"%@ threads: %.0f rows/s, %.2fx", threads, rows / elapsed, baseline / elapsed);
+        XCTAssertEqual(rows, kScalingRowCount);
+    }
+}
+
+- (void)testProjectionDecodesOnlyRequestedFieldsAndBackfills {
+    NSURL *url = [QuoteBenchmark csvURLWithRowCount:5000];
+    NSArray *full = [QuoteItemDataMaker quoteItemsFromCSVAtURL:url];
+    QuoteItemProjection *projection = [QuoteItemDataMaker projectionOfCSVAtURL:url
+                                                                         fields:QuoteFieldMaskOf(QuoteFieldBid)
+                                                                    concurrency:3];
+
+    QuoteItem *first = projection.items.firstObject;
+    XCTAssertEqual(projection.decodedFields, QuoteFieldMaskIdentity | QuoteFieldMaskOf(QuoteFieldBid));
+    XCTAssertNotNil(first.symbol);
+    XCTAssertNotNil(first.bid);
+    XCTAssertNil(first.lastTrade);
+    XCTAssertNil(first.FiftyTwoWeekRange);
+
+    [projection decodeFields:QuoteFieldMaskOf(QuoteFieldLastTrade) | QuoteFieldMaskOf(QuoteFieldFiftyTwoWeekRange)];
+    XCTAssertEqualObjects([projection.items valueForKey:@"lastTrade"], [full valueForKey:@"lastTrade"]);
+    XCTAssertEqualObjects([projection.items valueForKey:@"FiftyTwoWeekRange"], [full valueForKey:@"FiftyTwoWeekRange"]);
+    XCTAssertNil(first.volume);
+}
+
+- (void)testLoadCostScalesWithProjectedFields {
+    NSURL *url = [QuoteBenchmark csvURLWithRowCount:kBenchmarkRowCount];
+    QuoteFieldMask displayed = QuoteFieldMaskOf(QuoteFieldLastTrade) | QuoteFieldMaskOf(QuoteFieldBid)
+        | QuoteFieldMaskOf(QuoteFieldAsk) | QuoteFieldMaskOf(QuoteFieldOpen)
+        | QuoteFieldMaskOf(QuoteFieldDaysHigh) | QuoteFieldMaskOf(QuoteFieldDaysLow);
+    NSDictionary *projections = @{ @"identity": @(QuoteFieldMaskIdentity),
+                                   @"default columns": @(displayed),
+                                   @"all": @(QuoteFieldMaskAll) };
+
+    [projections enumerateKeysAndObjectsUsingBlock:^(NSString *name, NSNumber *fields, BOOL *stop) {
+        NSTimeInterval elapsed = [QuoteBenchmark bestTimeOfRuns:3 block:^{
+            [QuoteItemDataMaker projectionOfCSVAtURL:url fields:fields.unsignedIntValue concurrency:1];
+        }];
+        NSLog(@"%@ (%d fields): %.0f rows/s", name, __builtin_popcount(fields.unsignedIntValue | QuoteFieldMaskIdentity),
+              kBenchmarkRowCount / elapsed);
+    }];
+}
+
+- (void)testColumnsAreFoundByHeader {
+    NSString *csv = @"Symbol,Feed Sequence,Bid,Asset Type,Underlying Symbol,Name,Last Trade\r\n"
+        @"SWHC,17,25.89,E,SWHC,Smith & Wesson Holding Corporat,-25.9\r\n"
+        @"FSLR_012016C100,18,1.5,O,FSLR,First Solar Jan 16 100 Call\r\n"
+        @"TRUNCATED,19\r\n"
+        @"\r\n";
+    NSURL *url = [NSURL fileURLWithPath:[NSTemporaryDirectory() stringByAppendingPathComponent:@"reordered.csv"]];
+    [csv writeToURL:url atomically:YES encoding:NSUTF8StringEncoding error:NULL];
+
+    NSArray *items = [QuoteItemDataMaker quoteItemsFromCSVAtURL:url];
+    XCTAssertEqual(items.count, 2u);
+
+    QuoteItem *equity = items[0];
+    XCTAssertEqualObjects(equity.assetType, @"E");
+    XCTAssertEqualObjects(equity.symbol, @"SWHC");
+    XCTAssertEqualObjects(equity.symbolName, @"Smith & Wesson Holding Corporat");
+    XCTAssertEqualWithAccuracy(equity.bid.doubleValue, 25.89, 1e-9);
+    XCTAssertEqualWithAccuracy(equity.lastTrade.doubleValue, -25.9, 1e-9);
+    XCTAssertNil(equity.ask);
+
+    QuoteItem *option = items[1];
+    XCTAssertEqualObjects(option.underlyingSymbol, @"FSLR");
+    XCTAssertNil(option.lastTrade);
+}
+
+- (void)testBlankFieldsStayMissing {
+    NSString *csv = @"Symbol,Asset Type,Underlying Symbol,Name,Bid,Change,Earnings/Share\r\n"
+        @"SWHC,E,SWHC,Smith & Wesson Holding Corporat,,,N/A\r\n"
+        @"FSLR,E,FSLR,\"First Solar, Inc.\",63.5,0,-1.5\r\n"
+        @"\r\n";
+    NSURL *url = [NSURL fileURLWithPath:[NSTemporaryDirectory() stringByAppendingPathComponent:@"blank.csv"]];
+    [csv writeToURL:url atomically:YES encoding:NSUTF8StringEncoding error:NULL];
+
+    NSArray *items = [QuoteItemDataMaker quoteItemsFromCSVAtURL:url];
+    XCTAssertEqual(items.count, 2u);
+
+    QuoteItem *blank = items[0];
+    XCTAssertNil(blank.bid);
+    XCTAssertNil(blank.change);
+    XCTAssertNil(blank.earningsShare);
+
+    QuoteItem *filled = items[1];
+    XCTAssertEqualWithAccuracy(filled.bid.doubleValue, 63.5, 1e-9);
+    XCTAssertEqualObjects(filled.change, @0);
+    XCTAssertEqualWithAccuracy(filled.earningsShare.doubleValue, -1.5, 1e-9);
+}
+
+- (void)testHeaderPlanIsAsFastAsPositionalDecoding {
+    if (![QuoteBenchmark runsLargeBenchmarks]) {
+        return;
+    }
+    NSURL *url = [QuoteBenchmark csvURLWithRowCount:kBenchmarkRowCount];
+
+    __block NSUInteger rows = 0;
+    NSTimeInterval positional = [QuoteBenchmark bestTimeOfRuns:3 block:^{
+        rows = QuoteItemsFromCSVByPosition(url).count;
+    }];
+    NSTimeInterval planned = [QuoteBenchmark bestTimeOfRuns:3 block:^{
+        [QuoteItemDataMaker quoteItemsFromCSVAtURL:url concurrency:1];
+    }];
+
+    NSLog(@"positional: %.0f rows/s", rows / positional);
+    NSLog(@"planned:    %.0f rows/s", rows / planned);
+    // catches a plan that costs per field or per row, not scheduling noise
+    XCTAssertLessThan(planned, positional * 1.25);
+}
+
+@end
@@ -0,0 +1,173 @@
+//
+//  QuoteKeySortTests.m
+//  dgpocTests
+//
+
+#import <XCTest/XCTest.h>
+
+#import "QuoteBenchmark.h"
+#import "QuoteKeySort.h"
+#import "QuotePrice.h"
+
+typedef NS_ENUM(NSUInteger, QuoteKeyKind) {
+    QuoteKeyKindPrice,
+    QuoteKeyKindDouble,
+    QuoteKeyKindRank,
+    QuoteKeyKindPacked,
+};
+
+static const size_t kCrossoverCounts[] = { 1000, 2000, 4000, 10000, 100000, 1000000, 10000000 };
+static const size_t kScalingCount = 4000000;
+
+// Keys shaped like the columns they stand for, with plenty of ties.
+static void QuoteFillEntries(QuoteSortEntry *entries, size_t count, QuoteKeyKind kind) {
+    for (size_t i = 0; i < count; i++) {
+        entries[i].index = (uint32_t)i;
+        entries[i].lo = 0;
+        switch (kind) {
+            case QuoteKeyKindPrice:
+                entries[i].hi = QuoteSortBitsOfFixed(QuotePriceFromCents(arc4random_uniform(50000)));
+                break;
+            case QuoteKeyKindDouble:
+                entries[i].hi = QuoteSortBitsOfDouble(((double)arc4random_uniform(200000) - 100000) / 7);
+                break;
+            case QuoteKeyKindRank:
+                entries[i].hi = arc4random_uniform(300);
+                break;
+            case QuoteKeyKindPacked:
+                entries[i].hi = arc4random_uniform(50);
+                entries[i].lo = ((uint64_t)arc4random() << 32) | arc4random_uniform(4);
+                break;
+        }
+    }
+}
+
+static size_t QuoteKeyBytes(QuoteKeyKind kind) {
+    return kind == QuoteKeyKindPacked ? 16 : 8;
+}
+
+@interface QuoteKeySortTests : XCTestCase
+
+@end
+
+@implementation QuoteKeySortTests
+
+- (void)testRadixMatchesMerge {
+    for (QuoteKeyKind kind = QuoteKeyKindPrice; kind <= QuoteKeyKindPacked; kind++) {
+        for (size_t count = 0; count < 50000; count = count * 3 + 1) {
+            QuoteSortEntry *merged = malloc(2 * MAX(count, 1) * sizeof(QuoteSortEntry));
+            QuoteSortEntry *radixed = malloc(2 * MAX(count, 1) * sizeof(QuoteSortEntry));
+            QuoteFillEntries(merged, count, kind);
+            memcpy(radixed, merged, count * sizeof(QuoteSortEntry));
+
+            QuoteSortEntriesMerge(merged, merged + count, count);
+            QuoteSortEntriesRadix(radixed, radixed + count, count, QuoteKeyBytes(kind));
+            // equal keys keep input order either way, so the indexes agree
+            BOOL same = YES;
+            for (size_t i = 0; i < count; i++) {
+                same = same && merged[i].index == radixed[i].index;
+            }
+            XCTAssertTrue(same, @"kind %lu, %zu keys", (unsigned long)kind, count);
+            free(merged);
+            free(radixed);
+        }
+    }
+}
+
+- (void)testParallelMatchesMerge {
+    const size_t counts[] = { 0, 1, 17, 5000, 300000 };
+    for (QuoteKeyKind kind = QuoteKeyKindPrice; kind <= QuoteKeyKindPacked; kind++) {
+        for (size_t c = 0; c < sizeof(counts) / sizeof(counts[0]); c++) {
+            size_t count = counts[c];
+            QuoteSortEntry *merged = malloc(2 * MAX(count, 1) * sizeof(QuoteSortEntry));
+            QuoteSortEntry *parallel = malloc(2 * MAX(count, 1) * sizeof(QuoteSortEntry));
+            QuoteFillEntries(merged, count, kind);
+            QuoteSortEntriesMerge(merged, merged + count, count);
+            for (size_t workers = 2; workers <= 9; workers += 7) {
+                // the keys merged was sorted from, in input order
+                for (size_t i = 0; i < count; i++) {
+                    parallel[merged[i].index] = merged[i];
+                }
+                QuoteSortEntriesParallel(parallel, parallel + count, count, QuoteKeyBytes(kind), workers);
+                XCTAssertEqual(memcmp(parallel, merged, count * sizeof(QuoteSortEntry)), 0,
+                               @"kind %lu, %zu keys, %zu workers", (unsigned long)kind, count, workers);
+            }
+            free(merged);
+            free(parallel);
+        }
+    }
+}
+
+- (void)testSortedKeysStayPut {
+    QuoteSortEntry entries[2 * 1000];
+    QuoteFillEntries(entries, 1000, QuoteKeyKindDouble);
+    QuoteSortEntriesRadix(entries, entries + 1000, 1000, 8);
+    QuoteSortEntry sorted[1000];
+    memcpy(sorted, entries, sizeof(sorted));
+    QuoteSortEntriesRadix(entries, entries + 1000, 1000, 16);
+    XCTAssertEqual(memcmp(entries, sorted, sizeof(sorted)), 0);
+}
+
+- (void)testRadixCrossover {
+    if (![QuoteBenchmark runsLargeBenchmarks]) {
+        return;
+    }
+    NSMutableString *report = [NSMutableString string];
+    for (QuoteKeyKind kind = QuoteKeyKindPrice; kind <= QuoteKeyKindPacked; kind++) {
+        [report appendFormat:@"\n%lu:", (unsigned long)kind];
+        for (size_t s = 0; s < sizeof(kCrossoverCounts) / sizeof(kCrossoverCounts[0]); s++) {
+            size_t count = kCrossoverCounts[s];
+            QuoteSortEntry *source = malloc(count * sizeof(QuoteSortEntry));
+            QuoteSortEntry *entries = malloc(2 * count * sizeof(QuoteSortEntry));
+            QuoteFillEntries(source, count, kind);
+            NSUInteger runs = count >= 1000000 ? 1 : 3;
+
+            NSTimeInterval mergeTime = [QuoteBenchmark bestTimeOfRuns:runs block:^{
+                memcpy(entries, source, count * sizeof(QuoteSortEntry));
+                QuoteSortEntriesMerge(entries, entries + count, count);
+            }];
+            NSTimeInterval radixTime = [QuoteBenchmark bestTimeOfRuns:runs block:^{
+                memcpy(entries, source, count * sizeof(QuoteSortEntry));
+                QuoteSortEntriesRadix(entries, entries + count, count, QuoteKeyBytes(kind));
+            }];
+            [report appendFormat:@" %zu merge %.3f ms radix %.3f ms,", count, mergeTime * 1000, radixTime * 1000];
+            if (count >= 100000) {
+                XCTAssertLessThan(radixTime, mergeTime, @"kind %lu, %zu keys", (unsigned long)kind, count);
+            }
+            free(source);
+            free(entries);
+        }
+    }
+    NSLog(@"merge against radix sort, radix from %d keys:%@", QUOTE_SORT_RADIX_MINIMUM, report);
+}
+
+- (void)testParallelScaling {
+    if (![QuoteBenchmark runsLargeBenchmarks]) {
+        return;
+    }
+    size_t cores = [NSProcessInfo processInfo].activeProcessorCount;
+    QuoteSortEntry *source = malloc(kScalingCount * sizeof(QuoteSortEntry));
+    QuoteSortEntry *entries = malloc(2 * kScalingCount * sizeof(QuoteSortEntry));
+    QuoteFillEntries(source, kScalingCount, QuoteKeyKindPrice);
+
+    NSMutableString *report = [NSMutableString string];
+    NSTimeInterval serialTime = 0, bestTime = 0;
+    for (size_t workers = 1; workers <= cores; workers++) {
+        NSTimeInterval time = [QuoteBenchmark bestTimeOfRuns:3 block:^{
+            memcpy(entries, source, kScalingCount * sizeof(QuoteSortEntry));
+            QuoteSortEntriesParallel(entries, entries + kScalingCount, kScalingCount, 8, workers);
+        }];
+        serialTime = workers == 1 ? time : serialTime;
+        bestTime = workers == 1 ? time : MIN(bestTime, time);
+        [report appendFormat:@" %zu: %.1f ms (%.2fx),", workers, time * 1000, serialTime / time];
+    }
+    free(source);
+    free(entries);
+
+    NSLog(@"sort %zu keys by workers:%@", kScalingCount, report);
+    if (cores > 1) {
+        XCTAssertLessThan(bestTime, serialTime);
+    }
+}
+
+@end
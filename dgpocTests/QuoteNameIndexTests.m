@@ -0,0 +1,207 @@
+//
+//  QuoteNameIndexTests.m
+//  dgpocTests
+//
+
+#import <XCTest/XCTest.h>
+#import <IG/IG.h>
+
+#import "IGGridViewSortingDataSourceHelper.h"
+#import "QuoteBenchmark.h"
+#import "QuoteFilterEngine.h"
+#import "QuoteItem.h"
+#import "QuoteNameIndex.h"
+
+static const NSUInteger kSearchNameCount = 100000;
+
+@interface QuoteNameIndexTests : XCTestCase
+
+@end
+
+@implementation QuoteNameIndexTests
+
+- (QuoteStore *)storeWithNames:(NSArray *)names {
+    QuoteStore *store = [[QuoteStore alloc] init];
+    [store appendRows:names.count];
+    for (NSUInteger row = 0; row < names.count; row++) {
+        [store setString:names[row] forField:QuoteFieldSymbolName row:row];
+    }
+    return store;
+}
+
+- (NSArray *)wordsOfString:(NSString *)string {
+    NSString *folded = [string stringByFoldingWithOptions:NSCaseInsensitiveSearch | NSDiacriticInsensitiveSearch
+                                                   locale:nil];
+    NSMutableArray *words = [NSMutableArray array];
+    for (NSString *word in [folded componentsSeparatedByCharactersInSet:
+                            [NSCharacterSet alphanumericCharacterSet].invertedSet]) {
+        if (word.length) {
+            [words addObject:word];
+        }
+    }
+    return words;
+}
+
+// What the index should find, word by word.
+- (BOOL)name:(NSString *)name matchesQuery:(NSString *)query {
+    NSArray *nameWords = [self wordsOfString:name];
+    NSArray *queryWords = [self wordsOfString:query];
+    if (queryWords.count == 0) {
+        return NO;
+    }
+    for (NSString *queryWord in queryWords) {
+        BOOL found = NO;
+        for (NSString *nameWord in nameWords) {
+            NSRange range = [nameWord rangeOfString:queryWord];
+            found = found || range.location == 0 || (range.location != NSNotFound && queryWord.length >= 3);
+        }
+        if (!found) {
+            return NO;
+        }
+    }
+    return YES;
+}
+
+- (void)testMatchesScan {
+    NSArray *items = [[QuoteBenchmark storeWithRowCount:5000] items];
+    QuoteFilterEngine *engine = [[QuoteFilterEngine alloc] initWithStore:[items.firstObject store]];
+    for (NSString *query in @[@"solar", @"first so", @"wesson", @"SMITH & wes", @"jan 2016 call", @"ol",
+                              @"corporat", @"zzz", @"", @" & "]) {
+        NSArray *found = [engine itemsMatchingName:query inItems:items];
+        NSIndexSet *expected = [items indexesOfObjectsPassingTest:^BOOL(QuoteItem *item, NSUInteger index, BOOL *stop) {
+            return item.symbolName && [self name:item.symbolName matchesQuery:query];
+        }];
+        XCTAssertEqualObjects([NSSet setWithArray:found], [NSSet setWithArray:[items objectsAtIndexes:expected]],
+                              @"%@", query);
+        XCTAssertEqual(found.count, expected.count, @"%@", query);
+    }
+}
+
+- (void)testRanksWordsBeforeStartsBeforeParts {
+    QuoteStore *store = [self storeWithNames:@[@"Insolar Ltd", @"Solaris Corp", @"First Solar, Inc.", @"Firstsolar",
+                                               @"Solar Inc", @"Société Générale SA", @"Lunar Inc"]];
+    QuoteFilterEngine *engine = [[QuoteFilterEngine alloc] initWithStore:store];
+    NSArray *items = [store items];
+    // exact words in name order, then the start of one, then parts in name order
+    NSArray *expected = @[items[2], items[4], items[1], items[3], items[0]];
+    XCTAssertEqualObjects([engine itemsMatchingName:@"SOLAR" inItems:items], expected);
+    XCTAssertEqualObjects([engine itemsMatchingName:@"solar inc" inItems:items], (@[items[2], items[4]]));
+    XCTAssertEqualObjects([engine itemsMatchingName:@"first so" inItems:items], @[items[2]]);
+    XCTAssertEqualObjects([engine itemsMatchingName:@"societe gen" inItems:items], @[items[5]]);
+    // a part needs three letters; a start does not
+    XCTAssertEqual([engine itemsMatchingName:@"ol" inItems:items].count, 0u);
+    XCTAssertEqual([engine itemsMatchingName:@"l" inItems:items].count, 2u);
+}
+
+- (void)testIndexesNamesInternedLater {
+    QuoteStore *store = [self storeWithNames:@[@"First Solar, Inc.", @"Smith & Wesson Holding Corporat"]];
+    QuoteFilterEngine *engine = [[QuoteFilterEngine alloc] initWithStore:store];
+    [engine indexNames];
+    XCTAssertEqual([engine itemsMatchingName:@"wesson" inItems:[store items]].count, 1u);
+
+    NSUInteger row = [store appendRows:2];
+    [store setString:@"Wesson Oil" forField:QuoteFieldSymbolName row:row];
+    [store setString:@"Smith & Wesson Holding Corporat" forField:QuoteFieldSymbolName row:row + 1];
+    NSArray *items = [store items];
+    NSArray *expected = @[items[1], items[3], items[2]];
+    XCTAssertEqualObjects([engine itemsMatchingName:@"wesson" inItems:items], expected);
+    // items of one name keep their order
+    XCTAssertEqualObjects([engine itemsMatchingName:@"wesson" inItems:@[items[3], items[2], items[1]]],
+                          (@[items[3], items[1], items[2]]));
+}
+
+- (void)testHelperSearchesNamesByWord {
+    NSArray *items = [[QuoteBenchmark storeWithRowCount:2000] items];
+    IGGridViewDataSourceHelper *ig = [[IGGridViewDataSourceHelper alloc] init];
+    IGGridViewSortingDataSourceHelper *helper = [[IGGridViewSortingDataSourceHelper alloc] init];
+    helper.data = items;
+    XCTAssertNotNil(helper.filterEngine);
+    XCTAssertFalse(helper.searchesNamesByWord);
+    for (IGGridViewDataSourceHelper *source in @[ig, helper]) {
+        source.filteringKey = @"symbolName";
+        source.filterType = IGGridViewFilterConditionTypeStringContains;
+    }
+
+    // contains keeps IG's meaning unless word search is asked for
+    for (NSString *value in @[@"&", @"ol", @"es", @"wesson smith"]) {
+        XCTAssertEqualObjects([helper applyFilterForValue:value toData:items],
+                              [ig applyFilterForValue:value toData:items], @"%@", value);
+    }
+    XCTAssertGreaterThan([helper applyFilterForValue:@"&" toData:items].count, 0u);
+    XCTAssertGreaterThan([helper applyFilterForValue:@"ol" toData:items].count, 0u);
+
+    helper.searchesNamesByWord = YES;
+    NSArray *found = [helper applyFilterForValue:@"wesson smith" toData:items];
+    XCTAssertGreaterThan(found.count, 0u);
+    for (QuoteItem *item in found) {
+        XCTAssertEqualObjects(item.symbolName, @"Smith & Wesson Holding Corporat");
+    }
+    // a value with no word is still a substring match
+    for (NSString *value in @[@"&", @" & "]) {
+        XCTAssertEqualObjects([helper applyFilterForValue:value toData:items],
+                              [ig applyFilterForValue:value toData:items], @"%@", value);
+    }
+}
+
+- (void)testSearchLatency {
+    if (![QuoteBenchmark runsLargeBenchmarks]) {
+        return;
+    }
+    NSArray *words = @[@"first", @"solar", @"smith", @"wesson", @"holding", @"corp", @"inc", @"apple", @"micro",
+                       @"systems", @"global", @"energy", @"bank", @"of", @"america", @"general", @"electric",
+                       @"société", @"générale", @"power", @"pacific", @"gas", @"united", @"technologies",
+                       @"industries", @"resources", @"financial", @"group", @"trust", @"capital"];
+    NSMutableArray *names = [NSMutableArray arrayWithCapacity:kSearchNameCount];
+    srand48(24);
+    for (NSUInteger i = 0; i < kSearchNameCount; i++) {
+        NSMutableString *name = [NSMutableString string];
+        for (long count = 1 + lrand48() % 4; count > 0; count--) {
+            [name appendFormat:@"%@ ", [words[lrand48() % words.count] capitalizedString]];
+        }
+        // every name distinct, as company names are
+        [name appendFormat:@"N%lu", (unsigned long)i];
+        [names addObject:name];
+    }
+
+    __block QuoteNameIndex index;
+    QuoteNameIndexInit(&index);
+    NSTimeInterval buildTime = [QuoteBenchmark bestTimeOfRuns:1 block:^{
+        for (NSUInteger i = 0; i < kSearchNameCount; i++) {
+            NSString *folded = [names[i] stringByFoldingWithOptions:NSCaseInsensitiveSearch | NSDiacriticInsensitiveSearch
+                                                             locale:nil];
+            const char *bytes = folded.UTF8String;
+            XCTAssertTrue(QuoteNameIndexAdd(&index, (uint32_t)i + 1, bytes, strlen(bytes)));
+        }
+        // the first search puts the suffixes in order
+        QuoteNameMatch *matches;
+        size_t count;
+        XCTAssertTrue(QuoteNameIndexSearch(&index, "zzzz", 4, NULL, &matches, &count));
+        free(matches);
+    }];
+
+    QuoteStore *store = [self storeWithNames:names];
+    QuoteFilterEngine *engine = [[QuoteFilterEngine alloc] initWithStore:store];
+    [engine indexNames];
+    NSArray *items = [store items];
+    for (NSString *query in @[@"first solar", @"wesson", @"first so", @"generale", @"sol", @"n4242"]) {
+        const char *bytes = query.UTF8String;
+        __block size_t found = 0;
+        NSTimeInterval searchTime = [QuoteBenchmark bestTimeOfRuns:5 block:^{
+            QuoteNameMatch *matches;
+            XCTAssertTrue(QuoteNameIndexSearch(&index, bytes, strlen(bytes), NULL, &matches, &found));
+            free(matches);
+        }];
+        __block NSArray *filtered = nil;
+        NSTimeInterval itemsTime = [QuoteBenchmark bestTimeOfRuns:5 block:^{
+            filtered = [engine itemsMatchingName:query inItems:items];
+        }];
+        NSLog(@"name search %@ of %lu names: %.3f ms, %.3f ms with items, %lu matches (built in %.1f ms)", query,
+              (unsigned long)kSearchNameCount, searchTime * 1000, itemsTime * 1000, (unsigned long)found,
+              buildTime * 1000);
+        XCTAssertEqual(filtered.count, found, @"%@", query);
+        XCTAssertLessThan(searchTime, 0.001, @"%@", query);
+    }
+    QuoteNameIndexFree(&index);
+}
+
+@end
@@ -0,0 +1,128 @@
+//
+//  QuoteNumberParserTests.m
+//  dgpocTests
+//
+
+#import <XCTest/XCTest.h>
+#import <xlocale.h>
+
+#import "QuoteBenchmark.h"
+#import "QuoteNumberParser.h"
+
+static double QuoteReferenceDouble(NSString *string) {
+    static locale_t cLocale;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        cLocale = newlocale(LC_ALL_MASK, "C", NULL);
+    });
+    return strtod_l(string.UTF8String, NULL, cLocale);
+}
+
+@interface QuoteNumberParserTests : XCTestCase
+
+@end
+
+@implementation QuoteNumberParserTests
+
+- (void)assertParsesLikeStrtod:(NSString *)string {
+    const char *bytes = string.UTF8String;
+    double actual;
+    XCTAssertTrue(QuoteParseDouble(bytes, strlen(bytes), &actual), @"%@", string);
+
+    double expected = QuoteReferenceDouble(string);
+    XCTAssertEqual(memcmp(&actual, &expected, sizeof(double)), 0, @"%@: %.17g != %.17g", string, actual, expected);
+}
+
+- (void)testCorpus {
+    NSArray *corpus = @[@"0", @"-0", @"25.59", @"-25.9", @"13893855", @"0.0204", @"175.83",
+                        @"0.1", @"0.30000000000000004", @"+.5", @"5.", @"  3.15\r",
+                        @"1e22", @"1e23", @"9007199254740993", @"123456789012345678901234",
+                        @"1.7976931348623157e308", @"4.9e-324", @"2.2250738585072014e-308",
+                        @"1e-400", @"1e400", @"1105564443e-25"];
+    for (NSString *string in corpus) {
+        [self assertParsesLikeStrtod:string];
+    }
+}
+
+- (void)testRandomDecimals {
+    srand48(42);
+    for (NSUInteger i = 0; i < 100000; i++) {
+        double v = (drand48() - 0.5) * pow(10, (int)(drand48() * 40) - 20);
+        [self assertParsesLikeStrtod:[NSString stringWithFormat:@"%.17g", v]];
+        [self assertParsesLikeStrtod:[NSString stringWithFormat:@"%.*f", (int)(i % 8), v]];
+    }
+}
+
+- (void)testRejectsNonNumbers {
+    NSArray *garbage = @[@"", @"-", @".", @"1/5/16", @"3:36pm", @"1e", @"1.2.3", @"9.39 - 26.54"];
+    for (NSString *string in garbage) {
+        double value = 1;
+        XCTAssertFalse(QuoteParseDouble(string.UTF8String, strlen(string.UTF8String), &value), @"%@", string);
+        XCTAssertEqual(value, 0.0);
+    }
+}
+
+- (void)testFixedPoint {
+    NSDictionary *expected = @{ @"25.59": @255900, @"-25.9": @-259000, @".5": @5000,
+                                @"0.00005": @1, @"-0.00005": @-1, @"0.00004": @0,
+                                @"13893855": @138938550000,
+                                @"922337203685477.5807": @INT64_MAX,
+                                @"-922337203685477.5808": @INT64_MIN };
+    [expected enumerateKeysAndObjectsUsingBlock:^(NSString *string, NSNumber *number, BOOL *stop) {
+        int64_t value;
+        XCTAssertTrue(QuoteParseFixed(string.UTF8String, strlen(string.UTF8String), 4, &value), @"%@", string);
+        XCTAssertEqual(value, number.longLongValue, @"%@", string);
+    }];
+
+    for (NSString *string in @[@"922337203685477.5808", @"1e5", @"", @"-", @"1.2.3"]) {
+        int64_t value;
+        XCTAssertFalse(QuoteParseFixed(string.UTF8String, strlen(string.UTF8String), 4, &value), @"%@", string);
+    }
+}
+
+- (void)testThroughputAgainstDoubleValue {
+    NSMutableArray *strings = [NSMutableArray array];
+    NSMutableData *bytes = [NSMutableData data];
+    NSMutableArray *ranges = [NSMutableArray array];
+    srand48(7);
+    for (NSUInteger i = 0; i < 100000; i++) {
+        NSString *string = [NSString stringWithFormat:@"%.2f", drand48() * 1000];
+        [strings addObject:string];
+        [ranges addObject:[NSValue valueWithRange:NSMakeRange(bytes.length, string.length)]];
+        [bytes appendData:[string dataUsingEncoding:NSUTF8StringEncoding]];
+    }
+
+    NSUInteger count = strings.count;
+    NSRange *offsets = malloc(count * sizeof(NSRange));
+    for (NSUInteger i = 0; i < count; i++) {
+        offsets[i] = [ranges[i] rangeValue];
+    }
+    const char *base = bytes.bytes;
+
+    __block double sink = 0;
+    NSTimeInterval parser = [QuoteBenchmark bestTimeOfRuns:5 block:^{
+        for (NSUInteger i = 0; i < count; i++) {
+            double value;
+            QuoteParseDouble(base + offsets[i].location, offsets[i].length, &value);
+            sink += value;
+        }
+    }];
+    NSTimeInterval fixed = [QuoteBenchmark bestTimeOfRuns:5 block:^{
+        for (NSUInteger i = 0; i < count; i++) {
+            int64_t value;
+            QuoteParseFixed(base + offsets[i].location, offsets[i].length, 4, &value);
+            sink += value;
+        }
+    }];
+    NSTimeInterval foundation = [QuoteBenchmark bestTimeOfRuns:5 block:^{
+        for (NSString *string in strings) {
+            sink += [string doubleValue];
+        }
+    }];
+    free(offsets);
+
+    NSLog(@"QuoteParseDouble %.1f ns, QuoteParseFixed %.1f ns, -doubleValue %.1f ns per field (%g)",
+          parser * 1e9 / count, fixed * 1e9 / count, foundation * 1e9 / count, sink);
+}
+
+@end
@@ -0,0 +1,120 @@
+//
+//  QuoteOptionSymbolTests.m
+//  dgpocTests
+//
+
+#import <XCTest/XCTest.h>
+
+#import "QuoteBenchmark.h"
+#import "QuoteOptionSymbol.h"
+#import "QuotePrice.h"
+#import "QuoteStore.h"
+
+static const NSUInteger kChainContractCount = 2000000;
+static const NSUInteger kLegacyContractCount = 100000;
+
+static BOOL QuoteParse(NSString *string, QuoteOptionSymbol *option) {
+    const char *bytes = string.UTF8String;
+    return QuoteOptionSymbolParse(bytes, strlen(bytes), option);
+}
+
+@interface QuoteOptionSymbolTests : XCTestCase
+
+@end
+
+@implementation QuoteOptionSymbolTests
+
+- (void)testParsesBothSpellings {
+    QuoteOptionSymbol option;
+    XCTAssertTrue(QuoteParse(@"FSLR_012016C100", &option));
+    XCTAssertEqual(option.underlyingLength, 4u);
+    XCTAssertEqual(strncmp(option.underlying, "FSLR", 4), 0);
+    XCTAssertEqual(option.expiry, 20160120u);
+    XCTAssertEqual(option.right, QuoteOptionRightCall);
+    XCTAssertEqual(option.strike, QuotePriceFromCents(10000));
+
+    NSArray *occ = @[@"AAPL  160122P00097500", @"AAPL160122P00097500"];
+    for (NSString *symbol in occ) {
+        XCTAssertTrue(QuoteParse(symbol, &option), @"%@", symbol);
+        XCTAssertEqual(option.underlyingLength, 4u, @"%@", symbol);
+        XCTAssertEqual(option.expiry, 20160122u, @"%@", symbol);
+        XCTAssertEqual(option.right, QuoteOptionRightPut, @"%@", symbol);
+        XCTAssertEqual(option.strike, QuotePriceFromCents(9750), @"%@", symbol);
+    }
+
+    XCTAssertTrue(QuoteParse(@"SPXW  160229C02000000", &option));
+    XCTAssertEqual(option.expiry, 20160229u);
+}
+
+- (void)testRejectsMalformedSymbols {
+    NSArray *malformed = @[@"", @"FSLR", @"FSLR_", @"_012016C100", @"FSLR_012016C", @"FSLR_012016X100",
+                           @"FSLR_132016C100", @"FSLR_013216C100", @"FSLR_012016C1O0", @"FSLR_012016C-5",
+                           @"SPXW  170229C02000000", @"      160122C00100000", @"A B   160122C00100000",
+                           @"TOOLONGR160122C00100000", @"AAPL  160122C0010000"];
+    for (NSString *symbol in malformed) {
+        QuoteOptionSymbol option;
+        XCTAssertFalse(QuoteParse(symbol, &option), @"%@", symbol);
+        XCTAssertEqual(option.expiry, 0u, @"%@", symbol);
+    }
+}
+
+- (void)testStoreParsesEachSymbolOnce {
+    QuoteStore *store = [[QuoteStore alloc] init];
+    [store appendRows:3];
+    [store setString:@"FSLR_012016C100" forField:QuoteFieldSymbol row:0];
+    [store setString:@"FSLR_012016C100" forField:QuoteFieldSymbol row:1];
+    [store setString:@"FSLR" forField:QuoteFieldSymbol row:2];
+
+    const QuoteOptionContract *contracts = [store optionContracts];
+    uint32_t optionId = [store codeColumn:QuoteFieldSymbol][0];
+    XCTAssertEqual(contracts[optionId].expiry, 20160120u);
+    XCTAssertEqual([store optionContractForRow:1].strike, QuotePriceFromCents(10000));
+    XCTAssertEqual([store optionContractForRow:2].right, QuoteOptionRightNone);
+}
+
+- (void)testChainThroughput {
+    if (![QuoteBenchmark runsLargeBenchmarks]) {
+        return;
+    }
+    NSURL *url = [QuoteBenchmark optionChainURLWithContractCount:kChainContractCount];
+    NSData *chain = [NSData dataWithContentsOfURL:url options:NSDataReadingMappedAlways error:NULL];
+
+    __block NSUInteger parsed = 0;
+    NSTimeInterval time = [QuoteBenchmark bestTimeOfRuns:3 block:^{
+        const char *p = chain.bytes;
+        const char *end = p + chain.length;
+        QuoteOptionSymbol option;
+        parsed = 0;
+        while (p < end) {
+            const char *newline = memchr(p, '\n', (size_t)(end - p));
+            const char *lineEnd = newline ? newline : end;
+            parsed += QuoteOptionSymbolParse(p, (size_t)(lineEnd - p), &option);
+            p = lineEnd + 1;
+        }
+    }];
+    XCTAssertEqual(parsed, kChainContractCount);
+
+    // what every sort key request used to pay: substrings and a format
+    NSMutableArray *symbols = [NSMutableArray arrayWithCapacity:kLegacyContractCount];
+    for (NSUInteger i = 0; i < kLegacyContractCount; i++) {
+        [symbols addObject:[NSString stringWithFormat:@"FSLR_%02lu2016C%lu", (unsigned long)(i % 12 + 1), (unsigned long)(i % 500 + 1)]];
+    }
+    NSTimeInterval legacyTime = [QuoteBenchmark bestTimeOfRuns:3 block:^{
+        for (NSString *symbol in symbols) {
+            NSRange offset = [symbol rangeOfString:@"_"];
+            NSString *month = [symbol substringWithRange:NSMakeRange(offset.location + 1, 2)];
+            NSString *day = [symbol substringWithRange:NSMakeRange(offset.location + 3, 2)];
+            NSString *year = [symbol substringWithRange:NSMakeRange(offset.location + 5, 2)];
+            NSString *type = [symbol substringWithRange:NSMakeRange(offset.location + 7, 1)];
+            NSString *strike = [symbol substringFromIndex:offset.location + 8];
+            [NSString stringWithFormat:@"%@_%@_%@_%@_%@", year, month, day, strike, type];
+        }
+    }];
+
+    double rate = kChainContractCount / time;
+    double legacyRate = kLegacyContractCount / legacyTime;
+    NSLog(@"QuoteOptionSymbolParse %.1f M contracts/s, substring keys %.1f M/s", rate / 1e6, legacyRate / 1e6);
+    XCTAssertGreaterThan(rate, legacyRate * 10);
+}
+
+@end
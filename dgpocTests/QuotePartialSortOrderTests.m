@@ -0,0 +1,144 @@
+//
+//  QuotePartialSortOrderTests.m
+//  dgpocTests
+//
+
+#import <XCTest/XCTest.h>
+
+#import "QuoteBenchmark.h"
+#import "QuoteItem.h"
+#import "QuotePartialSortOrder.h"
+#import "QuoteStore.h"
+
+static const NSUInteger kTopMoversRowCount = 1000000;
+static const NSUInteger kVisibleRowCount = 30;
+// a screen of top movers and the prefetch past it
+static const NSUInteger kTopMoversCount = 50;
+
+@interface QuotePartialSortOrderTests : XCTestCase
+
+@end
+
+@implementation QuotePartialSortOrderTests
+
+- (QuoteStore *)storeWithRowCount:(NSUInteger)rowCount {
+    return [QuoteBenchmark storeWithRowCount:rowCount
+                             spreadingFields:QuoteFieldMaskOf(QuoteFieldChangePercentChange)];
+}
+
+- (void)testHeadMatchesFullSort {
+    QuoteStore *store = [self storeWithRowCount:20000];
+    QuoteSortEngine *engine = [[QuoteSortEngine alloc] initWithStore:store];
+    NSArray *items = [store items];
+    NSArray *descriptorSets = @[@[[NSSortDescriptor sortDescriptorWithKey:@"changePercentChange" ascending:NO]],
+                                // the fixture's hundred bids tie in long runs
+                                @[[NSSortDescriptor sortDescriptorWithKey:@"bid" ascending:YES],
+                                  [NSSortDescriptor sortDescriptorWithKey:@"symbolSortAscending" ascending:YES]]];
+
+    for (NSArray *descriptors in descriptorSets) {
+        NSArray *expected = [engine sortedItems:items usingDescriptors:descriptors];
+        QuotePartialSortOrder *order = [[QuotePartialSortOrder alloc] initWithEngine:engine items:items
+                                                                          descriptors:descriptors];
+        NSArray *view = order.items;
+        XCTAssertEqual(order.sortedCount, 0u);
+
+        NSRange visible = NSMakeRange(0, kVisibleRowCount);
+        XCTAssertEqualObjects([view subarrayWithRange:visible], [expected subarrayWithRange:visible]);
+        XCTAssertLessThan(order.sortedCount, items.count / 2, @"%@", descriptors);
+
+        // scrolling down extends the sorted head
+        NSRange later = NSMakeRange(5000, kVisibleRowCount);
+        XCTAssertEqualObjects([view subarrayWithRange:later], [expected subarrayWithRange:later]);
+        XCTAssertEqualObjects([view copy], expected);
+        XCTAssertEqual(order.sortedCount, items.count);
+    }
+}
+
+- (void)testChangedFieldsResort {
+    QuoteStore *store = [self storeWithRowCount:5000];
+    QuoteSortEngine *engine = [[QuoteSortEngine alloc] initWithStore:store];
+    NSArray *descriptors = @[[NSSortDescriptor sortDescriptorWithKey:@"changePercentChange" ascending:NO]];
+    QuotePartialSortOrder *order = [[QuotePartialSortOrder alloc] initWithEngine:engine items:[store items]
+                                                                      descriptors:descriptors];
+    NSArray *view = order.items;
+    QuoteItem *top = view[0];
+
+    uint32_t row = 4321;
+    [store setDouble:1000 forField:QuoteFieldChangePercentChange row:row];
+    [order updateRows:&row count:1 changedFields:QuoteFieldMaskOf(QuoteFieldBid)];
+    XCTAssertEqualObjects(view[0], top);
+    [order updateRows:&row count:1 changedFields:QuoteFieldMaskOf(QuoteFieldChangePercentChange)];
+    XCTAssertEqual(order.sortedCount, 0u);
+    XCTAssertEqual([view[0] row], (NSUInteger)row);
+}
+
+- (void)testTicksKeepHead {
+    QuoteStore *store = [self storeWithRowCount:5000];
+    QuoteSortEngine *engine = [[QuoteSortEngine alloc] initWithStore:store];
+    NSArray *items = [store items];
+    NSArray *descriptors = @[[NSSortDescriptor sortDescriptorWithKey:@"changePercentChange" ascending:NO]];
+    QuotePartialSortOrder *order = [[QuotePartialSortOrder alloc] initWithEngine:engine items:items
+                                                                      descriptors:descriptors];
+    NSArray *view = order.items;
+    [order itemAtIndex:kVisibleRowCount - 1];
+    NSUInteger sortedCount = order.sortedCount;
+    XCTAssertGreaterThan(sortedCount, kVisibleRowCount);
+
+    // a head row moving within the head and a row past it falling further
+    // leave the head as long as it was
+    NSArray *sorted = [engine sortedItems:items usingDescriptors:descriptors];
+    double *change = [store doubleColumn:QuoteFieldChangePercentChange];
+    uint32_t ticked[2] = {(uint32_t)[sorted[20] row], (uint32_t)[sorted.lastObject row]};
+    change[ticked[0]] = (change[[sorted[2] row]] + change[[sorted[3] row]]) / 2;
+    change[ticked[1]] -= 1;
+    [store didChangeFields:QuoteFieldMaskOf(QuoteFieldChangePercentChange)];
+    [order updateRows:ticked count:2 changedFields:QuoteFieldMaskOf(QuoteFieldChangePercentChange)];
+    XCTAssertEqual(order.sortedCount, sortedCount);
+    sorted = [engine sortedItems:items usingDescriptors:descriptors];
+    XCTAssertEqualObjects([view subarrayWithRange:NSMakeRange(0, sortedCount)],
+                          [sorted subarrayWithRange:NSMakeRange(0, sortedCount)]);
+
+    // a row past the head rising into it cuts the head where it lands
+    uint32_t risen = (uint32_t)[sorted[4000] row];
+    change[risen] = (change[[sorted[10] row]] + change[[sorted[11] row]]) / 2;
+    [store didChangeFields:QuoteFieldMaskOf(QuoteFieldChangePercentChange)];
+    [order updateRows:&risen count:1 changedFields:QuoteFieldMaskOf(QuoteFieldChangePercentChange)];
+    XCTAssertEqual(order.sortedCount, 11u);
+    sorted = [engine sortedItems:items usingDescriptors:descriptors];
+    NSRange visible = NSMakeRange(0, kVisibleRowCount);
+    XCTAssertEqualObjects([view subarrayWithRange:visible], [sorted subarrayWithRange:visible]);
+    XCTAssertEqual([view[11] row], (NSUInteger)risen);
+}
+
+- (void)testTopMoversAgainstFullSort {
+    if (![QuoteBenchmark runsLargeBenchmarks]) {
+        return;
+    }
+    QuoteStore *store = [self storeWithRowCount:kTopMoversRowCount];
+    QuoteSortEngine *engine = [[QuoteSortEngine alloc] initWithStore:store];
+    NSArray *items = [store items];
+    NSArray *descriptors = @[[NSSortDescriptor sortDescriptorWithKey:@"changePercentChange" ascending:NO]];
+
+    NSTimeInterval partialTime = [QuoteBenchmark bestTimeOfRuns:3 block:^{
+        QuotePartialSortOrder *order = [[QuotePartialSortOrder alloc] initWithEngine:engine items:items
+                                                                          descriptors:descriptors];
+        [order itemAtIndex:kTopMoversCount - 1];
+    }];
+    NSTimeInterval fullTime = [QuoteBenchmark bestTimeOfRuns:3 block:^{
+        [[QuoteSortOrder alloc] initWithEngine:engine items:items descriptors:descriptors];
+    }];
+    // workerCount 1 shows what the selection saves over the sort alone
+    engine.workerCount = 1;
+    NSTimeInterval serialTime = [QuoteBenchmark bestTimeOfRuns:3 block:^{
+        [[QuoteSortOrder alloc] initWithEngine:engine items:items descriptors:descriptors];
+    }];
+
+    NSLog(@"top %lu of %lu rows: partial %.1f ms, full sort %.1f ms, serial %.1f ms", (unsigned long)kTopMoversCount,
+          (unsigned long)kTopMoversRowCount, partialTime * 1000, fullTime * 1000, serialTime * 1000);
+    // the selection runs on one core, so the claim is held against the
+    // serial sort; the parallel one must still lose clearly
+    XCTAssertLessThan(partialTime * 20, serialTime);
+    XCTAssertLessThan(partialTime * 3, fullTime);
+}
+
+@end
@@ -0,0 +1,62 @@
+//
+//  QuotePriceTests.m
+//  dgpocTests
+//
+
+#import <XCTest/XCTest.h>
+
+#import "GridHelper.h"
+#import "QuotePrice.h"
+
+static const NSUInteger kTickCount = 100000;
+
+static NSString *QuoteFixedString(int64_t value, unsigned decimals, unsigned shown) {
+    char buffer[32];
+    size_t length = QuoteFixedFormat(value, decimals, shown, buffer, sizeof(buffer));
+    return [[NSString alloc] initWithBytes:buffer length:length encoding:NSASCIIStringEncoding];
+}
+
+@interface QuotePriceTests : XCTestCase
+
+@end
+
+@implementation QuotePriceTests
+
+- (void)testFormatsWithGroupingAndRounding {
+    XCTAssertEqualObjects(QuoteFixedString(12345678, 4, 2), @"1,234.57");
+    XCTAssertEqualObjects(QuoteFixedString(-12345678, 4, 2), @"-1,234.57");
+    XCTAssertEqualObjects(QuoteFixedString(50, 4, 2), @"0.01");
+    XCTAssertEqualObjects(QuoteFixedString(-49, 4, 2), @"0.00");
+    XCTAssertEqualObjects(QuoteFixedString(999950, 4, 2), @"100.00");
+    XCTAssertEqualObjects(QuoteFixedString(1234567, 0, 0), @"1,234,567");
+    XCTAssertEqualObjects(QuoteFixedString(INT64_MAX, 0, 0), @"9,223,372,036,854,775,807");
+}
+
+- (void)testCurrencyStrings {
+    XCTAssertEqualObjects([GridHelper currencyStringForPrice:QuotePriceFromCents(123457)], @"$1,234.57");
+    XCTAssertEqualObjects([GridHelper currencyStringForPrice:-QuotePriceFromCents(2590)], @"-$25.90");
+    XCTAssertEqualObjects([GridHelper currencyStringForPrice:0], @"$0.00");
+    XCTAssertEqualObjects([GridHelper currencyStringForPrice:QUOTE_FIXED_MISSING], @"");
+}
+
+- (void)testFromDoubleRoundsAndClamps {
+    XCTAssertEqual(QuoteFixedFromDouble(25.89, 4), 258900);
+    XCTAssertEqual(QuoteFixedFromDouble(2.5, 0), 3);
+    XCTAssertEqual(QuoteFixedFromDouble(-2.5, 0), -3);
+    XCTAssertEqual(QuoteFixedFromDouble(NAN, 4), QUOTE_FIXED_MISSING);
+    XCTAssertEqual(QuoteFixedFromDouble(1e300, 4), INT64_MAX);
+    XCTAssertEqual(QuoteFixedFromDouble(-1e300, 4), INT64_MIN + 1);
+}
+
+- (void)testTicksDoNotDrift {
+    QuotePrice price = QuotePriceFromCents(2590);
+    double drifting = 25.90;
+    for (NSUInteger i = 0; i < kTickCount; i++) {
+        price += QuotePriceFromCents(1);
+        drifting += 0.01;
+    }
+    XCTAssertEqualObjects(QuoteFixedString(price, QUOTE_PRICE_DECIMALS, QUOTE_PRICE_DECIMALS), @"1,025.9000");
+    XCTAssertNotEqual(drifting, 1025.90);
+}
+
+@end
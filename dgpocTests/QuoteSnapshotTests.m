@@ -0,0 +1,129 @@
+//
+//  QuoteSnapshotTests.m
+//  dgpocTests
+//
+
+#import <XCTest/XCTest.h>
+
+#import "QuoteBenchmark.h"
+#import "QuoteItem.h"
+#import "QuoteItemDataMaker.h"
+#import "QuoteSchema.h"
+#import "QuoteSnapshot.h"
+
+static const NSUInteger kVisibleRows = 30;
+
+@interface QuoteSnapshotTests : XCTestCase
+
+@property (nonatomic, strong) NSURL *snapshotURL;
+
+@end
+
+@implementation QuoteSnapshotTests
+
+- (void)setUp {
+    [super setUp];
+    self.snapshotURL = [NSURL fileURLWithPath:[NSTemporaryDirectory() stringByAppendingPathComponent:@"test.qsnp"]];
+}
+
+- (void)tearDown {
+    [[NSFileManager defaultManager] removeItemAtURL:self.snapshotURL error:NULL];
+    [super tearDown];
+}
+
+- (void)testRoundTrip {
+    NSURL *csvURL = [QuoteBenchmark csvURLWithRowCount:1000];
+    QuoteStore *store = [QuoteItemDataMaker projectionOfCSVAtURL:csvURL fields:QuoteFieldMaskAll].store;
+    NSArray *items = [store items];
+    XCTAssertTrue([QuoteSnapshot writeQuoteStore:store sourceStamp:42 toURL:self.snapshotURL]);
+
+    QuoteSnapshot *snapshot = [QuoteSnapshot snapshotWithContentsOfURL:self.snapshotURL sourceStamp:42];
+    XCTAssertNotNil(snapshot);
+    XCTAssertEqual(snapshot.rowCount, items.count);
+
+    NSArray *restored = [snapshot quoteItems];
+    XCTAssertEqual(restored.count, items.count);
+    for (NSUInteger row = 0; row < items.count; row++) {
+        for (QuoteField field = 0; field < QuoteFieldCount; field++) {
+            NSString *key = QuoteFieldKey(field);
+            XCTAssertEqualObjects([restored[row] valueForKey:key], [items[row] valueForKey:key], @"%@ row %lu", key, (unsigned long)row);
+        }
+    }
+}
+
+- (void)testRejectsStaleOrDamagedSnapshots {
+    NSURL *csvURL = [QuoteBenchmark csvURLWithRowCount:100];
+    QuoteStore *store = [QuoteItemDataMaker projectionOfCSVAtURL:csvURL fields:QuoteFieldMaskAll].store;
+    XCTAssertTrue([QuoteSnapshot writeQuoteStore:store sourceStamp:1 toURL:self.snapshotURL]);
+
+    XCTAssertNil([QuoteSnapshot snapshotWithContentsOfURL:self.snapshotURL sourceStamp:2]);
+
+    NSMutableData *data = [NSMutableData dataWithContentsOfURL:self.snapshotURL];
+    NSData *truncated = [data subdataWithRange:NSMakeRange(0, data.length / 2)];
+    [truncated writeToURL:self.snapshotURL atomically:YES];
+    XCTAssertNil([QuoteSnapshot snapshotWithContentsOfURL:self.snapshotURL sourceStamp:1]);
+
+    uint16_t version = 0xFFFF;
+    [data replaceBytesInRange:NSMakeRange(4, sizeof(version)) withBytes:&version];
+    [data writeToURL:self.snapshotURL atomically:YES];
+    XCTAssertNil([QuoteSnapshot snapshotWithContentsOfURL:self.snapshotURL sourceStamp:1]);
+
+    XCTAssertNil([QuoteSnapshot snapshotWithContentsOfURL:[NSURL fileURLWithPath:@"/nonexistent"] sourceStamp:1]);
+}
+
+- (void)testRejectsCodesNamingNoString {
+    NSURL *csvURL = [QuoteBenchmark csvURLWithRowCount:100];
+    QuoteStore *store = [QuoteItemDataMaker projectionOfCSVAtURL:csvURL fields:QuoteFieldMaskAll].store;
+    XCTAssertTrue([QuoteSnapshot writeQuoteStore:store sourceStamp:1 toURL:self.snapshotURL]);
+
+    // the column descriptors follow the 48-byte header; the symbol codes
+    // follow the column's string count
+    NSMutableData *data = [NSMutableData dataWithContentsOfURL:self.snapshotURL];
+    uint64_t offset = 0;
+    [data getBytes:&offset range:NSMakeRange(48 + QuoteFieldSymbol * 16 + 8, sizeof(offset))];
+    uint32_t code = UINT32_MAX;
+    [data replaceBytesInRange:NSMakeRange((NSUInteger)offset + sizeof(uint32_t) * 3, sizeof(code)) withBytes:&code];
+    [data writeToURL:self.snapshotURL atomically:YES];
+
+    QuoteSnapshot *snapshot = [QuoteSnapshot snapshotWithContentsOfURL:self.snapshotURL sourceStamp:1];
+    XCTAssertNotNil(snapshot);
+    XCTAssertNil([snapshot stringForField:QuoteFieldSymbol row:2]);
+    XCTAssertNotNil([snapshot stringForField:QuoteFieldSymbol row:1]);
+    XCTAssertNil([snapshot quoteStore]);
+}
+
+- (void)testStartupAgainstCSV {
+    if (![QuoteBenchmark runsLargeBenchmarks]) {
+        return;
+    }
+    for (NSNumber *rows in @[@1000, @10000, @100000, @1000000]) {
+        @autoreleasepool {
+            NSURL *csvURL = [QuoteBenchmark csvURLWithRowCount:rows.unsignedIntegerValue];
+            QuoteStore *store = [QuoteItemDataMaker projectionOfCSVAtURL:csvURL fields:QuoteFieldMaskAll].store;
+            XCTAssertTrue([QuoteSnapshot writeQuoteStore:store sourceStamp:0 toURL:self.snapshotURL]);
+            store = nil;
+
+            // "ready to render": the data is loaded and the first screen of rows exists
+            NSTimeInterval csv = [QuoteBenchmark bestTimeOfRuns:1 block:^{
+                NSArray *loaded = [QuoteItemDataMaker quoteItemsFromCSVAtURL:csvURL];
+                for (NSUInteger i = 0; i < kVisibleRows; i++) {
+                    [loaded[i] symbol];
+                }
+            }];
+            NSTimeInterval snapshot = [QuoteBenchmark bestTimeOfRuns:5 block:^{
+                NSArray *loaded = [[QuoteSnapshot snapshotWithContentsOfURL:self.snapshotURL sourceStamp:0] quoteItems];
+                for (NSUInteger i = 0; i < kVisibleRows; i++) {
+                    [loaded[i] symbol];
+                }
+            }];
+
+            NSLog(@"%@ rows: csv %.3f ms, snapshot %.3f ms", rows, csv * 1e3, snapshot * 1e3);
+            // the target: a store of up to 10k rows ready in under a millisecond
+            if (rows.unsignedIntegerValue <= 10000) {
+                XCTAssertLessThan(snapshot, 0.001, @"%@ rows", rows);
+            }
+        }
+    }
+}
+
+@end
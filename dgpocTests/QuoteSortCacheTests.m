@@ -0,0 +1,160 @@
+//
+//  QuoteSortCacheTests.m
+//  dgpocTests
+//
+
+#import <XCTest/XCTest.h>
+
+#import "QuoteBenchmark.h"
+#import "QuotePrice.h"
+#import "QuoteSortCache.h"
+#import "QuoteStore.h"
+
+static const NSUInteger kCacheRowCount = 100000;
+
+@interface QuoteSortCacheTests : XCTestCase
+
+@end
+
+@implementation QuoteSortCacheTests
+
+- (QuoteSortEngine *)engineWithRowCount:(NSUInteger)rowCount {
+    return [[QuoteSortEngine alloc] initWithStore:[QuoteBenchmark storeWithRowCount:rowCount]];
+}
+
+- (void)testFlipMatchesSort {
+    // the fixture cycles a hundred quotes, so most rows tie with others
+    QuoteSortEngine *engine = [self engineWithRowCount:5000];
+    QuoteSortCache *cache = [[QuoteSortCache alloc] initWithEngine:engine byteBudget:1 << 20];
+    NSArray *descriptors = @[[NSSortDescriptor sortDescriptorWithKey:@"lastTrade" ascending:NO],
+                             [NSSortDescriptor sortDescriptorWithKey:@"symbolName" ascending:YES
+                                                            selector:@selector(caseInsensitiveCompare:)]];
+    NSArray *flipped = [descriptors valueForKey:@"reversedSortDescriptor"];
+
+    NSData *sorted = [cache permutationForDescriptors:descriptors];
+    XCTAssertEqual(cache.missCount, 1u);
+    XCTAssertEqual([cache permutationForDescriptors:descriptors], sorted);
+    XCTAssertEqual(cache.hitCount, 1u);
+
+    NSData *reversed = [cache permutationForDescriptors:flipped];
+    XCTAssertEqual(cache.reversalCount, 1u);
+    XCTAssertEqualObjects(reversed, [engine permutationForDescriptors:flipped]);
+    XCTAssertEqual(cache.permutationCount, 2u);
+    XCTAssertEqual(cache.byteCount, 2 * sorted.length);
+}
+
+- (void)testChangedFieldsInvalidate {
+    QuoteSortEngine *engine = [self engineWithRowCount:1000];
+    QuoteStore *store = engine.store;
+    QuoteSortCache *cache = [[QuoteSortCache alloc] initWithEngine:engine byteBudget:1 << 20];
+    NSArray *descriptors = @[[NSSortDescriptor sortDescriptorWithKey:@"bid" ascending:YES]];
+    [cache permutationForDescriptors:descriptors];
+
+    [store setFixed:QuotePriceFromCents(1) forField:QuoteFieldAsk row:3];
+    [cache permutationForDescriptors:descriptors];
+    XCTAssertEqual(cache.hitCount, 1u);
+
+    [store setFixed:QuotePriceFromCents(1) forField:QuoteFieldBid row:3];
+    NSData *resorted = [cache permutationForDescriptors:descriptors];
+    XCTAssertEqual(cache.missCount, 2u);
+    XCTAssertEqualObjects(resorted, [engine permutationForDescriptors:descriptors]);
+
+    // writes through a column pointer count once reported
+    [store fixedColumn:QuoteFieldBid][5] = 0;
+    [store didChangeFields:QuoteFieldMaskOf(QuoteFieldBid)];
+    [cache permutationForDescriptors:descriptors];
+    XCTAssertEqual(cache.missCount, 3u);
+
+    [store appendRows:1];
+    XCTAssertEqual([cache permutationForDescriptors:descriptors].length, store.rowCount * sizeof(uint32_t));
+    XCTAssertEqual(cache.missCount, 4u);
+}
+
+- (void)testProbeCountsNothing {
+    QuoteSortEngine *engine = [self engineWithRowCount:1000];
+    QuoteSortCache *cache = [[QuoteSortCache alloc] initWithEngine:engine byteBudget:1 << 20];
+    NSArray *descriptors = @[[NSSortDescriptor sortDescriptorWithKey:@"bid" ascending:YES]];
+    NSArray *flipped = [descriptors valueForKey:@"reversedSortDescriptor"];
+
+    XCTAssertFalse([cache hasPermutationForDescriptors:descriptors]);
+    [cache permutationForDescriptors:descriptors];
+    XCTAssertTrue([cache hasPermutationForDescriptors:descriptors]);
+    XCTAssertTrue([cache hasPermutationForDescriptors:flipped]);
+    XCTAssertEqual(cache.hitCount, 0u);
+    XCTAssertEqual(cache.reversalCount, 0u);
+    XCTAssertEqual(cache.missCount, 1u);
+    XCTAssertEqual(cache.permutationCount, 1u);
+
+    [engine.store setFixed:QuotePriceFromCents(1) forField:QuoteFieldBid row:3];
+    XCTAssertFalse([cache hasPermutationForDescriptors:descriptors]);
+}
+
+- (void)testEvictsLeastRecentlyUsed {
+    QuoteSortEngine *engine = [self engineWithRowCount:1000];
+    NSUInteger size = engine.store.rowCount * sizeof(uint32_t);
+    QuoteSortCache *cache = [[QuoteSortCache alloc] initWithEngine:engine byteBudget:2 * size];
+    NSArray *byBid = @[[NSSortDescriptor sortDescriptorWithKey:@"bid" ascending:YES]];
+    NSArray *byAsk = @[[NSSortDescriptor sortDescriptorWithKey:@"ask" ascending:YES]];
+    NSArray *byVolume = @[[NSSortDescriptor sortDescriptorWithKey:@"volume" ascending:YES]];
+
+    [cache permutationForDescriptors:byBid];
+    [cache permutationForDescriptors:byAsk];
+    [cache permutationForDescriptors:byBid];
+    [cache permutationForDescriptors:byVolume];
+    XCTAssertEqual(cache.evictionCount, 1u);
+    XCTAssertEqual(cache.byteCount, 2 * size);
+
+    [cache permutationForDescriptors:byBid];
+    XCTAssertEqual(cache.hitCount, 2u);
+    [cache permutationForDescriptors:byAsk];
+    XCTAssertEqual(cache.missCount, 4u);
+
+    [cache removeAllPermutations];
+    XCTAssertEqual(cache.byteCount, 0u);
+}
+
+- (void)testKeepsPermutationLargerThanBudget {
+    QuoteSortEngine *engine = [self engineWithRowCount:1000];
+    NSUInteger size = engine.store.rowCount * sizeof(uint32_t);
+    QuoteSortCache *cache = [[QuoteSortCache alloc] initWithEngine:engine byteBudget:size / 2];
+    NSArray *byBid = @[[NSSortDescriptor sortDescriptorWithKey:@"bid" ascending:YES]];
+    NSArray *byAsk = @[[NSSortDescriptor sortDescriptorWithKey:@"ask" ascending:YES]];
+
+    [cache permutationForDescriptors:byBid];
+    XCTAssertEqual(cache.permutationCount, 1u);
+    XCTAssertEqual(cache.byteCount, size);
+    XCTAssertEqual(cache.evictionCount, 0u);
+
+    // the flip and the same sort again are served from it
+    [cache permutationForDescriptors:byBid];
+    XCTAssertEqual(cache.hitCount, 1u);
+    [cache permutationForDescriptors:[byBid valueForKey:@"reversedSortDescriptor"]];
+    XCTAssertEqual(cache.reversalCount, 1u);
+    XCTAssertEqual(cache.missCount, 1u);
+
+    // a newer one takes its place
+    [cache permutationForDescriptors:byAsk];
+    XCTAssertEqual(cache.permutationCount, 1u);
+    XCTAssertTrue([cache hasPermutationForDescriptors:byAsk]);
+    XCTAssertFalse([cache hasPermutationForDescriptors:byBid]);
+}
+
+- (void)testFlipAgainstSort {
+    QuoteSortEngine *engine = [self engineWithRowCount:kCacheRowCount];
+    NSArray *descriptors = @[[NSSortDescriptor sortDescriptorWithKey:@"change" ascending:YES],
+                             [NSSortDescriptor sortDescriptorWithKey:@"volume" ascending:NO]];
+    NSArray *flipped = [descriptors valueForKey:@"reversedSortDescriptor"];
+    NSData *sorted = [engine permutationForDescriptors:descriptors];
+
+    NSTimeInterval flipTime = [QuoteBenchmark bestTimeOfRuns:5 block:^{
+        [engine reversePermutation:sorted toDescriptors:flipped];
+    }];
+    NSTimeInterval sortTime = [QuoteBenchmark bestTimeOfRuns:3 block:^{
+        [engine permutationForDescriptors:flipped];
+    }];
+
+    NSLog(@"%lu rows: flip %.2f ms, sort %.1f ms", (unsigned long)kCacheRowCount, flipTime * 1000, sortTime * 1000);
+    XCTAssertLessThan(flipTime * 3, sortTime);
+}
+
+@end
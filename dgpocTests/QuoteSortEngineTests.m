@@ -0,0 +1,211 @@
+//
+//  QuoteSortEngineTests.m
+//  dgpocTests
+//
+
+#import <XCTest/XCTest.h>
+
+#import "IGGridViewSortingDataSourceHelper.h"
+#import "QuoteBenchmark.h"
+#import "QuoteItem.h"
+#import "QuoteKeySort.h"
+#import "QuotePrice.h"
+#import "QuoteSortEngine.h"
+#import "QuoteStore.h"
+
+static const NSUInteger kEngineRowCount = 100000;
+static const NSUInteger kTickRowCount = 50;
+
+@interface QuoteSortEngineTests : XCTestCase
+
+@end
+
+@implementation QuoteSortEngineTests
+
+- (QuoteStore *)storeWithRowCount:(NSUInteger)rowCount {
+    return [QuoteBenchmark storeWithRowCount:rowCount spreadingFields:QuoteFieldMaskOf(QuoteFieldLastTrade)];
+}
+
+- (NSArray *)descriptorSets {
+    return @[@[[NSSortDescriptor sortDescriptorWithKey:@"lastTrade" ascending:NO],
+               [NSSortDescriptor sortDescriptorWithKey:@"symbolSortAscending" ascending:YES]],
+             @[[NSSortDescriptor sortDescriptorWithKey:@"symbolSortDescending" ascending:NO]],
+             @[[NSSortDescriptor sortDescriptorWithKey:@"change" ascending:YES],
+               [NSSortDescriptor sortDescriptorWithKey:@"volume" ascending:NO]],
+             @[[NSSortDescriptor sortDescriptorWithKey:@"symbolName" ascending:YES
+                                              selector:@selector(caseInsensitiveCompare:)],
+               [NSSortDescriptor sortDescriptorWithKey:@"bidSize" ascending:YES]]];
+}
+
+- (void)testMatchesKVCOrder {
+    QuoteStore *store = [self storeWithRowCount:5000];
+    // missing values sort first, as nil does
+    [store setDouble:NAN forField:QuoteFieldChange row:17];
+    [store setFixed:QUOTE_FIXED_MISSING forField:QuoteFieldLastTrade row:42];
+    NSArray *items = [store items];
+    QuoteSortEngine *engine = [[QuoteSortEngine alloc] initWithStore:store];
+
+    for (NSArray *descriptors in [self descriptorSets]) {
+        XCTAssertTrue([engine canSortUsingDescriptors:descriptors]);
+        NSArray *expected = [items sortedArrayUsingDescriptors:descriptors];
+        NSArray *sorted = [engine sortedItems:items usingDescriptors:descriptors];
+        XCTAssertEqual(sorted.count, items.count);
+        // KVC keeps equal rows in input order, the engine in row id order;
+        // the keys still line up
+        for (NSSortDescriptor *descriptor in descriptors) {
+            XCTAssertEqualObjects([sorted valueForKey:descriptor.key], [expected valueForKey:descriptor.key],
+                                  @"%@", descriptors);
+        }
+    }
+}
+
+- (void)testParallelSortMatchesSerial {
+    QuoteStore *store = [self storeWithRowCount:2 * QUOTE_SORT_PARALLEL_MINIMUM];
+    QuoteSortEngine *serial = [[QuoteSortEngine alloc] initWithStore:store];
+    serial.workerCount = 1;
+    QuoteSortEngine *parallel = [[QuoteSortEngine alloc] initWithStore:store];
+    parallel.workerCount = 4;
+
+    for (NSArray *descriptors in [self descriptorSets]) {
+        XCTAssertEqualObjects([parallel permutationForDescriptors:descriptors],
+                              [serial permutationForDescriptors:descriptors], @"%@", descriptors);
+    }
+}
+
+- (void)testTiesFallBackToRowId {
+    QuoteStore *store = [[QuoteStore alloc] init];
+    [store appendRows:4];
+    NSArray *prices = @[@"2", @"1", @"2", @"1"];
+    [prices enumerateObjectsUsingBlock:^(NSString *price, NSUInteger row, BOOL *stop) {
+        [store setValue:[NSDecimalNumber decimalNumberWithString:price] forField:QuoteFieldBid row:row];
+    }];
+    QuoteSortEngine *engine = [[QuoteSortEngine alloc] initWithStore:store];
+    NSArray *byBid = @[[NSSortDescriptor sortDescriptorWithKey:@"bid" ascending:NO]];
+
+    uint32_t rows[] = { 3, 2, 1, 0 };
+    [engine sortRows:rows count:4 usingDescriptors:byBid];
+    uint32_t expected[] = { 0, 2, 1, 3 };
+    XCTAssertEqual(memcmp(rows, expected, sizeof(rows)), 0);
+
+    uint32_t unsorted[] = { 3, 1, 0, 2 };
+    [engine sortRows:unsorted count:4 usingDescriptors:@[]];
+    uint32_t byId[] = { 0, 1, 2, 3 };
+    XCTAssertEqual(memcmp(unsorted, byId, sizeof(unsorted)), 0);
+
+    XCTAssertFalse([engine canSortUsingDescriptors:@[[NSSortDescriptor sortDescriptorWithKey:@"bid" ascending:YES
+                                                                                    selector:@selector(localizedCompare:)]]]);
+    XCTAssertFalse([engine canSortUsingDescriptors:@[[NSSortDescriptor sortDescriptorWithKey:@"quoteAssetType" ascending:YES]]]);
+}
+
+// Moves count random rows' last trade by up to a dollar either way.
+- (void)tickStore:(QuoteStore *)store rows:(uint32_t *)rows count:(NSUInteger)count {
+    int64_t *lastTrade = [store fixedColumn:QuoteFieldLastTrade];
+    for (NSUInteger i = 0; i < count; i++) {
+        rows[i] = arc4random_uniform((uint32_t)store.rowCount);
+        if (lastTrade[rows[i]] != QUOTE_FIXED_MISSING) {
+            lastTrade[rows[i]] += QuotePriceFromCents((int64_t)arc4random_uniform(201) - 100);
+        }
+    }
+    [store didChangeFields:QuoteFieldMaskOf(QuoteFieldLastTrade)];
+}
+
+- (void)testOrderFollowsTicks {
+    QuoteStore *store = [self storeWithRowCount:5000];
+    QuoteSortEngine *engine = [[QuoteSortEngine alloc] initWithStore:store];
+    NSArray *descriptors = @[[NSSortDescriptor sortDescriptorWithKey:@"lastTrade" ascending:NO]];
+    // every other row, as a filter would leave them
+    NSMutableArray *items = [NSMutableArray array];
+    [[store items] enumerateObjectsUsingBlock:^(QuoteItem *item, NSUInteger row, BOOL *stop) {
+        if (row % 2 == 0) {
+            [items addObject:item];
+        }
+    }];
+    QuoteSortOrder *order = [[QuoteSortOrder alloc] initWithEngine:engine items:items descriptors:descriptors];
+    NSArray *view = order.items;
+
+    uint32_t rows[kTickRowCount];
+    for (int round = 0; round < 20; round++) {
+        [self tickStore:store rows:rows count:kTickRowCount];
+        [order updateRows:rows count:kTickRowCount changedFields:QuoteFieldMaskOf(QuoteFieldLastTrade)];
+        XCTAssertEqualObjects(view, [engine sortedItems:items usingDescriptors:descriptors], @"round %d", round);
+    }
+
+    // fields the order does not read move nothing
+    NSArray *before = [view copy];
+    [self tickStore:store rows:rows count:kTickRowCount];
+    [order updateRows:rows count:kTickRowCount changedFields:QuoteFieldMaskOf(QuoteFieldBid)];
+    XCTAssertEqualObjects(view, before);
+}
+
+- (void)testTickCostFollowsChangedRows {
+    if (![QuoteBenchmark runsLargeBenchmarks]) {
+        return;
+    }
+    QuoteStore *store = [self storeWithRowCount:kEngineRowCount];
+    QuoteSortEngine *engine = [[QuoteSortEngine alloc] initWithStore:store];
+    NSArray *descriptors = [self descriptorSets][0];
+    QuoteSortOrder *order = [[QuoteSortOrder alloc] initWithEngine:engine items:[store items] descriptors:descriptors];
+
+    NSTimeInterval fullTime = [QuoteBenchmark bestTimeOfRuns:3 block:^{
+        [[QuoteSortOrder alloc] initWithEngine:engine items:[store items] descriptors:descriptors];
+    }];
+    uint32_t *rows = malloc(kEngineRowCount / 10 * sizeof(uint32_t));
+    NSMutableString *report = [NSMutableString string];
+    NSTimeInterval tickTime = 0;
+    for (NSUInteger count = 5; count <= kEngineRowCount / 10; count *= 10) {
+        NSTimeInterval time = [QuoteBenchmark bestTimeOfRuns:5 block:^{
+            [self tickStore:store rows:rows count:count];
+            [order updateRows:rows count:count changedFields:QuoteFieldMaskOf(QuoteFieldLastTrade)];
+        }];
+        [report appendFormat:@" %lu rows %.3f ms,", (unsigned long)count, time * 1000];
+        if (count == kTickRowCount) {
+            tickTime = time;
+        }
+    }
+    free(rows);
+
+    NSLog(@"full sort %.1f ms; ticks:%@", fullTime * 1000, report);
+    XCTAssertLessThan(tickTime * 20, fullTime);
+}
+
+- (void)testAppendedKeysCycleThroughDirections {
+    IGGridViewSortingDataSourceHelper *helper = [[IGGridViewSortingDataSourceHelper alloc] init];
+    IGGridViewColumnDefinition *underlying = [[IGGridViewColumnDefinition alloc] initWithKey:@"underlyingSymbol"];
+    IGGridViewColumnDefinition *change = [[IGGridViewColumnDefinition alloc] initWithKey:@"changePercentChange"];
+
+    [helper appendSortingForColumn:underlying];
+    [helper appendSortingForColumn:change];
+    [helper appendSortingForColumn:change];
+    NSArray *expected = @[[NSSortDescriptor sortDescriptorWithKey:@"underlyingSymbol" ascending:YES],
+                          [NSSortDescriptor sortDescriptorWithKey:@"changePercentChange" ascending:NO]];
+    XCTAssertEqualObjects([helper sortDescriptors], expected);
+
+    [helper appendSortingForColumn:change];
+    XCTAssertEqualObjects([helper sortDescriptors], @[expected[0]]);
+}
+
+- (void)testEngineAgainstKVCSort {
+    if (![QuoteBenchmark runsLargeBenchmarks]) {
+        return;
+    }
+    QuoteStore *store = [self storeWithRowCount:kEngineRowCount];
+    NSArray *items = [store items];
+    NSArray *descriptors = [self descriptorSets][0];
+    QuoteSortEngine *engine = [[QuoteSortEngine alloc] initWithStore:store];
+    // build the symbol keys outside the timing, as the grid's first sort does
+    [store symbolSortKeysAscending:YES];
+
+    NSTimeInterval engineTime = [QuoteBenchmark bestTimeOfRuns:5 block:^{
+        [engine sortedItems:items usingDescriptors:descriptors];
+    }];
+    NSTimeInterval kvcTime = [QuoteBenchmark bestTimeOfRuns:1 block:^{
+        [items sortedArrayUsingDescriptors:descriptors];
+    }];
+
+    NSLog(@"sort %lu rows: engine %.1f ms, KVC %.1f ms", (unsigned long)kEngineRowCount,
+          engineTime * 1000, kvcTime * 1000);
+    XCTAssertLessThan(engineTime, 0.010);
+    XCTAssertLessThan(engineTime * 10, kvcTime);
+}
+
+@end
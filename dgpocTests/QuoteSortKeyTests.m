@@ -0,0 +1,89 @@
+//
+//  QuoteSortKeyTests.m
+//  dgpocTests
+//
+
+#import <XCTest/XCTest.h>
+
+#import "QuoteItem.h"
+#import "QuoteSortKey.h"
+#import "QuoteStore.h"
+
+@interface QuoteSortKeyTests : XCTestCase
+
+@end
+
+@implementation QuoteSortKeyTests
+
+// Rows of one store: [asset type, symbol, underlying]
+- (QuoteStore *)storeWithRows:(NSArray *)rows {
+    QuoteStore *store = [[QuoteStore alloc] init];
+    [store appendRows:rows.count];
+    [rows enumerateObjectsUsingBlock:^(NSArray *row, NSUInteger i, BOOL *stop) {
+        [store setString:row[0] forField:QuoteFieldAssetType row:i];
+        [store setString:row[1] forField:QuoteFieldSymbol row:i];
+        [store setString:row[2] forField:QuoteFieldUnderlyingSymbol row:i];
+    }];
+    return store;
+}
+
+- (NSArray *)symbolsOfStore:(QuoteStore *)store sortedAscending:(BOOL)ascending {
+    const QuoteSortKey *keys = [store symbolSortKeysAscending:ascending];
+    NSMutableArray *rows = [NSMutableArray array];
+    for (NSUInteger row = 0; row < store.rowCount; row++) {
+        [rows addObject:@(row)];
+    }
+    [rows sortUsingComparator:^NSComparisonResult(NSNumber *a, NSNumber *b) {
+        int order = QuoteSortKeyCompare(keys[a.unsignedIntegerValue], keys[b.unsignedIntegerValue]);
+        return ascending ? (NSComparisonResult)order : (NSComparisonResult)-order;
+    }];
+    NSMutableArray *symbols = [NSMutableArray array];
+    for (NSNumber *row in rows) {
+        [symbols addObject:[store stringForField:QuoteFieldSymbol row:row.unsignedIntegerValue]];
+    }
+    return symbols;
+}
+
+- (void)testFieldsCompareMostSignificantFirst {
+    QuoteSortKey low = QuoteSortKeyMake(1, 0, QuoteSortKindOption, 20160122, 950000, QuoteOptionRightCall);
+    QuoteSortKey high = QuoteSortKeyMake(1, 0, QuoteSortKindOption, 20160122, 1000000, QuoteOptionRightCall);
+    XCTAssertEqual(QuoteSortKeyCompare(low, high), -1);
+
+    QuoteSortKey later = QuoteSortKeyMake(1, 0, QuoteSortKindOption, 20160219, 0, QuoteOptionRightCall);
+    XCTAssertEqual(QuoteSortKeyCompare(high, later), -1);
+    QuoteSortKey nextUnderlying = QuoteSortKeyMake(2, 0, QuoteSortKindEquityAscending, 0, 0, QuoteOptionRightNone);
+    XCTAssertEqual(QuoteSortKeyCompare(later, nextUnderlying), -1);
+    XCTAssertEqual(QuoteSortKeyCompare(later, later), 0);
+
+    char lowHex[33], highHex[33];
+    QuoteSortKeyFormatHex(low, lowHex);
+    QuoteSortKeyFormatHex(high, highHex);
+    XCTAssertLessThan(strcmp(lowHex, highHex), 0);
+}
+
+- (void)testStrikesSortNumerically {
+    QuoteStore *store = [self storeWithRows:@[@[@"O", @"AAPL_012216C100", @"AAPL"],
+                                              @[@"O", @"AAPL_012216C95", @"AAPL"],
+                                              @[@"O", @"AAPL_012216C97.5", @"AAPL"]]];
+    NSArray *expected = @[@"AAPL_012216C95", @"AAPL_012216C97.5", @"AAPL_012216C100"];
+    XCTAssertEqualObjects([self symbolsOfStore:store sortedAscending:YES], expected);
+
+    // the KVC strings order the same way
+    NSArray *byString = [[store items] sortedArrayUsingDescriptors:
+                         @[[NSSortDescriptor sortDescriptorWithKey:@"symbolSortAscending" ascending:YES]]];
+    XCTAssertEqualObjects([byString valueForKey:@"symbol"], expected);
+}
+
+- (void)testEquitiesLeadTheirOptionsInBothDirections {
+    QuoteStore *store = [self storeWithRows:@[@[@"O", @"FSLR_022016C100", @"FSLR"],
+                                              @[@"E", @"SWHC", @"SWHC"],
+                                              @[@"O", @"FSLR_012016P100", @"FSLR"],
+                                              @[@"E", @"FSLR", @"FSLR"],
+                                              @[@"E", @"FSLRX", @"FSLRX"]]];
+    XCTAssertEqualObjects([self symbolsOfStore:store sortedAscending:YES],
+                          (@[@"FSLR", @"FSLR_012016P100", @"FSLR_022016C100", @"FSLRX", @"SWHC"]));
+    XCTAssertEqualObjects([self symbolsOfStore:store sortedAscending:NO],
+                          (@[@"SWHC", @"FSLRX", @"FSLR", @"FSLR_022016C100", @"FSLR_012016P100"]));
+}
+
+@end
@@ -0,0 +1,120 @@
+//
+//  QuoteSortSchedulerTests.m
+//  dgpocTests
+//
+
+#import <XCTest/XCTest.h>
+
+#import "QuoteSortScheduler.h"
+
+static const NSTimeInterval kSchedulerTimeout = 5;
+
+@interface QuoteSortSchedulerTests : XCTestCase
+
+@end
+
+@implementation QuoteSortSchedulerTests {
+    dispatch_queue_t _completionQueue;
+    QuoteSortScheduler *_scheduler;
+}
+
+- (void)setUp {
+    [super setUp];
+    _completionQueue = dispatch_queue_create("QuoteSortSchedulerTests", DISPATCH_QUEUE_SERIAL);
+    _scheduler = [[QuoteSortScheduler alloc] initWithCompletionQueue:_completionQueue];
+}
+
+// Waits until everything submitted so far has run and completed.
+- (void)drain {
+    XCTestExpectation *drained = [self expectationWithDescription:@"drained"];
+    [_scheduler submitWork:^id(BOOL (^isCancelled)(void)) {
+        return nil;
+    } completion:^(id result, uint64_t generation) {
+        [drained fulfill];
+    }];
+    [self waitForExpectationsWithTimeout:kSchedulerTimeout handler:nil];
+}
+
+- (void)testPublishesResult {
+    XCTestExpectation *completed = [self expectationWithDescription:@"completed"];
+    uint64_t generation = [_scheduler submitWork:^id(BOOL (^isCancelled)(void)) {
+        XCTAssertFalse([NSThread isMainThread]);
+        return @[@3, @1, @2];
+    } completion:^(NSArray *result, uint64_t completedGeneration) {
+        XCTAssertEqualObjects(result, (@[@3, @1, @2]));
+        XCTAssertEqual(completedGeneration, generation);
+        [completed fulfill];
+    }];
+    XCTAssertTrue(_scheduler.pending);
+    [self waitForExpectationsWithTimeout:kSchedulerTimeout handler:nil];
+
+    XCTAssertFalse(_scheduler.pending);
+    XCTAssertEqualObjects(_scheduler.result, (@[@3, @1, @2]));
+    XCTAssertEqual(_scheduler.resultGeneration, generation);
+}
+
+- (void)testNewestRequestWins {
+    dispatch_semaphore_t started = dispatch_semaphore_create(0);
+    dispatch_semaphore_t release = dispatch_semaphore_create(0);
+    __block BOOL sawCancel = NO;
+    __block BOOL queuedRan = NO;
+    __block NSUInteger completions = 0;
+
+    [_scheduler submitWork:^id(BOOL (^isCancelled)(void)) {
+        dispatch_semaphore_signal(started);
+        dispatch_semaphore_wait(release, DISPATCH_TIME_FOREVER);
+        sawCancel = isCancelled();
+        return @"first";
+    } completion:^(id result, uint64_t generation) {
+        completions++;
+    }];
+    dispatch_semaphore_wait(started, DISPATCH_TIME_FOREVER);
+    [_scheduler submitWork:^id(BOOL (^isCancelled)(void)) {
+        queuedRan = YES;
+        return @"second";
+    } completion:^(id result, uint64_t generation) {
+        completions++;
+    }];
+    XCTestExpectation *completed = [self expectationWithDescription:@"third completed"];
+    uint64_t third = [_scheduler submitWork:^id(BOOL (^isCancelled)(void)) {
+        return @"third";
+    } completion:^(id result, uint64_t generation) {
+        [completed fulfill];
+    }];
+    dispatch_semaphore_signal(release);
+
+    [self waitForExpectationsWithTimeout:kSchedulerTimeout handler:nil];
+    XCTAssertTrue(sawCancel);
+    XCTAssertFalse(queuedRan);
+    XCTAssertEqual(completions, 0u);
+    XCTAssertEqual(_scheduler.cancelledCount, 2u);
+    XCTAssertEqualObjects(_scheduler.result, @"third");
+    XCTAssertEqual(_scheduler.resultGeneration, third);
+}
+
+- (void)testCancelKeepsLastResult {
+    XCTestExpectation *completed = [self expectationWithDescription:@"completed"];
+    [_scheduler submitWork:^id(BOOL (^isCancelled)(void)) {
+        return @"shown";
+    } completion:^(id result, uint64_t generation) {
+        [completed fulfill];
+    }];
+    [self waitForExpectationsWithTimeout:kSchedulerTimeout handler:nil];
+
+    dispatch_semaphore_t release = dispatch_semaphore_create(0);
+    [_scheduler submitWork:^id(BOOL (^isCancelled)(void)) {
+        dispatch_semaphore_wait(release, DISPATCH_TIME_FOREVER);
+        return @"dropped";
+    } completion:^(id result, uint64_t generation) {
+        XCTFail(@"a cancelled request completed");
+    }];
+    [_scheduler cancel];
+    XCTAssertFalse(_scheduler.pending);
+    XCTAssertEqualObjects(_scheduler.result, @"shown");
+    dispatch_semaphore_signal(release);
+
+    [self drain];
+    XCTAssertEqual(_scheduler.cancelledCount, 1u);
+}
+
+@end
@@ -0,0 +1,246 @@
+//
+//  QuoteStoreTests.m
+//  dgpocTests
+//
+
+#import <XCTest/XCTest.h>
+
+#import "QuoteBenchmark.h"
+#import "QuoteItem.h"
+#import "QuoteItemDataMaker.h"
+#import "QuoteStore.h"
+
+static const NSUInteger kMemoryRowCount = 100000;
+static const NSUInteger kScanPasses = 20;
+static const NSUInteger kSortRowCount = 10000;
+
+@interface QuoteStoreTests : XCTestCase
+
+@end
+
+@implementation QuoteStoreTests
+
+- (void)testAppendedRowsStartMissing {
+    QuoteStore *store = [[QuoteStore alloc] init];
+    XCTAssertEqual([store appendRows:3], 0u);
+    XCTAssertEqual([store appendRows:2], 3u);
+    XCTAssertEqual(store.rowCount, 5u);
+
+    QuoteItem *item = [store items][4];
+    XCTAssertNil(item.symbol);
+    XCTAssertNil(item.lastTrade);
+    XCTAssertNil(item.change);
+    XCTAssertEqual([store fixedForField:QuoteFieldLastTrade row:4], QUOTE_FIXED_MISSING);
+    XCTAssertTrue(isnan([store doubleForField:QuoteFieldChange row:4]));
+    XCTAssertEqual([store codeColumn:QuoteFieldSymbol][4], 0u);
+}
+
+- (void)testItemsReadAndWriteTheColumns {
+    QuoteStore *store = [[QuoteStore alloc] init];
+    [store appendRows:2];
+    QuoteItem *item = [store items][1];
+
+    item.change = @-0.25;
+    item.symbol = @"SWHC";
+    XCTAssertEqual([store doubleColumn:QuoteFieldChange][1], -0.25);
+    XCTAssertEqualObjects([store stringForField:QuoteFieldSymbol row:1], @"SWHC");
+
+    [store setDouble:0.5 forField:QuoteFieldChange row:1];
+    XCTAssertEqualObjects(item.change, @0.5);
+
+    item.symbol = nil;
+    XCTAssertNil(item.symbol);
+    XCTAssertEqual([store codeColumn:QuoteFieldSymbol][1], 0u);
+}
+
+- (void)testStandaloneItemsOwnTheirRow {
+    QuoteItem *item = [[QuoteItem alloc] init];
+    item.underlyingSymbol = @"FSLR";
+    item.bid = @1.5;
+    XCTAssertEqual(item.store.rowCount, 1u);
+    XCTAssertEqualObjects(item.underlyingSymbol, @"FSLR");
+    XCTAssertEqualObjects(item.bid, @1.5);
+}
+
+- (void)testFixedFieldsBoxExactly {
+    QuoteStore *store = [[QuoteStore alloc] init];
+    [store appendRows:1];
+    QuoteItem *item = [store items][0];
+
+    item.bid = [NSDecimalNumber decimalNumberWithString:@"25.89"];
+    XCTAssertEqual([store fixedForField:QuoteFieldBid row:0], QuotePriceFromCents(2589));
+    XCTAssertEqualObjects(item.bid, [NSDecimalNumber decimalNumberWithString:@"25.89"]);
+
+    item.ask = @-0.07;
+    XCTAssertEqual([store fixedForField:QuoteFieldAsk row:0], -QuotePriceFromCents(7));
+    XCTAssertEqualObjects(item.ask, [NSDecimalNumber decimalNumberWithString:@"-0.07"]);
+
+    item.volume = @1234567;
+    XCTAssertEqual([store fixedForField:QuoteFieldVolume row:0], 1234567);
+    XCTAssertEqual(item.volume.longLongValue, 1234567);
+
+    item.bid = nil;
+    XCTAssertNil(item.bid);
+}
+
+- (void)testEqualStringsShareOneCode {
+    QuoteStore *store = [[QuoteStore alloc] init];
+    [store appendRows:3];
+    [store setString:@"E" forField:QuoteFieldAssetType row:0];
+    [store setString:@"O" forField:QuoteFieldAssetType row:1];
+    [store setString:[@"E" mutableCopy] forField:QuoteFieldAssetType row:2];
+
+    const uint32_t *codes = [store codeColumn:QuoteFieldAssetType];
+    XCTAssertEqual(codes[0], codes[2]);
+    XCTAssertNotEqual(codes[0], codes[1]);
+    XCTAssertEqual(QuoteStringTableCount([store stringTableForField:QuoteFieldAssetType]), 2u);
+    XCTAssertTrue([store stringForField:QuoteFieldAssetType row:0] == [store stringForField:QuoteFieldAssetType row:2]);
+}
+
+- (void)testSymbolsAndUnderlyingsShareIds {
+    QuoteStore *store = [[QuoteStore alloc] init];
+    [store appendRows:2];
+    QuoteItem *equity = [store items][0];
+    QuoteItem *option = [store items][1];
+    equity.assetType = @"E";
+    equity.symbol = @"FSLR";
+    equity.underlyingSymbol = @"FSLR";
+    option.assetType = @"O";
+    option.symbol = @"FSLR_012016P100";
+    option.underlyingSymbol = @"FSLR";
+
+    XCTAssertEqual(option.underlyingSymbolId, equity.symbolId);
+    XCTAssertNotEqual(option.symbolId, equity.symbolId);
+    XCTAssertEqual([store symbolIdForString:@"FSLR"], equity.symbolId);
+    XCTAssertEqual([store symbolIdForString:@"AAPL"], 0u);
+    XCTAssertEqualObjects([store symbolForId:option.symbolId], @"FSLR_012016P100");
+    XCTAssertEqual(QuoteStringTableCount([store stringTableForField:QuoteFieldUnderlyingSymbol]), 2u);
+
+    XCTAssertEqual(equity.quoteAssetType, QuoteAssetTypeEquity);
+    XCTAssertEqual(option.quoteAssetType, QuoteAssetTypeOption);
+    option.assetType = @"X";
+    XCTAssertEqual(option.quoteAssetType, QuoteAssetTypeUnknown);
+}
+
+- (void)testSymbolSortKeysAreCachedUntilTheSymbolChanges {
+    QuoteStore *store = [[QuoteStore alloc] init];
+    [store appendRows:2];
+    QuoteItem *equity = [store items][0];
+    QuoteItem *option = [store items][1];
+    equity.assetType = @"E";
+    equity.symbol = @"FSLR";
+    equity.underlyingSymbol = @"FSLR";
+    option.assetType = @"O";
+    option.symbol = @"FSLR_012016P100";
+    option.underlyingSymbol = @"FSLR";
+
+    XCTAssertTrue(option.symbolSortAscending == option.symbolSortDescending);
+    XCTAssertTrue(equity.symbolSortAscending == equity.symbolSortAscending);
+    QuoteSortKey equityKey = [store symbolSortKeyForRow:0 ascending:YES];
+    XCTAssertEqual([equity.symbolSortAscending compare:option.symbolSortAscending], NSOrderedAscending);
+
+    // AAAA ranks ahead of FSLR, so the equity's key moves
+    equity.symbol = @"AAAA";
+    XCTAssertLessThan(QuoteSortKeyCompare([store symbolSortKeyForRow:0 ascending:YES], equityKey), 0);
+    option.assetType = @"E";
+    XCTAssertEqual([store symbolSortKeyForRow:1 ascending:YES].lo, (uint64_t)0);
+}
+
+- (void)testCachedSortKeysLeaveNothingLive {
+    NSURL *url = [QuoteBenchmark csvURLWithRowCount:kSortRowCount];
+    NSArray *items = [QuoteItemDataMaker projectionOfCSVAtURL:url fields:QuoteFieldMaskIdentity].items;
+    NSArray *objects = [QuoteBenchmark quoteObjectsFromCSVAtURL:url];
+    NSArray *ascending = @[[NSSortDescriptor sortDescriptorWithKey:@"symbolSortAscending" ascending:YES]];
+
+    // the first sort builds every key
+    [objects sortedArrayUsingDescriptors:ascending];
+    [items sortedArrayUsingDescriptors:ascending];
+
+    // keys built per access are autoreleased, so they are still live when
+    // the block returns; cached keys add nothing
+    NSInteger objectBlocks = [QuoteBenchmark liveBlocksAddedDuring:^{
+        [objects sortedArrayUsingDescriptors:ascending];
+    }];
+    NSInteger itemBlocks = [QuoteBenchmark liveBlocksAddedDuring:^{
+        [items sortedArrayUsingDescriptors:ascending];
+    }];
+    NSLog(@"sort of %lu rows: %ld live blocks added building keys, %ld cached",
+          (unsigned long)kSortRowCount, (long)objectBlocks, (long)itemBlocks);
+    XCTAssertGreaterThan(objectBlocks, (NSInteger)kSortRowCount);
+    XCTAssertLessThan(itemBlocks, (NSInteger)kSortRowCount / 100);
+}
+
+- (void)testAppendStoreTranslatesCodes {
+    QuoteStore *first = [[QuoteStore alloc] init];
+    [first appendRows:1];
+    [first setString:@"AAPL" forField:QuoteFieldSymbol row:0];
+
+    QuoteStore *second = [[QuoteStore alloc] init];
+    [second appendRows:2];
+    [second setString:@"MSFT" forField:QuoteFieldSymbol row:0];
+    [second setString:@"AAPL" forField:QuoteFieldSymbol row:1];
+    [second setFixed:QuotePriceFromCents(125) forField:QuoteFieldBid row:1];
+
+    [first appendStore:second];
+    XCTAssertEqual(first.rowCount, 3u);
+    XCTAssertEqualObjects([first stringForField:QuoteFieldSymbol row:1], @"MSFT");
+    XCTAssertEqualObjects([first stringForField:QuoteFieldSymbol row:2], @"AAPL");
+    XCTAssertEqual([first codeColumn:QuoteFieldSymbol][0], [first codeColumn:QuoteFieldSymbol][2]);
+    XCTAssertEqual([first fixedForField:QuoteFieldBid row:2], QuotePriceFromCents(125));
+}
+
+- (void)testMemoryPerRowAgainstObjects {
+    NSURL *url = [QuoteBenchmark csvURLWithRowCount:kMemoryRowCount];
+
+    // Resident size only drops back part of the way after a free, so the
+    // smaller store is measured first.
+    uint64_t before = [QuoteBenchmark residentBytes];
+    QuoteStore *store = [QuoteItemDataMaker projectionOfCSVAtURL:url fields:QuoteFieldMaskAll concurrency:1].store;
+    uint64_t storeBytes = [QuoteBenchmark residentBytes] - before;
+
+    before = [QuoteBenchmark residentBytes];
+    NSArray *objects = [QuoteBenchmark quoteObjectsFromCSVAtURL:url];
+    uint64_t objectBytes = [QuoteBenchmark residentBytes] - before;
+
+    NSLog(@"store:   %.0f bytes/row", (double)storeBytes / store.rowCount);
+    NSLog(@"objects: %.0f bytes/row", (double)objectBytes / objects.count);
+    XCTAssertEqual(store.rowCount, objects.count);
+    XCTAssertLessThan(storeBytes, objectBytes);
+}
+
+- (void)testScanThroughputAgainstObjects {
+    NSURL *url = [QuoteBenchmark csvURLWithRowCount:kMemoryRowCount];
+    QuoteStore *store = [QuoteItemDataMaker projectionOfCSVAtURL:url fields:QuoteFieldMaskAll].store;
+    NSArray *objects = [QuoteBenchmark quoteObjectsFromCSVAtURL:url];
+
+    __block double objectSum = 0;
+    NSTimeInterval objectTime = [QuoteBenchmark bestTimeOfRuns:3 block:^{
+        objectSum = 0;
+        for (NSUInteger pass = 0; pass < kScanPasses; pass++) {
+            for (QuoteObject *object in objects) {
+                objectSum += object.lastTrade.doubleValue;
+            }
+        }
+    }];
+
+    __block double storeSum = 0;
+    NSTimeInterval storeTime = [QuoteBenchmark bestTimeOfRuns:3 block:^{
+        const QuotePrice *lastTrade = [store fixedColumn:QuoteFieldLastTrade];
+        NSUInteger rowCount = store.rowCount;
+        int64_t ticks = 0;
+        for (NSUInteger pass = 0; pass < kScanPasses; pass++) {
+            for (NSUInteger row = 0; row < rowCount; row++) {
+                ticks += lastTrade[row];
+            }
+        }
+        storeSum = QuoteFixedToDouble(ticks, QUOTE_PRICE_DECIMALS);
+    }];
+
+    double rows = (double)kScanPasses * store.rowCount;
+    NSLog(@"objects: %.0f M rows/s", rows / objectTime / 1e6);
+    NSLog(@"store:   %.0f M rows/s", rows / storeTime / 1e6);
+    XCTAssertEqualWithAccuracy(storeSum, objectSum, fabs(objectSum) * 1e-9);
+    XCTAssertLessThan(storeTime, objectTime);
+}
+
+@end
@@ -0,0 +1,147 @@
+//
+//  QuoteSymbolIndexTests.m
+//  dgpocTests
+//
+
+#import <XCTest/XCTest.h>
+
+#import "QuoteBenchmark.h"
+#import "QuoteFilterEngine.h"
+#import "QuoteSymbolIndex.h"
+
+static const NSUInteger kLookupRowCount = 1000000;
+
+@interface QuoteSymbolIndexTests : XCTestCase
+
+@end
+
+@implementation QuoteSymbolIndexTests
+
+// The rows a scan of the columns in fields finds.
+- (NSData *)scanStore:(QuoteStore *)store forPrefix:(NSString *)prefix fields:(QuoteFieldMask)fields {
+    NSMutableData *rows = [NSMutableData data];
+    for (uint32_t row = 0; row < store.rowCount; row++) {
+        for (QuoteField field = QuoteFieldSymbol; field <= QuoteFieldUnderlyingSymbol; field++) {
+            NSString *symbol = [store stringForField:field row:row];
+            if ((fields & QuoteFieldMaskOf(field)) && symbol
+                && [symbol.uppercaseString hasPrefix:prefix.uppercaseString]) {
+                [rows appendBytes:&row length:sizeof(row)];
+                break;
+            }
+        }
+    }
+    return rows;
+}
+
+- (QuoteStore *)storeWithSymbols:(NSArray *)symbols underlyings:(NSArray *)underlyings {
+    QuoteStore *store = [[QuoteStore alloc] init];
+    [store appendRows:symbols.count];
+    for (NSUInteger row = 0; row < symbols.count; row++) {
+        [store setString:symbols[row] forField:QuoteFieldSymbol row:row];
+        [store setString:underlyings[row] forField:QuoteFieldUnderlyingSymbol row:row];
+    }
+    return store;
+}
+
+- (void)testMatchesScan {
+    QuoteStore *store = [QuoteBenchmark storeWithRowCount:5000];
+    QuoteSymbolIndex *index = [[QuoteSymbolIndex alloc] initWithStore:store];
+    QuoteFieldMask both = QuoteFieldMaskOf(QuoteFieldSymbol) | QuoteFieldMaskOf(QuoteFieldUnderlyingSymbol);
+    for (NSString *prefix in @[@"F", @"fslr", @"FSLR_01", @"sw", @"zzz"]) {
+        XCTAssertEqualObjects([index rowsWithPrefix:prefix], [self scanStore:store forPrefix:prefix fields:both],
+                              @"%@", prefix);
+        QuoteFieldMask symbol = QuoteFieldMaskOf(QuoteFieldSymbol);
+        XCTAssertEqualObjects([index rowsWithPrefix:prefix fields:symbol],
+                              [self scanStore:store forPrefix:prefix fields:symbol], @"%@", prefix);
+    }
+    XCTAssertEqual([index rowsWithPrefix:@""].length, store.rowCount * sizeof(uint32_t));
+}
+
+- (void)testUnderlyingFindsOptions {
+    QuoteStore *store = [self storeWithSymbols:@[@"AAPL", @"AAPL_012016C100", @"AAP", @"XAAPL", @"Q1AAPL"]
+                                   underlyings:@[@"AAPL", @"AAPL", @"AAP", @"XAAPL", @"AAPL"]];
+    QuoteSymbolIndex *index = [[QuoteSymbolIndex alloc] initWithStore:store];
+    uint32_t expected[] = {0, 1, 4};
+    XCTAssertEqualObjects([index rowsWithPrefix:@"aapl"], [NSData dataWithBytes:expected length:sizeof(expected)]);
+    uint32_t ownSymbol[] = {0, 1};
+    XCTAssertEqualObjects([index rowsWithPrefix:@"aapl" fields:QuoteFieldMaskOf(QuoteFieldSymbol)],
+                          [NSData dataWithBytes:ownSymbol length:sizeof(ownSymbol)]);
+}
+
+- (void)testFollowsAppendsAndUpdates {
+    QuoteStore *store = [self storeWithSymbols:@[@"FSLR", @"SWHC"] underlyings:@[@"FSLR", @"SWHC"]];
+    QuoteSymbolIndex *index = [[QuoteSymbolIndex alloc] initWithStore:store];
+    XCTAssertEqual([index rowsWithPrefix:@"FS"].length, sizeof(uint32_t));
+
+    NSUInteger row = [store appendRows:1];
+    [store setString:@"FSLR_012016C100" forField:QuoteFieldSymbol row:row];
+    [store setString:@"FSLR" forField:QuoteFieldUnderlyingSymbol row:row];
+    uint32_t appended[] = {0, 2};
+    XCTAssertEqualObjects([index rowsWithPrefix:@"FS"], [NSData dataWithBytes:appended length:sizeof(appended)]);
+    XCTAssertEqual(index.rowCount, 3u);
+
+    uint32_t moved = 0;
+    [store setString:@"SWHC" forField:QuoteFieldSymbol row:moved];
+    [store setString:@"SWHC" forField:QuoteFieldUnderlyingSymbol row:moved];
+    [index updateRows:&moved count:1];
+    uint32_t swhc[] = {0, 1};
+    XCTAssertEqualObjects([index rowsWithPrefix:@"SW"], [NSData dataWithBytes:swhc length:sizeof(swhc)]);
+    XCTAssertEqualObjects([index rowsWithPrefix:@"FS"], [NSData dataWithBytes:&appended[1] length:sizeof(uint32_t)]);
+}
+
+- (void)testFilterEngineLooksUp {
+    QuoteStore *store = [QuoteBenchmark storeWithRowCount:5000];
+    QuoteFilterEngine *engine = [[QuoteFilterEngine alloc] initWithStore:store];
+    NSArray *items = [store items];
+    QuoteFilterPredicate *predicate = [engine predicateWithKey:@"symbol" condition:QuoteFilterConditionBeginsWith
+                                                         value:@"fslr_0" options:QuoteFilterCaseInsensitive];
+    NSArray *expected = [items filteredArrayUsingPredicate:
+                         [NSPredicate predicateWithFormat:@"symbol BEGINSWITH[c] %@", @"fslr_0"]];
+    XCTAssertGreaterThan(expected.count, 0u);
+    XCTAssertEqualObjects([engine filteredItems:items usingPredicate:predicate], expected);
+    // a copy is not the store's own array, so it is scanned instead
+    XCTAssertEqualObjects([engine filteredItems:[items copy] usingPredicate:predicate], expected);
+}
+
+- (void)testLookupLatency {
+    if (![QuoteBenchmark runsLargeBenchmarks]) {
+        return;
+    }
+    QuoteStore *store = [QuoteBenchmark storeWithRowCount:kLookupRowCount];
+    QuoteSymbolIndex *index = [[QuoteSymbolIndex alloc] initWithStore:store];
+    QuoteFilterEngine *engine = [[QuoteFilterEngine alloc] initWithStore:store];
+    NSMutableData *allRows = [NSMutableData dataWithLength:store.rowCount * sizeof(uint32_t)];
+    NSMutableData *matches = [NSMutableData dataWithLength:allRows.length];
+    uint32_t *rows = allRows.mutableBytes;
+    for (uint32_t row = 0; row < store.rowCount; row++) {
+        rows[row] = row;
+    }
+
+    NSTimeInterval buildTime = [QuoteBenchmark bestTimeOfRuns:1 block:^{
+        [index rowsWithPrefix:@"ZZZZ"];
+    }];
+    for (NSString *prefix in @[@"S", @"SW", @"SWHC"]) {
+        __block NSUInteger found = 0;
+        __block NSUInteger scanned = 0;
+        NSTimeInterval lookupTime = [QuoteBenchmark bestTimeOfRuns:5 block:^{
+            found = [index rowsWithPrefix:prefix fields:QuoteFieldMaskOf(QuoteFieldSymbol)].length / sizeof(uint32_t);
+        }];
+        NSTimeInterval scanTime = [QuoteBenchmark bestTimeOfRuns:3 block:^{
+            QuoteFilterPredicate *predicate = [engine predicateWithKey:@"symbol"
+                                                             condition:QuoteFilterConditionBeginsWith
+                                                                 value:prefix options:QuoteFilterCaseInsensitive];
+            scanned = [engine filterRows:rows count:store.rowCount usingPredicate:predicate
+                                 matches:matches.mutableBytes];
+        }];
+        NSLog(@"prefix %@ of %lu rows: index %.2f ms, scan %.2f ms, %lu matches (index built in %.1f ms)", prefix,
+              (unsigned long)kLookupRowCount, lookupTime * 1000, scanTime * 1000, (unsigned long)found,
+              buildTime * 1000);
+        XCTAssertEqual(found, scanned);
+        // a prefix matching a good share of the rows is no cheaper to list
+        if (found * 20 <= store.rowCount) {
+            XCTAssertLessThan(lookupTime * 10, scanTime, @"%@", prefix);
+        }
+    }
+}
+
+@end